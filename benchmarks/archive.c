@@ -0,0 +1,101 @@
+/*
+Author: daddinuz
+email:  daddinuz@gmail.com
+
+Copyright (c) 2018 Davide Di Carlo
+
+Permission is hereby granted, free of charge, to any person
+obtaining a copy of this software and associated documentation
+files (the "Software"), to deal in the Software without
+restriction, including without limitation the rights to use,
+copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be
+included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * Measures writing and reloading an archive of results, values are 8 byte counters, one result out of sixteen is an
+ * error.
+ *
+ * Usage: benchmark-archive [results]
+ */
+
+#include <time.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <result-archive.h>
+
+static Error Throttled = Error_new("Throttled");
+
+static double now(void) {
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (double) time.tv_sec + (double) time.tv_nsec / 1e9;
+}
+
+static size_t measure(const void *value) {
+    (void) value;
+    return sizeof(uint64_t);
+}
+
+int main(int argc, char **argv) {
+    const size_t size = (argc > 1) ? strtoul(argv[1], NULL, 10) : 1000000;
+    const Error registry[] = {Throttled};
+    uint64_t *values = malloc(size * sizeof(values[0]));
+    Result *results = malloc(size * sizeof(results[0]));
+    if (NULL == values || NULL == results) {
+        return EXIT_FAILURE;
+    }
+    for (size_t i = 0; i < size; i++) {
+        values[i] = i;
+        results[i] = (i % 16 == 15) ? Result_error((i % 32 == 31) ? Throttled : SystemError) : Result_ok(&values[i]);
+    }
+
+    char path[] = "/tmp/benchmark-archive-XXXXXX";
+    const int fd = mkstemp(path);
+    if (fd < 0) {
+        return EXIT_FAILURE;
+    }
+    const double writeStart = now();
+    const Result written = ResultArchive_write(fd, results, size, measure, registry, 1);
+    const double writeTime = now() - writeStart;
+    close(fd);
+
+    ResultArchive archive;
+    const double loadStart = now();
+    const Result loaded = ResultArchive_load(path, registry, 1, &archive);
+    const double loadTime = now() - loadStart;
+    unlink(path);
+    if (!Result_isOk(written) || !Result_isOk(loaded)) {
+        return EXIT_FAILURE;
+    }
+
+    uint64_t checksum = 0, expected = 0;
+    for (size_t i = 0; i < size; i++) {
+        const Result result = ResultArchive_results(&archive)[i];
+        checksum += Result_isOk(result) ? *(const uint64_t *) Result_unwrap(result) : Error_index(Result_inspect(result));
+        expected += Result_isOk(results[i]) ? values[i] : Error_index(Result_inspect(results[i]));
+    }
+    ResultArchive_unload(&archive);
+
+    printf("results: %zu\n", size);
+    printf("write: %8.2f ms\n", writeTime * 1e3);
+    printf("load:  %8.2f ms\n", loadTime * 1e3);
+    free(results);
+    free(values);
+    return (checksum == expected) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
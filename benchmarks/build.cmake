@@ -0,0 +1,15 @@
+add_executable(benchmark-try ${CMAKE_CURRENT_LIST_DIR}/try.c)
+target_link_libraries(benchmark-try PRIVATE m result)
+
+add_executable(benchmark-archive ${CMAKE_CURRENT_LIST_DIR}/archive.c)
+target_link_libraries(benchmark-archive PRIVATE result)
+
+add_executable(benchmark-reactor ${CMAKE_CURRENT_LIST_DIR}/reactor.c)
+target_link_libraries(benchmark-reactor PRIVATE result)
+
+add_executable(benchmark-cpp ${CMAKE_CURRENT_LIST_DIR}/cpp.cpp)
+target_link_libraries(benchmark-cpp PRIVATE result)
+if (NOT CMAKE_VERSION VERSION_LESS 3.20)
+    # std::expected is compared only when the toolchain provides C++23
+    set_target_properties(benchmark-cpp PROPERTIES CXX_STANDARD 23 CXX_STANDARD_REQUIRED OFF)
+endif ()
@@ -0,0 +1,191 @@
+/*
+Author: daddinuz
+email:  daddinuz@gmail.com
+
+Copyright (c) 2018 Davide Di Carlo
+
+Permission is hereby granted, free of charge, to any person
+obtaining a copy of this software and associated documentation
+files (the "Software"), to deal in the Software without
+restriction, including without limitation the rights to use,
+copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be
+included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*
+ * Compares failure propagation through `result::Result` against `std::expected` and exceptions on the example's
+ * division -> squareRoot -> cube pipeline.
+ * `std::expected` is measured only when the standard library provides it (C++23).
+ *
+ * Usage: benchmark-cpp [iterations]
+ */
+
+#include <cmath>
+#include <ctime>
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+#include <result.hpp>
+
+#if __has_include(<version>)
+#include <version>
+#endif
+#if defined(__cpp_lib_expected)
+#include <expected>
+#endif
+
+namespace withResult {
+
+static result::Result<double> division(const double dividend, const double divisor) {
+    if (divisor == 0.0) {
+        return result::err(DomainError);
+    }
+    return result::ok(dividend / divisor);
+}
+
+static result::Result<double> squareRoot(const double number) {
+    if (number < 0.0) {
+        return result::err(DomainError);
+    }
+    return result::ok(std::sqrt(number));
+}
+
+static result::Result<double> run(const double dividend, const double divisor) {
+    return division(dividend, divisor).and_then(squareRoot).map([](double x) { return std::pow(x, 3); });
+}
+
+}
+
+#if defined(__cpp_lib_expected)
+namespace withExpected {
+
+static std::expected<double, Error> division(const double dividend, const double divisor) {
+    if (divisor == 0.0) {
+        return std::unexpected(DomainError);
+    }
+    return dividend / divisor;
+}
+
+static std::expected<double, Error> squareRoot(const double number) {
+    if (number < 0.0) {
+        return std::unexpected(DomainError);
+    }
+    return std::sqrt(number);
+}
+
+static std::expected<double, Error> run(const double dividend, const double divisor) {
+    // the monadic operations of std::expected are C++23 library additions not every toolchain ships yet
+    const std::expected<double, Error> quotient = division(dividend, divisor);
+    if (!quotient) {
+        return quotient;
+    }
+    const std::expected<double, Error> root = squareRoot(*quotient);
+    if (!root) {
+        return root;
+    }
+    return std::pow(*root, 3);
+}
+
+}
+#endif
+
+namespace withExceptions {
+
+static double division(const double dividend, const double divisor) {
+    if (divisor == 0.0) {
+        throw std::domain_error(Error_explain(DomainError));
+    }
+    return dividend / divisor;
+}
+
+static double squareRoot(const double number) {
+    if (number < 0.0) {
+        throw std::domain_error(Error_explain(DomainError));
+    }
+    return std::sqrt(number);
+}
+
+static double run(const double dividend, const double divisor) {
+    return std::pow(squareRoot(division(dividend, divisor)), 3);
+}
+
+}
+
+static double now(void) {
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (double) time.tv_sec + (double) time.tv_nsec / 1e9;
+}
+
+template<class F>
+static double run(F f, const size_t iterations, double *checksum) {
+    const double start = now();
+    for (size_t i = 0; i < iterations; i++) {
+        // every fourth division fails, one iteration in eight fails at the square root
+        const double divisor = (double) (i % 4), dividend = (i % 8 == 1) ? -36.0 : 36.0;
+        *checksum += f(dividend, divisor);
+    }
+    return now() - start;
+}
+
+static double resultPipeline(const double dividend, const double divisor) {
+    const result::Result<double> outcome = withResult::run(dividend, divisor);
+    return outcome.is_ok() ? outcome.value() : 1.0;
+}
+
+#if defined(__cpp_lib_expected)
+static double expectedPipeline(const double dividend, const double divisor) {
+    const std::expected<double, Error> outcome = withExpected::run(dividend, divisor);
+    return outcome.has_value() ? outcome.value() : 1.0;
+}
+#endif
+
+static double exceptionsPipeline(const double dividend, const double divisor) {
+    try {
+        return withExceptions::run(dividend, divisor);
+    } catch (const std::domain_error &) {
+        return 1.0;
+    }
+}
+
+int main(int argc, char **argv) {
+    const size_t iterations = (argc > 1) ? strtoul(argv[1], NULL, 10) : 10000000;
+    double resultChecksum = 0, exceptionsChecksum = 0;
+
+    // warm up
+    run(resultPipeline, iterations / 10, &resultChecksum);
+    run(exceptionsPipeline, iterations / 10, &exceptionsChecksum);
+
+    resultChecksum = exceptionsChecksum = 0;
+    const double resultTime = run(resultPipeline, iterations, &resultChecksum);
+    const double exceptionsTime = run(exceptionsPipeline, iterations, &exceptionsChecksum);
+
+    printf("iterations: %zu\n", iterations);
+    printf("result::Result: %8.2f ns/op (checksum %g)\n", resultTime * 1e9 / (double) iterations, resultChecksum);
+#if defined(__cpp_lib_expected)
+    double expectedChecksum = 0;
+    run(expectedPipeline, iterations / 10, &expectedChecksum);
+    expectedChecksum = 0;
+    const double expectedTime = run(expectedPipeline, iterations, &expectedChecksum);
+    printf("std::expected:  %8.2f ns/op (checksum %g)\n", expectedTime * 1e9 / (double) iterations, expectedChecksum);
+    if (expectedChecksum != resultChecksum) {
+        return EXIT_FAILURE;
+    }
+#else
+    printf("std::expected:  unavailable\n");
+#endif
+    printf("exceptions:     %8.2f ns/op (checksum %g)\n", exceptionsTime * 1e9 / (double) iterations, exceptionsChecksum);
+    return (resultChecksum == exceptionsChecksum) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
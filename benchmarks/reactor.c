@@ -0,0 +1,173 @@
+/*
+Author: daddinuz
+email:  daddinuz@gmail.com
+
+Copyright (c) 2018 Davide Di Carlo
+
+Permission is hereby granted, free of charge, to any person
+obtaining a copy of this software and associated documentation
+files (the "Software"), to deal in the Software without
+restriction, including without limitation the rights to use,
+copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be
+included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * Compares the round trip latency of a one byte echo served by reactors (one per core) against a thread spawned per
+ * request, over local stream sockets.
+ *
+ * Usage: benchmark-reactor [requests] [connections]
+ */
+
+#include <time.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <result-reactor.h>
+
+#define REACTORS_MAX    64
+
+typedef struct {
+    ResultReactor reactor;
+    size_t core;
+} Worker;
+
+static uint64_t now(void) {
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (uint64_t) time.tv_sec * UINT64_C(1000000000) + (uint64_t) time.tv_nsec;
+}
+
+static int compare(const void *a, const void *b) {
+    const uint64_t x = *(const uint64_t *) a, y = *(const uint64_t *) b;
+    return (x > y) - (x < y);
+}
+
+static void report(const char *name, uint64_t *latencies, const size_t size) {
+    uint64_t total = 0;
+    for (size_t i = 0; i < size; i++) {
+        total += latencies[i];
+    }
+    qsort(latencies, size, sizeof(latencies[0]), compare);
+    printf("%-18s mean %8.2f us, p50 %8.2f us, p99 %8.2f us\n", name, (double) total / (double) size / 1e3,
+           (double) latencies[size / 2] / 1e3, (double) latencies[size * 99 / 100] / 1e3);
+}
+
+static Result echo(Result event, void *context) {
+    (void) context;
+    Result_try(ready, event);
+    char byte;
+    const int fd = ResultReactor_eventFd(ready);
+    if (1 != read(fd, &byte, 1) || 1 != write(fd, &byte, 1)) {
+        return Result_error(StopIteration);
+    }
+    return event;
+}
+
+static void *runWorker(void *argument) {
+    Worker *worker = argument;
+    if (!ResultReactor_pin(worker->core)) {
+        fprintf(stderr, "unable to pin a reactor to core %zu\n", worker->core);
+    }
+    ResultReactor_run(worker->reactor);
+    return NULL;
+}
+
+static void *serveRequest(void *argument) {
+    const int fd = (int) (intptr_t) argument;
+    char byte;
+    if (1 == read(fd, &byte, 1)) {
+        (void) !write(fd, &byte, 1);
+    }
+    return NULL;
+}
+
+static void request(const int fd, const uint64_t start, uint64_t *latency, pthread_t *thread) {
+    char byte = 'x';
+    if (1 != write(fd, &byte, 1) || 1 != read(fd, &byte, 1)) {
+        exit(EXIT_FAILURE);
+    }
+    *latency = now() - start;
+    if (NULL != thread) {
+        pthread_join(*thread, NULL);
+    }
+}
+
+int main(int argc, char **argv) {
+    const size_t requests = (argc > 1) ? strtoul(argv[1], NULL, 10) : 20000;
+    const size_t connections = (argc > 2) ? strtoul(argv[2], NULL, 10) : 64;
+    const long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    const size_t reactors = (cores < 1) ? 1 : (cores > REACTORS_MAX) ? REACTORS_MAX : (size_t) cores;
+    uint64_t *latencies = malloc(requests * sizeof(latencies[0]));
+    int (*pairs)[2] = malloc(connections * sizeof(pairs[0]));
+    if (NULL == latencies || NULL == pairs || 0 == requests || 0 == connections) {
+        return EXIT_FAILURE;
+    }
+    for (size_t i = 0; i < connections; i++) {
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, pairs[i]) < 0) {
+            return EXIT_FAILURE;
+        }
+    }
+
+    // reactors, connections spread round robin
+    Worker workers[REACTORS_MAX];
+    pthread_t threads[REACTORS_MAX];
+    for (size_t i = 0; i < reactors; i++) {
+        workers[i] = (Worker) {.reactor=ResultReactor_new(), .core=i};
+    }
+    for (size_t i = 0; i < connections; i++) {
+        if (!Result_isOk(ResultReactor_watch(workers[i % reactors].reactor, pairs[i][1], ResultReactor_Readable,
+                                             RESULT_REACTOR_FOREVER, echo, NULL))) {
+            return EXIT_FAILURE;
+        }
+    }
+    for (size_t i = 0; i < reactors; i++) {
+        pthread_create(&threads[i], NULL, runWorker, &workers[i]);
+    }
+    for (size_t i = 0; i < requests; i++) {
+        request(pairs[i % connections][0], now(), &latencies[i], NULL);
+    }
+    for (size_t i = 0; i < reactors; i++) {
+        ResultReactor_stop(workers[i].reactor);
+        pthread_join(threads[i], NULL);
+        ResultReactor_delete(workers[i].reactor);
+    }
+    printf("requests: %zu, connections: %zu, reactors: %zu\n", requests, connections, reactors);
+    report("reactor per core:", latencies, requests);
+
+    // a thread per request, blocking on its connection; its creation is part of the latency
+    for (size_t i = 0; i < requests; i++) {
+        pthread_t thread;
+        const int fd = pairs[i % connections][1];
+        const uint64_t start = now();
+        if (0 != pthread_create(&thread, NULL, serveRequest, (void *) (intptr_t) fd)) {
+            return EXIT_FAILURE;
+        }
+        request(pairs[i % connections][0], start, &latencies[i], &thread);
+    }
+    report("thread per request:", latencies, requests);
+
+    for (size_t i = 0; i < connections; i++) {
+        close(pairs[i][0]);
+        close(pairs[i][1]);
+    }
+    free(pairs);
+    free(latencies);
+    return EXIT_SUCCESS;
+}
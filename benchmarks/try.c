@@ -0,0 +1,109 @@
+/*
+Author: daddinuz
+email:  daddinuz@gmail.com
+
+Copyright (c) 2018 Davide Di Carlo
+
+Permission is hereby granted, free of charge, to any person
+obtaining a copy of this software and associated documentation
+files (the "Software"), to deal in the Software without
+restriction, including without limitation the rights to use,
+copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be
+included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * Compares failure propagation through nested `Result_chain(...)` calls against `Result_try(...)` on the example's
+ * division -> squareRoot -> cube pipeline.
+ *
+ * Usage: benchmark-try [iterations]
+ */
+
+#include <math.h>
+#include <time.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <result.h>
+
+#define NUMBERS_SIZE    1024
+
+typedef const double *Number;
+
+static double numbers[NUMBERS_SIZE];
+static size_t numbersCursor = 0;
+
+static Number Number_new(const double number) {
+    double *slot = &numbers[numbersCursor++ % NUMBERS_SIZE];
+    *slot = number;
+    return slot;
+}
+
+static const void *cube(const void *number) {
+    return Number_new(pow(*(Number) number, 3));
+}
+
+static Result division(Number dividend, Number divisor) {
+    return *divisor == 0.0 ? Result_error(DomainError) : Result_ok(Number_new(*dividend / *divisor));
+}
+
+static Result squareRoot(const void *number) {
+    return *(Number) number < 0.0 ? Result_error(DomainError) : Result_ok(Number_new(sqrt(*(Number) number)));
+}
+
+static Result withChain(Number dividend, Number divisor) {
+    return Result_map(Result_chain(division(dividend, divisor), squareRoot), cube);
+}
+
+static Result withTry(Number dividend, Number divisor) {
+    Result_try(quotient, division(dividend, divisor));
+    Result_try(root, squareRoot(quotient));
+    return Result_fromNullable(cube(root));
+}
+
+static double now(void) {
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (double) time.tv_sec + (double) time.tv_nsec / 1e9;
+}
+
+static double run(Result f(Number, Number), const size_t iterations, double *checksum) {
+    const double start = now();
+    for (size_t i = 0; i < iterations; i++) {
+        // every fourth division fails, one iteration in eight fails at the square root
+        const double divisor = (double) (i % 4), dividend = (i % 8 == 1) ? -36.0 : 36.0;
+        const Result result = f(Number_new(dividend), Number_new(divisor));
+        *checksum += Result_isOk(result) ? *(Number) Result_unwrap(result) : 1.0;
+    }
+    return now() - start;
+}
+
+int main(int argc, char **argv) {
+    const size_t iterations = (argc > 1) ? strtoul(argv[1], NULL, 10) : 10000000;
+    double chainChecksum = 0, tryChecksum = 0;
+
+    // warm up
+    run(withChain, iterations / 10, &chainChecksum);
+    run(withTry, iterations / 10, &tryChecksum);
+
+    chainChecksum = tryChecksum = 0;
+    const double chainTime = run(withChain, iterations, &chainChecksum);
+    const double tryTime = run(withTry, iterations, &tryChecksum);
+
+    printf("iterations: %zu\n", iterations);
+    printf("Result_chain: %8.2f ns/op (checksum %g)\n", chainTime * 1e9 / (double) iterations, chainChecksum);
+    printf("Result_try:   %8.2f ns/op (checksum %g)\n", tryTime * 1e9 / (double) iterations, tryChecksum);
+    return (chainChecksum == tryChecksum) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
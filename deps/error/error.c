@@ -29,18 +29,60 @@ OTHER DEALINGS IN THE SOFTWARE.
 #include <stddef.h>
 #include "error.h"
 
+/*
+ * Indices are stored off by one so that 0 means not yet assigned.
+ */
+#define Error_builtin(message, index) \
+     ((Error) &((const struct __Error) {.__message=(message), .__index=(size_t[]) {(index) + 1}}))
+
+static size_t indices = ERROR_BUILTINS;
+
 const char *Error_explain(Error self) {
     assert(NULL != self);
     return self->__message;
 }
 
-Error Ok = Error_new("Ok");
-Error DomainError = Error_new("Domain error");
-Error IllegalState = Error_new("Illegal state");
-Error LookupError = Error_new("Lookup error");
-Error MathError = Error_new("Math error");
-Error MemoryError = Error_new("Memory error");
-Error NullReferenceError = Error_new("Null reference error");
-Error OutOfMemory = Error_new("Out of memory");
-Error SystemError = Error_new("System error");
-Error StopIteration = Error_new("Stop iteration");
+size_t Error_index(Error self) {
+    assert(NULL != self);
+    size_t index = __atomic_load_n(self->__index, __ATOMIC_ACQUIRE);
+    if (0 == index) {
+        // racing threads may burn an index, the one that wins the exchange is kept
+        const size_t candidate = __atomic_fetch_add(&indices, 1, __ATOMIC_RELAXED) + 1;
+        if (__atomic_compare_exchange_n(self->__index, &index, candidate, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+            index = candidate;
+        }
+    }
+    return index - 1;
+}
+
+size_t Error_indices(void) {
+    return __atomic_load_n(&indices, __ATOMIC_ACQUIRE);
+}
+
+Error Ok = Error_builtin("Ok", 0);
+Error DomainError = Error_builtin("Domain error", 1);
+Error IllegalState = Error_builtin("Illegal state", 2);
+Error LookupError = Error_builtin("Lookup error", 3);
+Error MathError = Error_builtin("Math error", 4);
+Error MemoryError = Error_builtin("Memory error", 5);
+Error NullReferenceError = Error_builtin("Null reference error", 6);
+Error OutOfMemory = Error_builtin("Out of memory", 7);
+Error SystemError = Error_builtin("System error", 8);
+Error StopIteration = Error_builtin("Stop iteration", 9);
+Error TimeoutError = Error_builtin("Timeout error", 10);
+Error Cancelled = Error_builtin("Cancelled", 11);
+
+/*
+ * Ordered by index, keep in sync with ERROR_BUILTINS.
+ */
+static Error *const builtins[] = {
+        &Ok, &DomainError, &IllegalState, &LookupError, &MathError, &MemoryError, &NullReferenceError, &OutOfMemory,
+        &SystemError, &StopIteration, &TimeoutError, &Cancelled,
+};
+
+_Static_assert(sizeof(builtins) / sizeof(builtins[0]) == ERROR_BUILTINS, "ERROR_BUILTINS is out of sync");
+
+Error Error_builtinAt(const size_t index) {
+    assert(index < ERROR_BUILTINS);
+    return *builtins[index];
+}
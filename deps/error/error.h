@@ -27,6 +27,8 @@ OTHER DEALINGS IN THE SOFTWARE.
 
 #pragma once
 
+#include <stddef.h>
+
 #if !(defined(__GNUC__) || defined(__clang__))
 __attribute__(...)
 #endif
@@ -35,12 +37,12 @@ __attribute__(...)
 extern "C" {
 #endif
 
-#define ERROR_VERSION_MAJOR         1
+#define ERROR_VERSION_MAJOR         2
 #define ERROR_VERSION_MINOR         0
 #define ERROR_VERSION_PATCH         0
 #define ERROR_VERSION_SUFFIX        ""
 #define ERROR_VERSION_IS_RELEASE    0
-#define ERROR_VERSION_HEX           0x010000
+#define ERROR_VERSION_HEX           0x020000
 
 /**
  * Represents errors that may occur at runtime.
@@ -52,6 +54,7 @@ extern "C" {
  */
 typedef struct __Error {
     const char *const __message;
+    size_t *const __index;
 } const *Error;
 
 /**
@@ -67,9 +70,12 @@ typedef struct __Error {
  * @code
  * Error CustomError = Error_new("Custom error explanation");
  * @endcode
+ *
+ * @attention errors should be created at file scope: at block scope every evaluation creates a distinct error, which
+ * takes a new index the first time it is passed to `Error_index(...)`.
  */
 #define Error_new(message) \
-     ((Error) &((const struct __Error) {.__message=(message)}))
+     ((Error) &((const struct __Error) {.__message=(message), .__index=(size_t[]) {0}}))
 
 /**
  * Gets the error message explanation.
@@ -79,6 +85,38 @@ typedef struct __Error {
 extern const char *Error_explain(Error self)
 __attribute__((__warn_unused_result__, __nonnull__));
 
+/**
+ * Gets a small integer identifying the error, indices are unique and given out in increasing order starting from 0.
+ * Built-in errors have fixed indices in the order they are declared below, `Ok` being 0; other errors get the next
+ * free index the first time this function is called on them.
+ * Indices are not guaranteed to be dense: threads racing on the first call for the same error may leave an unused
+ * index behind.
+ *
+ * @attention self must not be `NULL`.
+ */
+extern size_t Error_index(Error self)
+__attribute__((__warn_unused_result__, __nonnull__));
+
+/**
+ * Gets the number of indices given out so far, every index returned by `Error_index(...)` is lower than this.
+ */
+extern size_t Error_indices(void)
+__attribute__((__warn_unused_result__));
+
+/**
+ * The number of built-in errors, they have the indices from 0 to `ERROR_BUILTINS - 1`.
+ */
+#define ERROR_BUILTINS              12
+
+/**
+ * Gets the built-in error with the given index, built-in indices are the same in every process so they may be used
+ * to refer to built-in errors across processes.
+ *
+ * @attention index must be lower than `ERROR_BUILTINS`.
+ */
+extern Error Error_builtinAt(size_t index)
+__attribute__((__warn_unused_result__));
+
 /**
  * Built-in errors
  */
@@ -92,6 +130,8 @@ extern Error NullReferenceError;    // Got a null reference where is not allowed
 extern Error OutOfMemory;           // The app ran out of memory
 extern Error SystemError;           // System-related errors e.g. file not found
 extern Error StopIteration;         // Indicates that the end of a sequence has been reached
+extern Error TimeoutError;          // A deadline expired before the operation could complete
+extern Error Cancelled;             // The operation has been abandoned on request
 
 #ifdef __cplusplus
 }
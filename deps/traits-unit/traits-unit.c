@@ -28,12 +28,15 @@
 
 #include <errno.h>
 #include <stdio.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <stdarg.h>
 #include <string.h>
 #include <assert.h>
+#include <time.h>
 #include <unistd.h>
-#include <sys/mman.h>
+#include <fcntl.h>
+#include <fnmatch.h>
 #include <sys/wait.h>
 #include "traits-unit.h"
 
@@ -48,9 +51,13 @@
  * Some constants
  */
 #define TRAITS_UNIT_OUTPUT_STREAM                       stdout
-#define TRAITS_UNIT_BUFFER_CAPACITY                     1024
+#define TRAITS_UNIT_BUFFER_CAPACITY                     4096
+#define TRAITS_UNIT_BUFFER_CHUNK_SIZE                   4096
+#define TRAITS_UNIT_BUFFER_NOTICE_CAPACITY              64
 #define TRAITS_UNIT_INDENTATION_STEP                    2
 #define TRAITS_UNIT_INDENTATION_START                   0
+#define TRAITS_UNIT_DEFAULT_FEATURE_WEIGHT              1.0
+#define TRAITS_UNIT_PREFORK_POOL_SIZE                   2
 
 /*
  * Forward declare traits subject (this should come from the test file Describe macro)
@@ -74,13 +81,31 @@ static void *global_context = NULL;
 static bool global_context_initialized = false;
 static traits_unit_feature_t *global_feature = NULL;
 
+static const int global_sandbox_signals[] = {SIGABRT, SIGSEGV, SIGBUS, SIGFPE, SIGILL};
+static void (*global_sandbox_previous_handlers[sizeof(global_sandbox_signals) / sizeof(global_sandbox_signals[0])])(int);
+static sigjmp_buf global_sandbox_jump_buffer;
+static volatile sig_atomic_t global_sandbox_active = 0;
+static bool global_in_process = false;
+
 /*
  * Define internal types
  */
+/*
+ * Keeps the first and the last `_capacity` bytes of an output of any length, optionally spilling all of it to a file.
+ */
 typedef struct traits_unit_buffer_t {
-    size_t _index;
     size_t _capacity;
+    size_t _head_size;
+    size_t _tail_index;
+    size_t _tail_size;
+    size_t _total;
+    char *_head;
+    char *_tail;
     char *_content;
+    const char *_spill_directory;
+    char *_spill_path;
+    char *_kept_path;
+    int _spill_fd;
 } traits_unit_buffer_t;
 
 typedef struct traits_unit_trait_result_t {
@@ -91,6 +116,46 @@ typedef struct traits_unit_trait_result_t {
     size_t all;
 } traits_unit_trait_result_t;
 
+typedef struct traits_unit_worker_t {
+    pid_t pid;
+    int command_fd;
+    int output_fd;
+} traits_unit_worker_t;
+
+typedef struct traits_unit_options_t {
+    bool in_process;
+    const char *filter;
+    const char *timings;
+    const char *record_timings;
+    const char *spill_directory;
+    size_t shard_index;
+    size_t shard_count;
+    char **traits_names;
+    size_t traits_names_size;
+} traits_unit_options_t;
+
+typedef struct traits_unit_plan_entry_t {
+    traits_unit_trait_t *trait;
+    traits_unit_feature_t *feature;
+    size_t trait_index;
+    double weight;
+    double elapsed;
+    bool selected;
+    bool executed;
+} traits_unit_plan_entry_t;
+
+typedef struct traits_unit_timing_t {
+    char *trait_name;
+    char *feature_name;
+    double seconds;
+} traits_unit_timing_t;
+
+typedef struct traits_unit_timings_t {
+    traits_unit_timing_t *entries;
+    size_t size;
+    size_t capacity;
+} traits_unit_timings_t;
+
 typedef enum traits_unit_feature_result_t {
     TRAITS_UNIT_FEATURE_RESULT_SUCCEED,
     TRAITS_UNIT_FEATURE_RESULT_SKIPPED,
@@ -98,17 +163,22 @@ typedef enum traits_unit_feature_result_t {
     TRAITS_UNIT_FEATURE_RESULT_TODO,
 } traits_unit_feature_result_t;
 
+/*
+ * Define the pool of pre-forked workers
+ */
+static traits_unit_worker_t global_pool[TRAITS_UNIT_PREFORK_POOL_SIZE];
+static size_t global_pool_size = 0;
+static size_t global_pending_features = 0;
+static size_t global_pending_isolated = 0;
+
 /*
  * Declare internal functions
  */
-static void *
-traits_unit_shared_malloc(size_t size);
+static traits_unit_buffer_t *
+traits_unit_buffer_new(size_t capacity, const char *spill_directory);
 
 static void
-traits_unit_shared_free(void *address, size_t size);
-
-static traits_unit_buffer_t *
-traits_unit_buffer_new(size_t capacity);
+traits_unit_buffer_write(traits_unit_buffer_t *buffer, const char *data, size_t size);
 
 static void
 traits_unit_buffer_read(traits_unit_buffer_t *buffer, int fd);
@@ -116,6 +186,9 @@ traits_unit_buffer_read(traits_unit_buffer_t *buffer, int fd);
 static char *
 traits_unit_buffer_get(traits_unit_buffer_t *buffer);
 
+static const char *
+traits_unit_buffer_keep(traits_unit_buffer_t *buffer, const char *trait_name, const char *feature_name);
+
 static void
 traits_unit_buffer_clear(traits_unit_buffer_t *buffer);
 
@@ -136,14 +209,73 @@ traits_unit_teardown(void);
 static void
 traits_unit_register_teardown_on_exit(void);
 
+static bool
+traits_unit_parse_options(int argc, char *argv[], traits_unit_options_t *options);
+
+static bool
+traits_unit_parse_shard(const char *text, size_t *index, size_t *count);
+
+static traits_unit_plan_entry_t *
+traits_unit_plan_new(traits_unit_trait_t **traits_list, size_t traits_list_size, const char *filter, size_t *size);
+
+static void
+traits_unit_plan_shard(traits_unit_plan_entry_t *plan, size_t plan_size, size_t shard_index, size_t shard_count);
+
+static void
+traits_unit_timings_load(traits_unit_timings_t *timings, const char *path);
+
+static void
+traits_unit_timings_apply(traits_unit_timings_t *timings, traits_unit_plan_entry_t *plan, size_t plan_size);
+
+static void
+traits_unit_timings_store(traits_unit_timings_t *timings, traits_unit_plan_entry_t *plan, size_t plan_size,
+                          const char *path);
+
+static int
+traits_unit_timing_compare(const void *a, const void *b);
+
+static traits_unit_timing_t *
+traits_unit_timings_find(traits_unit_timings_t *timings, size_t size, const char *trait_name, const char *feature_name);
+
+static void
+traits_unit_timings_push(traits_unit_timings_t *timings, const char *trait_name, const char *feature_name,
+                         double seconds);
+
+static void
+traits_unit_timings_delete(traits_unit_timings_t *timings);
+
 static traits_unit_trait_result_t
-traits_unit_run_trait(size_t indentation_level, traits_unit_trait_t *trait, traits_unit_buffer_t *buffer);
+traits_unit_run_trait(size_t indentation_level, traits_unit_plan_entry_t *entries, size_t entries_size,
+                      traits_unit_buffer_t *buffer);
+
+static void
+traits_unit_worker_spawn(traits_unit_worker_t *worker);
+
+static void
+traits_unit_worker_run(int command_fd)
+__attribute__((__noreturn__));
+
+static void
+traits_unit_pool_acquire(traits_unit_worker_t *worker);
+
+static void
+traits_unit_pool_fill(void);
+
+static void
+traits_unit_pool_drain(void);
 
 static int
 traits_unit_fork_and_run_feature(traits_unit_feature_t *feature, traits_unit_buffer_t *buffer);
 
+static bool
+traits_unit_run_feature_in_process(traits_unit_feature_t *feature);
+
+static void
+traits_unit_sandbox_signal_handler(int signal_id);
+
 static traits_unit_feature_result_t
-traits_unit_run_feature(size_t indentation_level, traits_unit_feature_t *feature, traits_unit_buffer_t *buffer);
+traits_unit_run_feature(size_t indentation_level, traits_unit_trait_t *trait, traits_unit_feature_t *feature,
+                        traits_unit_buffer_t *buffer);
 
 static void
 traits_unit_report(size_t indentation_level, size_t succeed, size_t skipped, size_t failed, size_t todo, size_t all);
@@ -151,6 +283,9 @@ traits_unit_report(size_t indentation_level, size_t succeed, size_t skipped, siz
 static void
 traits_unit_signal_handler(int signal_id);
 
+extern void
+__traits_assertion_failed(void);
+
 /*
  * Define internal macros
  */
@@ -198,54 +333,89 @@ int
 main(int argc, char *argv[]) {
     bool loaded = true;
     traits_unit_buffer_t *buffer = NULL;
-    traits_unit_trait_t *traits_list[TRAITS_UNIT_MAX_TRAITS] = {0};
+    traits_unit_trait_t **traits_list = NULL;
+    traits_unit_plan_entry_t *plan = NULL;
+    traits_unit_timings_t timings = {0};
+    traits_unit_options_t options = {0};
+    size_t traits_list_size = 0, plan_size = 0;
     size_t counter_succeed = 0, counter_skipped = 0, counter_failed = 0, counter_todo = 0, counter_all = 0;
     size_t indentation_level = TRAITS_UNIT_INDENTATION_START;
 
     traits_unit_print(0, "Running traits-unit version %s\n\n", traits_unit_version());
 
-    /* Load traits_list */
-    if (argc > 1) {
-        /* Specific traits must be run */
-        if (argc > TRAITS_UNIT_MAX_TRAITS) {
-            /* Too many traits has been specified, not able to load traits_list */
-            loaded = false;
-            traits_unit_print(indentation_level, "Too many traits specified\n");
-        } else {
-            /* Search for the specified traits and load them into traits_list */
-            size_t index = 0;
-            traits_unit_trait_t *trait = NULL;
-            for (int x = 1; x < argc; x++) {
-                bool found = false;
-                for (size_t y = 0; (trait = &traits_unit_subject.traits[y]) && trait->trait_name; y++) {
-                    if (0 == strcmp(trait->trait_name, argv[x])) {
-                        found = true;
-                        traits_list[index++] = trait;
-                    }
-                }
-                if (!found) {
-                    /* No such trait found, not able to load traits_list */
-                    loaded = false;
-                    traits_unit_print(indentation_level, "Unknown trait: `%s`\n", argv[x]);
-                    break;
+    /* Parse options, the remaining arguments are the names of the traits to be run */
+    options.traits_names = calloc((size_t) argc, sizeof(*options.traits_names));
+    if (!options.traits_names) {
+        traits_unit_panic("%s\n", "Out of memory.");
+    }
+    loaded = traits_unit_parse_options(argc, argv, &options);
+    global_in_process = options.in_process;
+
+    /* Load traits_list, every name may match at most all the traits of the subject */
+    traits_list = calloc(
+            traits_unit_subject.traits_size * (options.traits_names_size > 0 ? options.traits_names_size : 1),
+            sizeof(*traits_list)
+    );
+    if (!traits_list && traits_unit_subject.traits_size > 0) {
+        traits_unit_panic("%s\n", "Out of memory.");
+    }
+
+    if (!loaded) {
+        /* Options are malformed, not able to load traits_list */
+    } else if (options.traits_names_size > 0) {
+        /* Search for the specified traits and load them into traits_list */
+        for (size_t x = 0; x < options.traits_names_size; x++) {
+            bool found = false;
+            for (size_t y = 0; y < traits_unit_subject.traits_size; y++) {
+                traits_unit_trait_t *trait = &traits_unit_subject.traits[y];
+                if (0 == strcmp(trait->trait_name, options.traits_names[x])) {
+                    found = true;
+                    traits_list[traits_list_size++] = trait;
                 }
             }
+            if (!found) {
+                /* No such trait found, not able to load traits_list */
+                loaded = false;
+                traits_unit_print(indentation_level, "Unknown trait: `%s`\n", options.traits_names[x]);
+                break;
+            }
         }
     } else {
         /* Load all traits present in traits_subject */
-        for (size_t i = 0; i < TRAITS_UNIT_MAX_TRAITS; i++) {
-            traits_list[i] = &traits_unit_subject.traits[i];
+        for (size_t i = 0; i < traits_unit_subject.traits_size; i++) {
+            traits_list[traits_list_size++] = &traits_unit_subject.traits[i];
         }
     }
 
     if (loaded) {
+        /* Select the features to be run by this process */
+        plan = traits_unit_plan_new(traits_list, traits_list_size, options.filter, &plan_size);
+        if (options.timings) {
+            traits_unit_timings_load(&timings, options.timings);
+            traits_unit_timings_apply(&timings, plan, plan_size);
+            traits_unit_timings_delete(&timings);
+        }
+        traits_unit_plan_shard(plan, plan_size, options.shard_index, options.shard_count);
+
+        /* Count the features left to run, the pool of workers is never filled past them */
+        for (size_t i = 0; i < plan_size; i++) {
+            if (plan[i].selected && TRAITS_UNIT_ACTION_RUN == plan[i].feature->action) {
+                global_pending_features++;
+                global_pending_isolated += plan[i].feature->isolated ? 1 : 0;
+            }
+        }
+
         /* Run features of traits in traits_list */
-        traits_unit_trait_t *trait = NULL;
-        buffer = traits_unit_buffer_new(TRAITS_UNIT_BUFFER_CAPACITY);
+        buffer = traits_unit_buffer_new(TRAITS_UNIT_BUFFER_CAPACITY, options.spill_directory);
         traits_unit_print(indentation_level, "Describing: %s\n", traits_unit_subject.subject);
         indentation_level += TRAITS_UNIT_INDENTATION_STEP;
-        for (size_t i = 0; (trait = traits_list[i]) && trait->trait_name; i++) {
-            traits_unit_trait_result_t trait_result = traits_unit_run_trait(indentation_level, trait, buffer);
+        for (size_t begin = 0, end = 0; begin < plan_size; begin = end) {
+            while (end < plan_size && plan[end].trait_index == plan[begin].trait_index) {
+                end++;
+            }
+            traits_unit_trait_result_t trait_result = traits_unit_run_trait(
+                    indentation_level, &plan[begin], end - begin, buffer
+            );
             counter_succeed += trait_result.succeed;
             counter_skipped += trait_result.skipped;
             counter_failed += trait_result.failed;
@@ -257,8 +427,18 @@ main(int argc, char *argv[]) {
                 indentation_level, counter_succeed, counter_skipped, counter_failed, counter_todo, counter_all
         );
         traits_unit_buffer_delete(&buffer);
+        traits_unit_pool_drain();
+
+        if (options.record_timings) {
+            traits_unit_timings_load(&timings, options.record_timings);
+            traits_unit_timings_store(&timings, plan, plan_size, options.record_timings);
+            traits_unit_timings_delete(&timings);
+        }
     }
 
+    free(plan);
+    free(traits_list);
+    free(options.traits_names);
     return (loaded && (0 == counter_failed)) ? EXIT_SUCCESS : EXIT_FAILURE;
 }
 
@@ -300,92 +480,183 @@ FixtureImplements(__TraitsUnitDefaultFixture, __TraitsUnitDefaultSetup, __Traits
 /*
  * Define internal functions
  */
-void *
-traits_unit_shared_malloc(size_t size) {
-    /* Our memory will be readable and writable */
-    int protection = PROT_READ | PROT_WRITE;
-
-    /*
-     * The buffer will be shared (meaning other processes can access it), but
-     * anonymous (meaning third-party processes cannot obtain an address for it),
-     * so only this process and its children will be able to use it.
-     */
-    int visibility = MAP_ANONYMOUS | MAP_SHARED;
-
-    /* Perform memory mapping */
-    void *memory = mmap(NULL, size, protection, visibility, 0, 0);
-    if (!memory) {
-        traits_unit_panic("%s\n", "Unable to map memory");
-    }
-
-    return memory;
-}
-
-void
-traits_unit_shared_free(void *address, size_t size) {
-    if (0 != munmap(address, size)) {
-        traits_unit_panic("%s\n", "Unable to unmap memory");
-    }
-}
-
 traits_unit_buffer_t *
-traits_unit_buffer_new(size_t capacity) {
-    traits_unit_buffer_t *self = traits_unit_shared_malloc(sizeof(*self));
+traits_unit_buffer_new(size_t capacity, const char *spill_directory) {
+    traits_unit_buffer_t *self = calloc(1, sizeof(*self));
     if (!self) {
         traits_unit_panic("%s\n", "Out of memory.");
         abort(); // not needed just to quiet analyzer
     }
-    self->_content = traits_unit_shared_malloc(capacity + 1);
-    if (!self->_content) {
+    /* Head and tail are kept separately, plus room for the omission notice and the terminator */
+    self->_head = malloc(capacity);
+    self->_tail = malloc(capacity);
+    self->_content = malloc(2 * capacity + TRAITS_UNIT_BUFFER_NOTICE_CAPACITY + 1);
+    if (!self->_head || !self->_tail || !self->_content) {
         traits_unit_panic("%s\n", "Out of memory.");
     }
-    self->_index = 0;
     self->_capacity = capacity;
-    self->_content[capacity] = 0;
+    self->_content[0] = 0;
+    self->_spill_fd = -1;
+    if (spill_directory) {
+        const size_t size = strlen(spill_directory) + TRAITS_UNIT_BUFFER_NOTICE_CAPACITY;
+        self->_spill_directory = spill_directory;
+        self->_spill_path = malloc(size);
+        if (!self->_spill_path) {
+            traits_unit_panic("%s\n", "Out of memory.");
+        }
+        snprintf(self->_spill_path, size, "%s/.traits-unit-%ld.spill", spill_directory, (long) getpid());
+        self->_spill_fd = open(self->_spill_path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (self->_spill_fd < 0) {
+            traits_unit_panic("Unable to open spill file: %s\n", self->_spill_path);
+        }
+    }
     return self;
 }
 
 void
-traits_unit_buffer_read(traits_unit_buffer_t *buffer, int fd) {
+traits_unit_buffer_write(traits_unit_buffer_t *buffer, const char *data, size_t size) {
     assert(buffer);
-    FILE *stream = fdopen(fd, "r");
+    assert(data);
+    buffer->_total += size;
+
+    /* Everything goes to the spill file, if any */
+    for (size_t written = 0; buffer->_spill_fd >= 0 && written < size;) {
+        const ssize_t result = write(buffer->_spill_fd, data + written, size - written);
+        if (result < 0) {
+            traits_unit_panic("Unable to write spill file: %s\n", buffer->_spill_path);
+        }
+        written += (size_t) result;
+    }
 
-    /* Open fd */
-    if (!stream) {
-        traits_unit_panic("%s\n", "Unable to open file.");
+    /* Fill the head first */
+    if (buffer->_head_size < buffer->_capacity) {
+        const size_t chunk = size < buffer->_capacity - buffer->_head_size ? size : buffer->_capacity - buffer->_head_size;
+        memcpy(buffer->_head + buffer->_head_size, data, chunk);
+        buffer->_head_size += chunk;
+        data += chunk;
+        size -= chunk;
     }
 
-    /* Read from fd and write to buffer */
-    buffer->_index += fread(
-            buffer->_content + buffer->_index,
-            sizeof(buffer->_content[0]),
-            (buffer->_index >= buffer->_capacity) ? 0 : buffer->_capacity - buffer->_index,
-            stream
-    );
-    buffer->_content[buffer->_index] = 0;
+    /* Then keep only the last bytes in the tail ring */
+    if (size >= buffer->_capacity) {
+        memcpy(buffer->_tail, data + size - buffer->_capacity, buffer->_capacity);
+        buffer->_tail_index = 0;
+        buffer->_tail_size = buffer->_capacity;
+    } else if (size > 0) {
+        const size_t chunk = size < buffer->_capacity - buffer->_tail_index ? size : buffer->_capacity - buffer->_tail_index;
+        memcpy(buffer->_tail + buffer->_tail_index, data, chunk);
+        memcpy(buffer->_tail, data + chunk, size - chunk);
+        buffer->_tail_index = (buffer->_tail_index + size) % buffer->_capacity;
+        buffer->_tail_size = buffer->_tail_size + size < buffer->_capacity ? buffer->_tail_size + size : buffer->_capacity;
+    }
+}
 
-    /* Close the stream */
-    fclose(stream);
+void
+traits_unit_buffer_read(traits_unit_buffer_t *buffer, int fd) {
+    assert(buffer);
+    char chunk[TRAITS_UNIT_BUFFER_CHUNK_SIZE];
+
+    /* Read until the writer closes its end, this keeps the pipe from filling up while it is running */
+    for (;;) {
+        const ssize_t size = read(fd, chunk, sizeof(chunk));
+        if (size > 0) {
+            traits_unit_buffer_write(buffer, chunk, (size_t) size);
+        } else if (0 == size) {
+            break;
+        } else if (EINTR != errno) {
+            traits_unit_panic("%s\n", "Unable to read from pipe.");
+        }
+    }
+
+    /* Close fd */
+    close(fd);
 }
 
 char *
 traits_unit_buffer_get(traits_unit_buffer_t *buffer) {
     assert(buffer);
+    char *cursor = buffer->_content;
+    memcpy(cursor, buffer->_head, buffer->_head_size);
+    cursor += buffer->_head_size;
+    if (buffer->_total > buffer->_head_size + buffer->_tail_size) {
+        cursor += snprintf(
+                cursor, TRAITS_UNIT_BUFFER_NOTICE_CAPACITY, "\n[... %zu bytes omitted ...]\n",
+                buffer->_total - buffer->_head_size - buffer->_tail_size
+        );
+    }
+    if (buffer->_tail_size < buffer->_capacity) {
+        memcpy(cursor, buffer->_tail, buffer->_tail_size);
+    } else {
+        /* The ring is full, the oldest byte is at the write position */
+        memcpy(cursor, buffer->_tail + buffer->_tail_index, buffer->_capacity - buffer->_tail_index);
+        memcpy(cursor + buffer->_capacity - buffer->_tail_index, buffer->_tail, buffer->_tail_index);
+    }
+    cursor[buffer->_tail_size] = 0;
     return buffer->_content;
 }
 
+const char *
+traits_unit_buffer_keep(traits_unit_buffer_t *buffer, const char *trait_name, const char *feature_name) {
+    assert(buffer);
+    assert(trait_name);
+    assert(feature_name);
+    if (buffer->_spill_fd < 0) {
+        return NULL;
+    }
+    /* Logs are named `<trait>.<feature>.log`, the same feature name may be used by different traits */
+    const size_t size = strlen(buffer->_spill_directory) + strlen(trait_name) + strlen(feature_name) + sizeof("/..log");
+    char *kept_path = realloc(buffer->_kept_path, size);
+    if (!kept_path) {
+        traits_unit_panic("%s\n", "Out of memory.");
+    }
+    buffer->_kept_path = kept_path;
+    char *name = kept_path + snprintf(kept_path, size, "%s/", buffer->_spill_directory);
+    snprintf(name, size - (size_t) (name - kept_path), "%s%s%s.log", trait_name, *trait_name ? "." : "", feature_name);
+    /* Trait names are free text, they must not reach into other directories */
+    for (; *name; name++) {
+        if ('/' == *name) {
+            *name = '_';
+        }
+    }
+
+    /* Move the spill file out of the way and start a new one */
+    close(buffer->_spill_fd);
+    if (0 != rename(buffer->_spill_path, buffer->_kept_path)) {
+        traits_unit_panic("Unable to keep spill file: %s\n", buffer->_kept_path);
+    }
+    buffer->_spill_fd = open(buffer->_spill_path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (buffer->_spill_fd < 0) {
+        traits_unit_panic("Unable to open spill file: %s\n", buffer->_spill_path);
+    }
+    return buffer->_kept_path;
+}
+
 void
 traits_unit_buffer_clear(traits_unit_buffer_t *buffer) {
     assert(buffer);
-    buffer->_index = 0;
+    buffer->_head_size = 0;
+    buffer->_tail_index = 0;
+    buffer->_tail_size = 0;
+    buffer->_total = 0;
     buffer->_content[0] = 0;
+    if (buffer->_spill_fd >= 0 && (0 != ftruncate(buffer->_spill_fd, 0) || lseek(buffer->_spill_fd, 0, SEEK_SET) < 0)) {
+        traits_unit_panic("Unable to truncate spill file: %s\n", buffer->_spill_path);
+    }
 }
 
 void
 traits_unit_buffer_delete(traits_unit_buffer_t **buffer) {
     assert(buffer && *buffer);
-    traits_unit_shared_free((*buffer)->_content, (*buffer)->_capacity + 1);
-    traits_unit_shared_free(*buffer, sizeof(*buffer));
+    if ((*buffer)->_spill_fd >= 0) {
+        close((*buffer)->_spill_fd);
+        unlink((*buffer)->_spill_path);
+    }
+    free((*buffer)->_spill_path);
+    free((*buffer)->_kept_path);
+    free((*buffer)->_content);
+    free((*buffer)->_tail);
+    free((*buffer)->_head);
+    free(*buffer);
     *buffer = NULL;
 }
 
@@ -425,15 +696,319 @@ traits_unit_register_teardown_on_exit(void) {
     atexit(traits_unit_teardown);
 }
 
+bool
+traits_unit_parse_options(int argc, char *argv[], traits_unit_options_t *options) {
+    assert(options);
+    options->shard_index = 0;
+    options->shard_count = 1;
+    options->traits_names_size = 0;
+    for (int i = 1; i < argc; i++) {
+        if (0 == strcmp("--in-process", argv[i])) {
+            options->in_process = true;
+        } else if (0 == strcmp("--filter", argv[i]) || 0 == strcmp("--shard", argv[i]) ||
+            0 == strcmp("--timings", argv[i]) || 0 == strcmp("--record-timings", argv[i]) ||
+            0 == strcmp("--spill-output", argv[i])) {
+            if (i + 1 >= argc) {
+                traits_unit_print(TRAITS_UNIT_INDENTATION_START, "Missing argument for option: `%s`\n", argv[i]);
+                return false;
+            }
+            const char *option = argv[i++];
+            if (0 == strcmp("--filter", option)) {
+                options->filter = argv[i];
+            } else if (0 == strcmp("--timings", option)) {
+                options->timings = argv[i];
+            } else if (0 == strcmp("--record-timings", option)) {
+                options->record_timings = argv[i];
+            } else if (0 == strcmp("--spill-output", option)) {
+                options->spill_directory = argv[i];
+            } else {
+                /* Shards are numbered from 1 to n on the command line */
+                size_t index = 0, count = 0;
+                if (!traits_unit_parse_shard(argv[i], &index, &count)) {
+                    traits_unit_print(TRAITS_UNIT_INDENTATION_START, "Invalid shard: `%s` (expected i/n)\n", argv[i]);
+                    return false;
+                }
+                options->shard_index = index - 1;
+                options->shard_count = count;
+            }
+        } else {
+            options->traits_names[options->traits_names_size++] = argv[i];
+        }
+    }
+    return true;
+}
+
+bool
+traits_unit_parse_shard(const char *text, size_t *index, size_t *count) {
+    assert(text);
+    assert(index);
+    assert(count);
+    /* Only plain decimal digits are accepted, scanf-like parsing would take signs and blanks and wrap around */
+    size_t values[2] = {0, 0};
+    for (size_t i = 0; i < 2; i++) {
+        const char *digits = text;
+        for (; *text >= '0' && *text <= '9'; text++) {
+            const size_t digit = (size_t) (*text - '0');
+            if (values[i] > (SIZE_MAX - digit) / 10) {
+                return false;
+            }
+            values[i] = values[i] * 10 + digit;
+        }
+        if (digits == text || *text++ != (0 == i ? '/' : 0)) {
+            return false;
+        }
+    }
+    if (0 == values[0] || values[0] > values[1]) {
+        return false;
+    }
+    *index = values[0];
+    *count = values[1];
+    return true;
+}
+
+traits_unit_plan_entry_t *
+traits_unit_plan_new(traits_unit_trait_t **traits_list, size_t traits_list_size, const char *filter, size_t *size) {
+    assert(size);
+    size_t plan_size = 0;
+    for (size_t i = 0; i < traits_list_size; i++) {
+        plan_size += traits_list[i]->features_size;
+    }
+    traits_unit_plan_entry_t *plan = calloc(plan_size > 0 ? plan_size : 1, sizeof(*plan));
+    if (!plan) {
+        traits_unit_panic("%s\n", "Out of memory.");
+    }
+    traits_unit_plan_entry_t *entry = plan;
+    for (size_t i = 0; i < traits_list_size; i++) {
+        traits_unit_trait_t *trait = traits_list[i];
+        for (size_t j = 0; j < trait->features_size; j++, entry++) {
+            entry->trait = trait;
+            entry->feature = &trait->features[j];
+            entry->trait_index = i;
+            entry->weight = -1;
+            entry->selected = !filter || 0 == fnmatch(filter, entry->feature->feature_name, 0);
+        }
+    }
+    *size = plan_size;
+    return plan;
+}
+
+void
+traits_unit_plan_shard(traits_unit_plan_entry_t *plan, size_t plan_size, size_t shard_index, size_t shard_count) {
+    assert(shard_index < shard_count);
+    if (shard_count <= 1) {
+        return;
+    }
+
+    /* Features without a recorded duration weigh as much as the average recorded one */
+    double known_weight = 0;
+    size_t known_counter = 0;
+    for (size_t i = 0; i < plan_size; i++) {
+        if (plan[i].weight >= 0) {
+            known_weight += plan[i].weight;
+            known_counter++;
+        }
+    }
+    const double default_weight = known_counter > 0 ? known_weight / known_counter : TRAITS_UNIT_DEFAULT_FEATURE_WEIGHT;
+
+    /*
+     * Longest processing time first: heaviest features are assigned to the least loaded shard.
+     * Ties are broken by declaration order so every shard computes the same assignment.
+     */
+    size_t *order = calloc(plan_size > 0 ? plan_size : 1, sizeof(*order));
+    if (!order) {
+        traits_unit_panic("%s\n", "Out of memory.");
+    }
+    size_t order_size = 0;
+    for (size_t i = 0; i < plan_size; i++) {
+        if (plan[i].selected) {
+            if (TRAITS_UNIT_ACTION_RUN != plan[i].feature->action) {
+                plan[i].weight = 0;
+            } else if (plan[i].weight < 0) {
+                plan[i].weight = default_weight;
+            }
+            order[order_size++] = i;
+        }
+    }
+    for (size_t i = 1; i < order_size; i++) {
+        const size_t current = order[i];
+        size_t j = i;
+        for (; j > 0 && plan[order[j - 1]].weight < plan[current].weight; j--) {
+            order[j] = order[j - 1];
+        }
+        order[j] = current;
+    }
+
+    /* Shards beyond the number of selected features never get one, so they need no load */
+    const size_t loads_size = shard_count < order_size ? shard_count : order_size;
+    double *loads = calloc(loads_size > 0 ? loads_size : 1, sizeof(*loads));
+    if (!loads) {
+        traits_unit_panic("%s\n", "Out of memory.");
+    }
+    for (size_t i = 0; i < order_size; i++) {
+        size_t lightest = 0;
+        for (size_t shard = 1; shard < loads_size; shard++) {
+            if (loads[shard] < loads[lightest]) {
+                lightest = shard;
+            }
+        }
+        loads[lightest] += plan[order[i]].weight;
+        plan[order[i]].selected = (lightest == shard_index);
+    }
+    free(loads);
+    free(order);
+}
+
+int
+traits_unit_timing_compare(const void *a, const void *b) {
+    const traits_unit_timing_t *x = a, *y = b;
+    const int result = strcmp(x->trait_name, y->trait_name);
+    return 0 != result ? result : strcmp(x->feature_name, y->feature_name);
+}
+
+traits_unit_timing_t *
+traits_unit_timings_find(traits_unit_timings_t *timings, size_t size, const char *trait_name, const char *feature_name) {
+    assert(timings);
+    const traits_unit_timing_t key = {.trait_name=(char *) trait_name, .feature_name=(char *) feature_name};
+    return size > 0 ? bsearch(&key, timings->entries, size, sizeof(key), traits_unit_timing_compare) : NULL;
+}
+
+void
+traits_unit_timings_push(traits_unit_timings_t *timings, const char *trait_name, const char *feature_name,
+                         double seconds) {
+    assert(timings);
+    if (timings->size >= timings->capacity) {
+        timings->capacity = timings->capacity > 0 ? timings->capacity * 2 : 64;
+        timings->entries = realloc(timings->entries, timings->capacity * sizeof(*timings->entries));
+        if (!timings->entries) {
+            traits_unit_panic("%s\n", "Out of memory.");
+        }
+    }
+    traits_unit_timing_t *timing = &timings->entries[timings->size++];
+    timing->trait_name = strdup(trait_name);
+    timing->feature_name = strdup(feature_name);
+    timing->seconds = seconds;
+    if (!timing->trait_name || !timing->feature_name) {
+        traits_unit_panic("%s\n", "Out of memory.");
+    }
+}
+
+void
+traits_unit_timings_load(traits_unit_timings_t *timings, const char *path) {
+    assert(timings);
+    assert(path);
+    /* The file format is one `<seconds>\t<trait>\t<feature>` record per line, a missing file means no records */
+    FILE *stream = fopen(path, "r");
+    if (!stream) {
+        return;
+    }
+    char *line = NULL;
+    size_t line_capacity = 0;
+    ssize_t line_size;
+    while ((line_size = getline(&line, &line_capacity, stream)) > 0) {
+        if ('\n' == line[line_size - 1]) {
+            line[line_size - 1] = 0;
+        }
+        char *trait_name = strchr(line, '\t');
+        char *feature_name = trait_name ? strchr(trait_name + 1, '\t') : NULL;
+        if (feature_name) {
+            *trait_name++ = 0;
+            *feature_name++ = 0;
+            traits_unit_timings_push(timings, trait_name, feature_name, strtod(line, NULL));
+        }
+    }
+    free(line);
+    fclose(stream);
+    if (timings->size > 0) {
+        qsort(timings->entries, timings->size, sizeof(*timings->entries), traits_unit_timing_compare);
+    }
+}
+
+void
+traits_unit_timings_apply(traits_unit_timings_t *timings, traits_unit_plan_entry_t *plan, size_t plan_size) {
+    assert(timings);
+    for (size_t i = 0; i < plan_size; i++) {
+        const traits_unit_timing_t *timing = traits_unit_timings_find(
+                timings, timings->size, plan[i].trait->trait_name, plan[i].feature->feature_name
+        );
+        if (timing) {
+            plan[i].weight = timing->seconds;
+        }
+    }
+}
+
+void
+traits_unit_timings_store(traits_unit_timings_t *timings, traits_unit_plan_entry_t *plan, size_t plan_size,
+                          const char *path) {
+    assert(timings);
+    assert(path);
+    /* Records of features that did not run in this process are preserved */
+    const size_t sorted_size = timings->size;
+    for (size_t i = 0; i < plan_size; i++) {
+        if (plan[i].executed) {
+            traits_unit_timing_t *timing = traits_unit_timings_find(
+                    timings, sorted_size, plan[i].trait->trait_name, plan[i].feature->feature_name
+            );
+            if (timing) {
+                timing->seconds = plan[i].elapsed;
+            } else {
+                traits_unit_timings_push(timings, plan[i].trait->trait_name, plan[i].feature->feature_name,
+                                         plan[i].elapsed);
+            }
+        }
+    }
+    FILE *stream = fopen(path, "w");
+    if (!stream) {
+        traits_unit_panic("Unable to write timings to: %s\n", path);
+    }
+    for (size_t i = 0; i < timings->size; i++) {
+        const traits_unit_timing_t *timing = &timings->entries[i];
+        fprintf(stream, "%.9f\t%s\t%s\n", timing->seconds, timing->trait_name, timing->feature_name);
+    }
+    fclose(stream);
+}
+
+void
+traits_unit_timings_delete(traits_unit_timings_t *timings) {
+    assert(timings);
+    for (size_t i = 0; i < timings->size; i++) {
+        free(timings->entries[i].trait_name);
+        free(timings->entries[i].feature_name);
+    }
+    free(timings->entries);
+    memset(timings, 0, sizeof(*timings));
+}
+
 traits_unit_trait_result_t
-traits_unit_run_trait(size_t indentation_level, traits_unit_trait_t *trait, traits_unit_buffer_t *buffer) {
+traits_unit_run_trait(size_t indentation_level, traits_unit_plan_entry_t *entries, size_t entries_size,
+                      traits_unit_buffer_t *buffer) {
     traits_unit_trait_result_t trait_result;
     memset(&trait_result, 0, sizeof(trait_result));
-    traits_unit_feature_t *feature = NULL;
-    traits_unit_print(indentation_level, "Trait: %s\n", trait->trait_name);
-    indentation_level += TRAITS_UNIT_INDENTATION_STEP;
-    for (size_t i = 0; (feature = &trait->features[i]) && feature->feature && feature->feature_name; i++) {
-        traits_unit_feature_result_t feature_result = traits_unit_run_feature(indentation_level, feature, buffer);
+    bool announced = false;
+    for (size_t i = 0; i < entries_size; i++) {
+        traits_unit_plan_entry_t *entry = &entries[i];
+        if (!entry->selected) {
+            continue;
+        }
+        if (!announced) {
+            /* Traits without selected features are not reported */
+            traits_unit_print(indentation_level, "Trait: %s\n", entry->trait->trait_name);
+            indentation_level += TRAITS_UNIT_INDENTATION_STEP;
+            announced = true;
+        }
+        if (TRAITS_UNIT_ACTION_RUN == entry->feature->action) {
+            global_pending_features--;
+            global_pending_isolated -= entry->feature->isolated ? 1 : 0;
+        }
+        struct timespec started, finished;
+        clock_gettime(CLOCK_MONOTONIC, &started);
+        traits_unit_feature_result_t feature_result = traits_unit_run_feature(
+                indentation_level, entry->trait, entry->feature, buffer
+        );
+        clock_gettime(CLOCK_MONOTONIC, &finished);
+        if (TRAITS_UNIT_ACTION_RUN == entry->feature->action) {
+            entry->elapsed = (finished.tv_sec - started.tv_sec) + (finished.tv_nsec - started.tv_nsec) / 1e9;
+            entry->executed = true;
+        }
         switch (feature_result) {
             case TRAITS_UNIT_FEATURE_RESULT_SUCCEED: {
                 trait_result.succeed++;
@@ -460,16 +1035,17 @@ traits_unit_run_trait(size_t indentation_level, traits_unit_trait_t *trait, trai
     return trait_result;
 }
 
-int
-traits_unit_fork_and_run_feature(traits_unit_feature_t *feature, traits_unit_buffer_t *buffer) {
+void
+traits_unit_worker_spawn(traits_unit_worker_t *worker) {
+    assert(worker);
     pid_t pid;
-    int fd, pipe_fd[2], pid_status;
+    int command_fd[2], output_fd[2];
 
     /* Flush TRAITS_UNIT_OUTPUT_STREAM */
     fflush(TRAITS_UNIT_OUTPUT_STREAM);
 
-    /* Open a pipe */
-    if (pipe(pipe_fd) < 0) {
+    /* Open a pipe to send the feature and one to receive its output */
+    if (pipe(command_fd) < 0 || pipe(output_fd) < 0) {
         traits_unit_panic("%s\n", "Unable to open pipe.");
     }
 
@@ -480,61 +1056,212 @@ traits_unit_fork_and_run_feature(traits_unit_feature_t *feature, traits_unit_buf
 
     /* We are in the child process */
     if (0 == pid) {
-        /* Close read end of pipe */
-        close(pipe_fd[0]);
-
-        /* Get write end of pipe */
-        fd = pipe_fd[1];
+        /* Close the pipe ends not owned by this worker, idle siblings must see EOF when the pool is drained */
+        close(command_fd[1]);
+        close(output_fd[0]);
+        for (size_t i = 0; i < global_pool_size; i++) {
+            close(global_pool[i].command_fd);
+            close(global_pool[i].output_fd);
+        }
 
         /* Redirect STDERR to pipe*/
-        dup2(fd, STDERR_FILENO);
+        dup2(output_fd[1], STDERR_FILENO);
+        close(output_fd[1]);
 
-        /* Setup globals */
-        global_feature = feature;
-        global_context = feature->fixture->setup();
-        global_context_initialized = true;
+        /* Wait for a feature to run */
+        traits_unit_worker_run(command_fd[0]);
+    }
+
+    /* We are in the parent process */
+    close(command_fd[0]);
+    close(output_fd[1]);
+    worker->pid = pid;
+    worker->command_fd = command_fd[1];
+    worker->output_fd = output_fd[0];
+}
 
-        /* Teardown globals on exit */
-        traits_unit_register_teardown_on_exit();
+void
+traits_unit_worker_run(int command_fd) {
+    traits_unit_feature_t *feature = NULL;
 
-        /* Run feature */
-        feature->feature();
+    /* Workers are forked from this same image, so the feature can be sent by address */
+    if (sizeof(feature) != read(command_fd, &feature, sizeof(feature))) {
+        /* The pool has been drained */
+        _exit(EXIT_SUCCESS);
+    }
+    close(command_fd);
+
+    /* Setup globals, workers are forked from a runner that may have run features in-process already */
+    global_wrapped_signals_counter = 0;
+    global_feature = feature;
+    global_context = feature->fixture->setup();
+    global_context_initialized = true;
+
+    /* Teardown globals on exit */
+    traits_unit_register_teardown_on_exit();
+
+    /* Run feature */
+    feature->feature();
 
-        /* Close fd */
-        close(fd);
+    /* Exit normally */
+    exit(EXIT_SUCCESS);
+}
 
-        /* Exit normally */
-        exit(EXIT_SUCCESS);
+void
+traits_unit_pool_acquire(traits_unit_worker_t *worker) {
+    assert(worker);
+    if (global_pool_size > 0) {
+        /* Workers are handed out in the order they were forked */
+        *worker = global_pool[0];
+        memmove(&global_pool[0], &global_pool[1], --global_pool_size * sizeof(global_pool[0]));
+    } else {
+        traits_unit_worker_spawn(worker);
     }
+}
 
-    /* We are in the parent process */
+void
+traits_unit_pool_fill(void) {
+    /* Fork only the workers that will get a feature, in-process just the isolated ones need to be forked */
+    const size_t pending = global_in_process ? global_pending_isolated : global_pending_features;
+    while (global_pool_size < TRAITS_UNIT_PREFORK_POOL_SIZE && global_pool_size < pending) {
+        traits_unit_worker_t worker;
+        traits_unit_worker_spawn(&worker);
+        global_pool[global_pool_size++] = worker;
+    }
+}
 
-    /* Wait for children */
-    wait(&pid_status);
+void
+traits_unit_pool_drain(void) {
+    /* Closing the command pipe makes idle workers exit without running anything */
+    for (size_t i = 0; i < global_pool_size; i++) {
+        close(global_pool[i].command_fd);
+        close(global_pool[i].output_fd);
+    }
+    for (size_t i = 0; i < global_pool_size; i++) {
+        waitpid(global_pool[i].pid, NULL, 0);
+    }
+    global_pool_size = 0;
+}
 
-    /* Close write end of pipe */
-    close(pipe_fd[1]);
+int
+traits_unit_fork_and_run_feature(traits_unit_feature_t *feature, traits_unit_buffer_t *buffer) {
+    traits_unit_worker_t worker;
+    int pid_status;
 
-    /* Get read end of pipe */
-    fd = pipe_fd[0];
+    /* Hand the feature to a pre-forked worker, what has been reported so far must come before its output */
+    fflush(TRAITS_UNIT_OUTPUT_STREAM);
+    traits_unit_pool_acquire(&worker);
+    if (sizeof(feature) != write(worker.command_fd, &feature, sizeof(feature))) {
+        traits_unit_panic("%s\n", "Unable to send feature to worker.");
+    }
+    close(worker.command_fd);
 
-    /* Redirect the children output to the global buffer */
-    traits_unit_buffer_read(buffer, fd);
+    /* Fork the next workers while this feature is running */
+    traits_unit_pool_fill();
 
-    /* Close fd */
-    close(fd);
+    /* Stream the children output to the global buffer until it exits, this also closes the read end of the pipe */
+    traits_unit_buffer_read(buffer, worker.output_fd);
+
+    /* Wait for the worker */
+    if (waitpid(worker.pid, &pid_status, 0) < 0) {
+        traits_unit_panic("%s\n", "Unable to wait for worker.");
+    }
 
     /* Flush TRAITS_UNIT_OUTPUT_STREAM */
     fflush(TRAITS_UNIT_OUTPUT_STREAM);
     return pid_status;
 }
 
+bool
+traits_unit_run_feature_in_process(traits_unit_feature_t *feature) {
+    const size_t signals_size = sizeof(global_sandbox_signals) / sizeof(global_sandbox_signals[0]);
+    volatile bool succeed = false;
+    int stderr_fd, null_fd;
+
+    /* Silence STDERR, failing features are run again in a forked process in order to report their output */
+    fflush(TRAITS_UNIT_OUTPUT_STREAM);
+    fflush(stderr);
+    if ((stderr_fd = dup(STDERR_FILENO)) < 0 || (null_fd = open("/dev/null", O_WRONLY)) < 0) {
+        traits_unit_panic("%s\n", "Unable to redirect stderr.");
+    }
+    dup2(null_fd, STDERR_FILENO);
+    close(null_fd);
+
+    /* Trap crashes and failed assertions */
+    for (size_t i = 0; i < signals_size; i++) {
+        global_sandbox_previous_handlers[i] = signal(global_sandbox_signals[i], traits_unit_sandbox_signal_handler);
+    }
+
+    if (0 == sigsetjmp(global_sandbox_jump_buffer, true)) {
+        global_sandbox_active = 1;
+        global_wrapped_signals_counter = 0;
+        global_feature = feature;
+        global_context = feature->fixture->setup();
+        global_context_initialized = true;
+        feature->feature();
+        traits_unit_teardown();
+        succeed = true;
+    }
+    global_sandbox_active = 0;
+
+    if (!succeed) {
+        /* The feature did not complete, reset the state it left behind */
+        if (0 != global_signal_id) {
+            __traits_unit_wraps_exit();
+        }
+        global_context_initialized = false;
+        global_context = NULL;
+        global_feature = NULL;
+    }
+
+    for (size_t i = 0; i < signals_size; i++) {
+        signal(global_sandbox_signals[i], global_sandbox_previous_handlers[i]);
+    }
+
+    /* Restore STDERR */
+    fflush(stderr);
+    dup2(stderr_fd, STDERR_FILENO);
+    close(stderr_fd);
+    fflush(TRAITS_UNIT_OUTPUT_STREAM);
+    return succeed;
+}
+
+void
+traits_unit_sandbox_signal_handler(int signal_id) {
+    if (!global_sandbox_active) {
+        signal(signal_id, SIG_DFL);
+        raise(signal_id);
+        return;
+    }
+    global_sandbox_active = 0;
+    siglongjmp(global_sandbox_jump_buffer, 1);
+}
+
+void
+__traits_assertion_failed(void) {
+    /* Called by traits before exiting, unwind back to the sandbox if the feature is running in-process */
+    if (global_sandbox_active) {
+        global_sandbox_active = 0;
+        siglongjmp(global_sandbox_jump_buffer, 1);
+    }
+}
+
 traits_unit_feature_result_t
-traits_unit_run_feature(size_t indentation_level, traits_unit_feature_t *feature, traits_unit_buffer_t *buffer) {
+traits_unit_run_feature(size_t indentation_level, traits_unit_trait_t *trait, traits_unit_feature_t *feature,
+                        traits_unit_buffer_t *buffer) {
     traits_unit_feature_result_t result;
     traits_unit_print(indentation_level, "Feature: %s... ", feature->feature_name);
     switch (feature->action) {
         case TRAITS_UNIT_ACTION_RUN: {
+            if (global_in_process && !feature->isolated) {
+                if (traits_unit_run_feature_in_process(feature)) {
+                    result = TRAITS_UNIT_FEATURE_RESULT_SUCCEED;
+                    traits_unit_print(0, "succeed\n");
+                    break;
+                }
+                /* The process state can't be trusted anymore, run the remaining features in forked processes */
+                global_in_process = false;
+            }
             traits_unit_buffer_clear(buffer);
             const int exit_status = traits_unit_fork_and_run_feature(feature, buffer);
             if (EXIT_SUCCESS == exit_status) {
@@ -553,6 +1280,10 @@ traits_unit_run_feature(size_t indentation_level, traits_unit_feature_t *feature
                     }
                 }
                 traits_unit_print(0, "failed\n\n%s\n", traits_unit_buffer_get(buffer));
+                const char *kept_path = traits_unit_buffer_keep(buffer, trait->trait_name, feature->feature_name);
+                if (kept_path) {
+                    traits_unit_print(indentation_level, "Full output: %s\n\n", kept_path);
+                }
             }
             break;
         }
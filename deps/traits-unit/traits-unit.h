@@ -46,18 +46,12 @@ extern "C" {
 /*
 * Versioning
 */
-#define TRAITS_UNIT_VERSION_MAJOR       3
+#define TRAITS_UNIT_VERSION_MAJOR       4
 #define TRAITS_UNIT_VERSION_MINOR       0
 #define TRAITS_UNIT_VERSION_PATCH       0
 #define TRAITS_UNIT_VERSION_SUFFIX      ""
 #define TRAITS_UNIT_VERSION_IS_RELEASE  1
-#define TRAITS_UNIT_VERSION_HEX         0x030000
-
-/*
- * Constants
- */
-#define TRAITS_UNIT_MAX_TRAITS          96
-#define TRAITS_UNIT_MAX_FEATURES        64
+#define TRAITS_UNIT_VERSION_HEX         0x040000
 
 /*
  * Types
@@ -83,16 +77,19 @@ typedef struct traits_unit_feature_t {
     traits_unit_fixture_t *fixture;
     traits_unit_feature_fn *feature;
     traits_unit_action_t action;
+    bool isolated;
 } traits_unit_feature_t;
 
 typedef struct traits_unit_trait_t {
     const char *trait_name;
-    traits_unit_feature_t features[TRAITS_UNIT_MAX_FEATURES];
+    traits_unit_feature_t *features;
+    size_t features_size;
 } traits_unit_trait_t;
 
 typedef struct traits_unit_subject_t {
     const char *subject;
-    traits_unit_trait_t traits[TRAITS_UNIT_MAX_TRAITS];
+    traits_unit_trait_t *traits;
+    size_t traits_size;
 } traits_unit_subject_t;
 
 /*
@@ -131,15 +128,24 @@ main(int argc, char *argv[]);
 #define FixtureImplements(Name, Setup, Teardown)    \
     traits_unit_fixture_t __TRAITS_UNIT_FIXTURE_ID(Name) = {.setup=__TRAITS_UNIT_SETUP_ID(Setup), .teardown=__TRAITS_UNIT_TEARDOWN_ID(Teardown)}
 
+/*
+ * Traits and features are laid out in exactly-sized static arrays, there's no limit on how many can be declared.
+ */
 #define Describe(Subject, ...)                  \
-    traits_unit_subject_t traits_unit_subject = {.subject=(Subject), .traits={__VA_ARGS__}};
+    traits_unit_subject_t traits_unit_subject = {.subject=(Subject), __TRAITS_UNIT_ARRAY(traits, traits_unit_trait_t, __VA_ARGS__)};
 
 #define Trait(Name, ...)                        \
-    {.trait_name=(Name), .features={__VA_ARGS__}}
+    {.trait_name=(Name), __TRAITS_UNIT_ARRAY(features, traits_unit_feature_t, __VA_ARGS__)}
 
 #define Run(...)                                \
     __TRAITS_UNIT_FEATURE_RUN(__VA_ARGS__, __TraitsUnitDefaultFixture, __TraitsUnitDefaultFixture)
 
+/*
+ * Like Run but the feature is always executed in a forked process, even when running with `--in-process`.
+ */
+#define Isolated(...)                           \
+    __TRAITS_UNIT_FEATURE_ISOLATED(__VA_ARGS__, __TraitsUnitDefaultFixture, __TraitsUnitDefaultFixture)
+
 #define Skip(...)                               \
     __TRAITS_UNIT_FEATURE_SKIP(__VA_ARGS__, __TraitsUnitDefaultFixture, __TraitsUnitDefaultFixture)
 
@@ -166,6 +172,9 @@ main(int argc, char *argv[]);
 #define __TRAITS_UNIT_TO_STRING_IMPL_(x)     #x
 #define __TRAITS_UNIT_TO_STRING(x)          __TRAITS_UNIT_TO_STRING_IMPL_(x)
 
+#define __TRAITS_UNIT_ARRAY(Member, Type, ...)                      \
+    .Member=(Type[]){__VA_ARGS__}, .Member ## _size=sizeof((Type[]){__VA_ARGS__}) / sizeof(Type)
+
 #define __TRAITS_UNIT_SETUP_ID(Name)        __TRAITS_UNIT_CAT(traits_unit_user_setup_, Name)
 #define __TRAITS_UNIT_TEARDOWN_ID(Name)     __TRAITS_UNIT_CAT(traits_unit_user_teardown_, Name)
 #define __TRAITS_UNIT_FIXTURE_ID(Name)      __TRAITS_UNIT_CAT(traits_unit_user_fixture_, Name)
@@ -174,6 +183,9 @@ main(int argc, char *argv[]);
 #define __TRAITS_UNIT_FEATURE_RUN(Name, Fixture, ...)               \
     {.feature_name=__TRAITS_UNIT_TO_STRING(Name), .feature=__TRAITS_UNIT_FEATURE_ID(Name), .fixture=&__TRAITS_UNIT_FIXTURE_ID(Fixture), .action=TRAITS_UNIT_ACTION_RUN}
 
+#define __TRAITS_UNIT_FEATURE_ISOLATED(Name, Fixture, ...)          \
+    {.feature_name=__TRAITS_UNIT_TO_STRING(Name), .feature=__TRAITS_UNIT_FEATURE_ID(Name), .fixture=&__TRAITS_UNIT_FIXTURE_ID(Fixture), .action=TRAITS_UNIT_ACTION_RUN, .isolated=true}
+
 #define __TRAITS_UNIT_FEATURE_SKIP(Name, Fixture, ...)              \
     {.feature_name=__TRAITS_UNIT_TO_STRING(Name), .feature=__TRAITS_UNIT_FEATURE_ID(Name), .fixture=&__TRAITS_UNIT_FIXTURE_ID(Fixture), .action=TRAITS_UNIT_ACTION_SKIP}
 
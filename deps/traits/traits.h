@@ -38,11 +38,11 @@
 #define TRAITS_INCLUDED
 
 #define TRAITS_VERSION_MAJOR                        3
-#define TRAITS_VERSION_MINOR                        2
+#define TRAITS_VERSION_MINOR                        3
 #define TRAITS_VERSION_PATCH                        0
 #define TRAITS_VERSION_SUFFIX                       ""
 #define TRAITS_VERSION_IS_RELEASE                   1
-#define TRAITS_VERSION_HEX                          0x030200
+#define TRAITS_VERSION_HEX                          0x030300
 
 #if !(defined(__GNUC__) || defined(__clang__))
 #define __attribute__(...)
@@ -142,6 +142,13 @@ traits_version(void) {
                    TRAITS_VERSION_SUFFIX;
 }
 
+/*
+ * Optional hook called when an assertion fails before terminating, test runners may define it in order to recover.
+ */
+extern void
+__traits_assertion_failed(void)
+__attribute__((__weak__));
+
 static void
 __traits_assert(bool condition, size_t line, const char *file, const char *assertion, const char *message, ...)
 __attribute__((__format__(__printf__, 5, 6)));
@@ -154,6 +161,9 @@ __traits_assert(bool condition, size_t line, const char *file, const char *asser
         va_start(args, message);
         vfprintf(stderr, message, args);
         va_end(args);
+        if (__traits_assertion_failed) {
+            __traits_assertion_failed();
+        }
         exit(1);
     }
 }
@@ -28,6 +28,7 @@ OTHER DEALINGS IN THE SOFTWARE.
 #include <math.h>
 #include <stdio.h>
 #include <result.h>
+#include <result-thunk.h>
 #include <assert.h>
 
 typedef const double *Number;
@@ -35,15 +36,18 @@ typedef const double *Number;
 static Number Number_new(double number);
 
 static Number zero(void);
+static Result okZero(void *context);
 static Number cube(Number number);
 static ResultOf(Number, DomainError) division(Number dividend, Number divisor);
 static ResultOf(Number, DomainError) squareRoot(Number number);
 
 int main() {
+    // the fallback is computed only if one of the steps fails
+    ResultThunk fallback = ResultThunk_new(okZero, NULL);
     Number number = Result_unwrap(
-            Result_alt(
+            Result_altThunk(
                     Result_map(Result_chain(division(Number_new(36), Number_new(4)), squareRoot), cube),
-                    Result_ok(zero())
+                    &fallback
             )
     );
     printf("Number is: %f\n", *number);
@@ -67,6 +71,11 @@ Number zero(void) {
     return &instance;
 }
 
+Result okZero(void *context) {
+    (void) context;
+    return Result_ok(zero());
+}
+
 Number cube(Number number) {
     return Number_new(pow(*number, 3));
 }
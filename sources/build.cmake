@@ -6,3 +6,6 @@ file(GLOB ARCHIVE_SOURCES ${CMAKE_CURRENT_LIST_DIR}/*.c)
 add_library(${ARCHIVE_NAME} ${ARCHIVE_HEADERS} ${ARCHIVE_SOURCES})
 target_link_libraries(${ARCHIVE_NAME} PRIVATE panic)
 target_link_libraries(${ARCHIVE_NAME} PUBLIC error)
+
+find_package(Threads REQUIRED)
+target_link_libraries(${ARCHIVE_NAME} PUBLIC Threads::Threads)
@@ -0,0 +1,315 @@
+/*
+ * Author: daddinuz
+ * email:  daddinuz@gmail.com
+ *
+ * Copyright (c) 2018 Davide Di Carlo
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <errno.h>
+#include <limits.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <unistd.h>
+#include <sys/uio.h>
+#include <panic/panic.h>
+#include "result-archive.h"
+
+#define RESULT_ARCHIVE_MAGIC        "RESULTS"
+#define RESULT_ARCHIVE_UNKNOWN      UINT32_MAX
+
+#ifndef IOV_MAX
+#define IOV_MAX                     1024
+#endif
+
+#define Result_archiveAlign(size) \
+    (((size) + (RESULT_ARCHIVE_ALIGNMENT - 1)) & ~((uint64_t) RESULT_ARCHIVE_ALIGNMENT - 1))
+
+/*
+ * The layout is: header, messages of the registry errors (NUL-terminated), records, payload.
+ * Each section starts at a multiple of RESULT_ARCHIVE_ALIGNMENT.
+ */
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t errors;
+    uint64_t size;
+    uint64_t messagesSize;
+    uint64_t payloadSize;
+} Result_ArchiveHeader;
+
+typedef struct {
+    uint32_t error;
+    uint32_t reserved;
+    // the payload offset of an Ok value or the raw value of an error
+    uint64_t value;
+} Result_ArchiveRecord;
+
+static const unsigned char Result_archivePadding[RESULT_ARCHIVE_ALIGNMENT] = {0};
+
+static uint32_t Result_archiveId(Error error, const uint32_t *ids, size_t idsSize)
+__attribute__((__warn_unused_result__, __nonnull__(1)));
+
+static Result Result_archiveWriteAt(int fd, struct iovec *iov, size_t size, off_t position)
+__attribute__((__warn_unused_result__, __nonnull__));
+
+static void Result_archivePush(struct iovec **iov, size_t *size, size_t *capacity, const void *data, size_t length)
+__attribute__((__nonnull__(1, 2, 3)));
+
+Result ResultArchive_write(const int fd, const Result *const results, const size_t size,
+                           size_t (*const measure)(const void *), const Error *const errors, const size_t errorsSize) {
+    Panic_when(NULL == results);
+    Panic_when(NULL == measure);
+    Panic_when(NULL == errors && errorsSize > 0);
+    Panic_when(errorsSize >= RESULT_ARCHIVE_UNKNOWN);
+    // error index -> archive id, registry errors follow the built-in ones
+    uint64_t messagesSize = 0;
+    size_t idsSize = ERROR_BUILTINS;
+    for (size_t i = 0; i < errorsSize; i++) {
+        Panic_when(NULL == errors[i]);
+        const size_t index = Error_index(errors[i]);
+        idsSize = (index < idsSize) ? idsSize : index + 1;
+        messagesSize += strlen(Error_explain(errors[i])) + 1;
+    }
+    uint32_t *ids = malloc(idsSize * sizeof(ids[0]));
+    Panic_when(NULL == ids);
+    for (size_t i = 0; i < idsSize; i++) {
+        ids[i] = (i < ERROR_BUILTINS) ? (uint32_t) i : RESULT_ARCHIVE_UNKNOWN;
+    }
+    for (size_t i = 0; i < errorsSize; i++) {
+        const size_t index = Error_index(errors[i]);
+        if (index >= ERROR_BUILTINS) {
+            ids[index] = (uint32_t) (ERROR_BUILTINS + i);
+        }
+    }
+    for (size_t i = 0; i < size; i++) {
+        if (RESULT_ARCHIVE_UNKNOWN == Result_archiveId(results[i].__error, ids, idsSize)) {
+            free(ids);
+            return Result_error(LookupError);
+        }
+    }
+
+    // header, messages and records are laid out in a single buffer, values are gathered from where they are
+    const uint64_t recordsStart = sizeof(Result_ArchiveHeader) + Result_archiveAlign(messagesSize);
+    unsigned char *head = calloc(1, recordsStart + size * sizeof(Result_ArchiveRecord));
+    size_t iovSize = 0, iovCapacity = 16;
+    struct iovec *iov = malloc(iovCapacity * sizeof(iov[0]));
+    Panic_when(NULL == head || NULL == iov);
+    Result_archivePush(&iov, &iovSize, &iovCapacity, head + sizeof(Result_ArchiveHeader),
+                       recordsStart - sizeof(Result_ArchiveHeader) + size * sizeof(Result_ArchiveRecord));
+
+    char *messages = (char *) head + sizeof(Result_ArchiveHeader);
+    for (size_t i = 0; i < errorsSize; i++) {
+        const size_t length = strlen(Error_explain(errors[i])) + 1;
+        memcpy(messages, Error_explain(errors[i]), length);
+        messages += length;
+    }
+
+    Result_ArchiveRecord *records = (Result_ArchiveRecord *) (head + recordsStart);
+    uint64_t payloadSize = 0;
+    for (size_t i = 0; i < size; i++) {
+        const Result result = results[i];
+        records[i].error = Result_archiveId(result.__error, ids, idsSize);
+        if (Ok != result.__error) {
+            records[i].value = (uint64_t) (uintptr_t) result.__value;
+        } else {
+            const size_t length = measure(result.__value);
+            records[i].value = payloadSize;
+            Result_archivePush(&iov, &iovSize, &iovCapacity, result.__value, length);
+            if (Result_archiveAlign(length) != length) {
+                Result_archivePush(&iov, &iovSize, &iovCapacity, Result_archivePadding,
+                                   (size_t) (Result_archiveAlign(length) - length));
+            }
+            payloadSize += Result_archiveAlign(length);
+        }
+    }
+
+    Result_ArchiveHeader *header = (Result_ArchiveHeader *) head;
+    memcpy(header->magic, RESULT_ARCHIVE_MAGIC, sizeof(RESULT_ARCHIVE_MAGIC));
+    header->version = RESULT_ARCHIVE_VERSION;
+    header->errors = (uint32_t) errorsSize;
+    header->size = size;
+    header->messagesSize = messagesSize;
+    header->payloadSize = payloadSize;
+
+    // the header goes last over an emptied file, an archive that failed halfway has no valid header
+    Result written = (0 == ftruncate(fd, 0)) ? Result_ok(iov) : ResultIO_error(errno);
+    if (Result_isOk(written)) {
+        written = Result_archiveWriteAt(fd, iov, iovSize, sizeof(Result_ArchiveHeader));
+    }
+    if (Result_isOk(written)) {
+        struct iovec headerIov = {.iov_base=header, .iov_len=sizeof(*header)};
+        written = Result_archiveWriteAt(fd, &headerIov, 1, 0);
+    }
+    free(iov);
+    free(head);
+    free(ids);
+    return Result_isOk(written) ? Result_ok(results) : written;
+}
+
+Result ResultArchive_load(const char *const path, const Error *const errors, const size_t errorsSize,
+                          ResultArchive *const archive) {
+    Panic_when(NULL == path);
+    Panic_when(NULL == errors && errorsSize > 0);
+    Panic_when(NULL == archive);
+    Result_try(mapping, ResultIO_mapFile(path, ResultIO_Sequential, &archive->__mapping));
+    (void) mapping;
+
+    const unsigned char *const data = ResultIO_mappingData(&archive->__mapping);
+    const size_t dataSize = ResultIO_mappingSize(&archive->__mapping);
+    const Result_ArchiveHeader *const header = (const Result_ArchiveHeader *) data;
+    if (dataSize < sizeof(*header) || 0 != memcmp(header->magic, RESULT_ARCHIVE_MAGIC, sizeof(header->magic)) ||
+        RESULT_ARCHIVE_VERSION != header->version || header->messagesSize > dataSize ||
+        header->size > dataSize / sizeof(Result_ArchiveRecord) || header->payloadSize > dataSize ||
+        sizeof(*header) + Result_archiveAlign(header->messagesSize) + header->size * sizeof(Result_ArchiveRecord) +
+        header->payloadSize != dataSize) {
+        ResultIO_unmap(&archive->__mapping);
+        return Result_error(DomainError);
+    }
+
+    // the registry must list the same errors in the same order it was written with
+    Error failure = (header->errors > errorsSize) ? LookupError : Ok;
+    const char *message = (const char *) data + sizeof(*header), *const messagesEnd = message + header->messagesSize;
+    for (size_t i = 0; Ok == failure && i < header->errors; i++) {
+        const size_t length = strnlen(message, (size_t) (messagesEnd - message));
+        if (length == (size_t) (messagesEnd - message)) {
+            failure = DomainError;
+        } else if (NULL == errors[i] || 0 != strcmp(message, Error_explain(errors[i]))) {
+            failure = LookupError;
+        }
+        message += length + 1;
+    }
+    if (Ok != failure) {
+        ResultIO_unmap(&archive->__mapping);
+        return Result_error(failure);
+    }
+
+    Error *const table = malloc((ERROR_BUILTINS + (size_t) header->errors) * sizeof(table[0]));
+    Panic_when(NULL == table);
+    for (size_t i = 0; i < ERROR_BUILTINS; i++) {
+        table[i] = Error_builtinAt(i);
+    }
+    const size_t tableSize = ERROR_BUILTINS + header->errors;
+    memcpy(table + ERROR_BUILTINS, errors, header->errors * sizeof(errors[0]));
+
+    const Result_ArchiveRecord *const records = (const Result_ArchiveRecord *) (
+            data + sizeof(*header) + Result_archiveAlign(header->messagesSize));
+    const unsigned char *const payload = (const unsigned char *) (records + header->size);
+    archive->__size = (size_t) header->size;
+    archive->__results = malloc((archive->__size > 0 ? archive->__size : 1) * sizeof(archive->__results[0]));
+    Panic_when(NULL == archive->__results);
+    for (size_t i = 0; i < archive->__size; i++) {
+        const Result_ArchiveRecord record = records[i];
+        if (record.error >= tableSize ||
+            (0 == record.error && record.value > header->payloadSize)) {
+            free(table);
+            ResultArchive_unload(archive);
+            return Result_error(DomainError);
+        }
+        archive->__results[i] = (Result) {
+                .__error=table[record.error],
+                .__value=(0 != record.error) ? (const void *) (uintptr_t) record.value : payload + record.value
+        };
+    }
+    free(table);
+    return Result_ok(archive);
+}
+
+const Result *ResultArchive_results(const ResultArchive *const self) {
+    assert(NULL != self);
+    return self->__results;
+}
+
+size_t ResultArchive_size(const ResultArchive *const self) {
+    assert(NULL != self);
+    return self->__size;
+}
+
+void ResultArchive_unload(ResultArchive *const self) {
+    assert(NULL != self);
+    ResultIO_unmap(&self->__mapping);
+    free(self->__results);
+    self->__results = NULL;
+    self->__size = 0;
+}
+
+uint32_t Result_archiveId(Error error, const uint32_t *const ids, const size_t idsSize) {
+    assert(NULL != error);
+    const size_t index = Error_index(error);
+    return (index < idsSize) ? ids[index] : RESULT_ARCHIVE_UNKNOWN;
+}
+
+Result Result_archiveWriteAt(const int fd, struct iovec *iov, size_t size, off_t position) {
+    assert(NULL != iov);
+    // the vector is consumed in place, up to IOV_MAX buffers go out in each call
+    while (size > 0) {
+        const ssize_t written = pwritev(fd, iov, (int) ((size < IOV_MAX) ? size : IOV_MAX), position);
+        if (written < 0) {
+            if (EINTR == errno) {
+                continue;
+            }
+            return ResultIO_error(errno);
+        }
+        if (0 == written) {
+            // no progress, trying again would spin forever
+            return ResultIO_error(EIO);
+        }
+        position += written;
+        for (size_t remaining = (size_t) written; remaining > 0;) {
+            if (remaining >= iov->iov_len) {
+                remaining -= iov->iov_len;
+                iov++;
+                size--;
+            } else {
+                iov->iov_base = (unsigned char *) iov->iov_base + remaining;
+                iov->iov_len -= remaining;
+                remaining = 0;
+            }
+        }
+    }
+    return Result_ok(iov);
+}
+
+void Result_archivePush(struct iovec **const iov, size_t *const size, size_t *const capacity, const void *const data,
+                        const size_t length) {
+    assert(NULL != iov);
+    assert(NULL != size);
+    assert(NULL != capacity);
+    if (0 == length) {
+        return;
+    }
+    // values laid out back to back in memory are gathered at once
+    struct iovec *last = (*size > 0) ? &(*iov)[*size - 1] : NULL;
+    if (NULL != last && (const unsigned char *) last->iov_base + last->iov_len == data) {
+        last->iov_len += length;
+        return;
+    }
+    if (*size == *capacity) {
+        *capacity *= 2;
+        *iov = realloc(*iov, *capacity * sizeof((*iov)[0]));
+        Panic_when(NULL == *iov);
+    }
+    (*iov)[(*size)++] = (struct iovec) {.iov_base=(void *) data, .iov_len=length};
+}
@@ -0,0 +1,133 @@
+/*
+Author: daddinuz
+email:  daddinuz@gmail.com
+
+Copyright (c) 2018 Davide Di Carlo
+
+Permission is hereby granted, free of charge, to any person
+obtaining a copy of this software and associated documentation
+files (the "Software"), to deal in the Software without
+restriction, including without limitation the rights to use,
+copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be
+included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include "result.h"
+#include "result-io.h"
+
+#if !(defined(__GNUC__) || defined(__clang__))
+__attribute__(...)
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * A versioned binary format for arrays of `Result`s.
+ *
+ * `Error`s are process-local pointers so each result is stored as an error id plus an offset into a payload blob
+ * holding the values:
+ *  - built-in errors are identified by their `Error_index(...)`, which is the same in every process;
+ *  - any other error must be listed in a registry passed both when writing and when loading, and is identified by its
+ *    position in there, the messages are stored as well in order to detect mismatching registries.
+ *
+ * Archives are written with gathered writes of up to `IOV_MAX` buffers each, values laid out back to back in memory
+ * taking a single buffer, and loaded through a read-only mapping: `Ok` values point straight into the mapped payload,
+ * which is aligned to `RESULT_ARCHIVE_ALIGNMENT`.
+ * Errors keep their raw value, so that e.g. the `errno` of a `ResultIO` failure survives the round trip.
+ *
+ * The format uses the native byte order, archives are not meant to be moved across architectures.
+ */
+
+#define RESULT_ARCHIVE_VERSION      1
+#define RESULT_ARCHIVE_ALIGNMENT    8
+
+/**
+ * A loaded archive.
+ *
+ * @attention this struct must be treated as opaque therefore its members must not be accessed directly.
+ */
+typedef struct {
+    ResultIO_Mapping __mapping;
+    Result *__results;
+    size_t __size;
+} ResultArchive;
+
+/**
+ * Writes the `size` results to `fd`, replacing the content of the file: archives always start at offset 0, which is
+ * where `ResultArchive_load(...)` reads them from, whatever the current position of `fd`.
+ * The value of every `Ok` result is stored copying the number of bytes returned by `measure`.
+ * Archives with many values take more than one write; the header is written last so that a file left behind by a
+ * failed write is rejected by `ResultArchive_load(...)`.
+ *
+ * Returns a `Result` wrapping `results` or:
+ *  - a `LookupError` if an error is neither built-in nor listed in `errors`, nothing is written in that case;
+ *  - a `SystemError` carrying the `errno` if writing failed, e.g. `ESPIPE` if `fd` is not a regular file.
+ *
+ * @attention results must not be `NULL`.
+ * @attention measure must not be `NULL`.
+ * @attention errors must not be `NULL` unless errorsSize is 0.
+ */
+extern Result ResultArchive_write(int fd, const Result *results, size_t size, size_t (*measure)(const void *value),
+                                  const Error *errors, size_t errorsSize)
+__attribute__((__warn_unused_result__));
+
+/**
+ * Loads the archive at `path` into `archive`, mapping non built-in errors back through the `errors` registry.
+ *
+ * Returns a `Result` wrapping `archive`, that must be released with `ResultArchive_unload(...)`, or:
+ *  - a `DomainError` if the file is not an archive or has an unsupported version;
+ *  - a `LookupError` if the archive refers to errors the registry does not match;
+ *  - a `SystemError` carrying the `errno` if the file could not be mapped.
+ *
+ * @attention path must not be `NULL`.
+ * @attention errors must not be `NULL` unless errorsSize is 0.
+ * @attention archive must not be `NULL`.
+ */
+extern Result ResultArchive_load(const char *path, const Error *errors, size_t errorsSize, ResultArchive *archive)
+__attribute__((__warn_unused_result__));
+
+/**
+ * Returns the loaded results, `Ok` values are valid until the archive is unloaded.
+ *
+ * @attention self must not be `NULL`.
+ */
+extern const Result *ResultArchive_results(const ResultArchive *self)
+__attribute__((__warn_unused_result__, __nonnull__));
+
+/**
+ * Returns the number of loaded results.
+ *
+ * @attention self must not be `NULL`.
+ */
+extern size_t ResultArchive_size(const ResultArchive *self)
+__attribute__((__warn_unused_result__, __nonnull__));
+
+/**
+ * Releases the archive.
+ *
+ * @attention self must not be `NULL`.
+ */
+extern void ResultArchive_unload(ResultArchive *self)
+__attribute__((__nonnull__));
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,174 @@
+/*
+Author: daddinuz
+email:  daddinuz@gmail.com
+
+Copyright (c) 2018 Davide Di Carlo
+
+Permission is hereby granted, free of charge, to any person
+obtaining a copy of this software and associated documentation
+files (the "Software"), to deal in the Software without
+restriction, including without limitation the rights to use,
+copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be
+included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include "result.h"
+
+#if !(defined(__GNUC__) || defined(__clang__))
+__attribute__(...)
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Stackless coroutines returning `Result`s, in the style of protothreads.
+ *
+ * A coroutine is a function returning `Result` whose body starts with `Result_async(...)`.
+ * Every call runs it up to its next suspension point:
+ *  - `Result_await(...)` suspends while the awaited expression is pending, re-evaluating it on the next call;
+ *  - `Result_yield(...)` hands out a result and resumes right after on the next call;
+ *  - `Result_return(...)` finishes it, from then on calls return `StopIteration`.
+ *
+ * The only state kept across calls is the resume point, stored in a `ResultAsync` provided by the caller: local
+ * variables are not preserved across suspension points, anything that must survive has to live in caller-provided
+ * memory as well.
+ *
+ * @attention relies on labels as values and statement expressions, GNU extensions.
+ * @attention at most one suspension point per line, and no suspension point inside a statement expression.
+ */
+
+/**
+ * The resume point of a coroutine.
+ *
+ * @attention this struct must be treated as opaque therefore its members must not be accessed directly.
+ */
+typedef struct {
+    const void *__resume;
+} ResultAsync;
+
+/**
+ * Returned by coroutines and by awaited expressions that are not ready yet.
+ */
+extern Error Pending;
+
+/**
+ * Creates the state of a coroutine that has not started yet.
+ */
+#define ResultAsync_new() \
+    ((ResultAsync) {.__resume=NULL})
+
+/**
+ * Returns a `Result` wrapping `Pending`.
+ */
+extern Result ResultAsync_pending(void)
+__attribute__((__warn_unused_result__));
+
+/**
+ * Returns `true` if the coroutine has finished, `false` otherwise.
+ *
+ * @attention self must not be `NULL`.
+ */
+extern bool ResultAsync_isFinished(const ResultAsync *self)
+__attribute__((__warn_unused_result__, __nonnull__));
+
+/**
+ * Starts the body of a coroutine resuming from `self`, must be the first statement of the function.
+ *
+ * @attention self must not be `NULL`.
+ */
+#define Result_async(self) \
+    ResultAsync *const __result_async = (self); \
+    if (__ResultAsync_finished == __result_async->__resume) return Result_error(StopIteration); \
+    if (NULL != __result_async->__resume) goto *__result_async->__resume
+
+/**
+ * Declares `var` bound to the value of the `Result` evaluated from `expr` if it's an `Ok` variant.
+ * If it wraps `Pending` the coroutine suspends returning it and `expr` is evaluated again when resumed, if it's any
+ * other error the coroutine finishes returning it.
+ */
+#define Result_await(var, expr) \
+    __RESULT_AWAIT(var, expr, __RESULT_ASYNC_LABEL(__result_async_await_, __LINE__))
+
+/**
+ * Suspends the coroutine returning `result`, it resumes right after when called again.
+ */
+#define Result_yield(result) \
+    __RESULT_YIELD(result, __RESULT_ASYNC_LABEL(__result_async_yield_, __LINE__))
+
+/**
+ * Finishes the coroutine returning `result`.
+ */
+#define Result_return(result) \
+    do { __result_async->__resume = __ResultAsync_finished; return (result); } while (0)
+
+/**
+ * @attention this variable must be treated as opaque therefore must not be used directly.
+ */
+extern const void *const __ResultAsync_finished;
+
+/**
+ * @attention this macro must be treated as opaque therefore must not be used directly.
+ */
+#define __RESULT_ASYNC_LABEL(prefix, line) \
+    __RESULT_ASYNC_CONCAT(prefix, line)
+
+/**
+ * @attention this macro must be treated as opaque therefore must not be used directly.
+ */
+#define __RESULT_ASYNC_CONCAT(prefix, line) \
+    prefix ## line
+
+/**
+ * @attention this macro must be treated as opaque therefore must not be used directly.
+ */
+#define __RESULT_AWAIT(var, expr, label) \
+    label: ; \
+    const void *const var = ({ \
+        const Result __result = (expr); \
+        if (Pending == __result.__error) { __RESULT_ASYNC_SUSPEND(label) return __result; } \
+        if (Ok != __result.__error) { __result_async->__resume = __ResultAsync_finished; return __result; } \
+        __result.__value; \
+    })
+
+/**
+ * @attention this macro must be treated as opaque therefore must not be used directly.
+ */
+#define __RESULT_YIELD(result, label) \
+    do { __RESULT_ASYNC_SUSPEND(label) return (result); label: ; } while (0)
+
+/**
+ * @attention this macro must be treated as opaque therefore must not be used directly.
+ */
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 12
+// labels are not local variables, yet storing their address trips -Wdangling-pointer
+#define __RESULT_ASYNC_SUSPEND(label) \
+    _Pragma("GCC diagnostic push") \
+    _Pragma("GCC diagnostic ignored \"-Wdangling-pointer\"") \
+    __result_async->__resume = &&label; \
+    _Pragma("GCC diagnostic pop")
+#else
+#define __RESULT_ASYNC_SUSPEND(label) \
+    __result_async->__resume = &&label;
+#endif
+
+#ifdef __cplusplus
+}
+#endif
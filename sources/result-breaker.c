@@ -0,0 +1,264 @@
+/*
+ * Author: daddinuz
+ * email:  daddinuz@gmail.com
+ *
+ * Copyright (c) 2018 Davide Di Carlo
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <panic/panic.h>
+#include "result-clock.h"
+#include "result-breaker.h"
+
+#define RESULT_BREAKER_CACHE_LINE   64
+
+/*
+ * The window slides one bucket at a time.
+ */
+#define RESULT_BREAKER_BUCKETS      10
+
+#define RESULT_BREAKER_UNUSED       UINT64_MAX
+
+typedef enum {
+    Result_BreakerClosed,
+    Result_BreakerOpen,
+    Result_BreakerHalfOpen,
+} Result_BreakerState;
+
+/*
+ * Buckets are laid out `stride` bytes apart, each one starting on its own cache line.
+ */
+typedef struct {
+    uint64_t epoch;
+    size_t calls;
+    size_t failures[];
+} Result_BreakerBucket;
+
+struct ResultBreaker {
+    Result (*f)(const void *);
+    Error tripped;
+    bool (*trips)(Error);
+    size_t threshold;
+    size_t minimumCalls;
+    uint64_t width;
+    uint64_t cooldown;
+    int state;
+    uint64_t openedAt;
+    size_t shortCircuits;
+    size_t kinds;
+    size_t stride;
+    unsigned char *buckets;
+};
+
+static bool Result_breakerAnyError(Error error)
+__attribute__((__warn_unused_result__));
+
+static size_t Result_breakerKind(ResultBreaker self, Error error)
+__attribute__((__warn_unused_result__, __nonnull__));
+
+static Result_BreakerBucket *Result_breakerBucketAt(ResultBreaker self, size_t i)
+__attribute__((__warn_unused_result__, __nonnull__));
+
+static Result_BreakerBucket *Result_breakerBucket(ResultBreaker self, uint64_t epoch)
+__attribute__((__warn_unused_result__, __nonnull__));
+
+static void Result_breakerSum(ResultBreaker self, uint64_t now, size_t kind, size_t *calls, size_t *failures)
+__attribute__((__nonnull__));
+
+static void Result_breakerReset(ResultBreaker self)
+__attribute__((__nonnull__));
+
+ResultBreaker ResultBreaker_new(Result (*const f)(const void *), Error tripped, bool (*const trips)(Error),
+                                const size_t threshold, const size_t minimumCalls, const size_t window,
+                                const size_t cooldown) {
+    Panic_when(NULL == f);
+    Panic_when(NULL == tripped || Ok == tripped);
+    Panic_unless(threshold >= 1 && threshold <= 100);
+    Panic_when(0 == window);
+    ResultBreaker self = NULL;
+    Panic_unless(0 == posix_memalign((void **) &self, RESULT_BREAKER_CACHE_LINE, sizeof(*self)));
+    self->f = f;
+    self->tripped = tripped;
+    self->trips = (NULL == trips) ? Result_breakerAnyError : trips;
+    self->threshold = threshold;
+    self->minimumCalls = minimumCalls;
+    self->width = (uint64_t) window * UINT64_C(1000000) / RESULT_BREAKER_BUCKETS;
+    self->width = (0 == self->width) ? 1 : self->width;
+    self->cooldown = (uint64_t) cooldown * UINT64_C(1000000);
+    self->state = Result_BreakerClosed;
+    self->openedAt = 0;
+    self->shortCircuits = 0;
+    // one counter per error indexed so far, the last one is shared by the errors indexed later on
+    self->kinds = Error_indices() + 1;
+    self->stride = sizeof(Result_BreakerBucket) + self->kinds * sizeof(size_t);
+    self->stride = (self->stride + RESULT_BREAKER_CACHE_LINE - 1) / RESULT_BREAKER_CACHE_LINE * RESULT_BREAKER_CACHE_LINE;
+    Panic_unless(0 == posix_memalign((void **) &self->buckets, RESULT_BREAKER_CACHE_LINE,
+                                     RESULT_BREAKER_BUCKETS * self->stride));
+    memset(self->buckets, 0, RESULT_BREAKER_BUCKETS * self->stride);
+    for (size_t i = 0; i < RESULT_BREAKER_BUCKETS; i++) {
+        Result_breakerBucketAt(self, i)->epoch = RESULT_BREAKER_UNUSED;
+    }
+    return self;
+}
+
+Result ResultBreaker_call(ResultBreaker self, const void *const value) {
+    assert(NULL != self);
+    bool probe = false;
+    int state = __atomic_load_n(&self->state, __ATOMIC_ACQUIRE);
+    if (Result_BreakerClosed != state) {
+        // only the thread moving the breaker to half open gets to probe
+        probe = Result_BreakerOpen == state &&
+                Result_deadlineNow() - __atomic_load_n(&self->openedAt, __ATOMIC_ACQUIRE) >= self->cooldown &&
+                __atomic_compare_exchange_n(&self->state, &state, Result_BreakerHalfOpen, false, __ATOMIC_ACQ_REL,
+                                            __ATOMIC_ACQUIRE);
+        if (!probe) {
+            __atomic_add_fetch(&self->shortCircuits, 1, __ATOMIC_RELAXED);
+            return Result_error(self->tripped);
+        }
+    }
+
+    const Result result = self->f(value);
+    const Error error = Result_inspect(result);
+    const bool failed = Ok != error && self->trips(error);
+    const uint64_t now = Result_deadlineNow();
+
+    if (probe) {
+        if (failed) {
+            __atomic_store_n(&self->openedAt, now, __ATOMIC_RELEASE);
+            __atomic_store_n(&self->state, Result_BreakerOpen, __ATOMIC_RELEASE);
+        } else {
+            Result_breakerReset(self);
+            __atomic_store_n(&self->state, Result_BreakerClosed, __ATOMIC_RELEASE);
+        }
+        return result;
+    }
+
+    Result_BreakerBucket *bucket = Result_breakerBucket(self, now / self->width);
+    __atomic_add_fetch(&bucket->calls, 1, __ATOMIC_RELAXED);
+    if (Ok != error) {
+        __atomic_add_fetch(&bucket->failures[Result_breakerKind(self, error)], 1, __ATOMIC_RELAXED);
+    }
+
+    if (failed) {
+        size_t calls, failures;
+        Result_breakerSum(self, now, Result_breakerKind(self, error), &calls, &failures);
+        if (calls >= self->minimumCalls && failures * 100 >= self->threshold * calls) {
+            int closed = Result_BreakerClosed;
+            __atomic_store_n(&self->openedAt, now, __ATOMIC_RELEASE);
+            __atomic_compare_exchange_n(&self->state, &closed, Result_BreakerOpen, false, __ATOMIC_ACQ_REL,
+                                        __ATOMIC_ACQUIRE);
+        }
+    }
+    return result;
+}
+
+bool ResultBreaker_isOpen(ResultBreaker self) {
+    assert(NULL != self);
+    return Result_BreakerClosed != __atomic_load_n(&self->state, __ATOMIC_ACQUIRE);
+}
+
+size_t ResultBreaker_calls(ResultBreaker self) {
+    assert(NULL != self);
+    size_t calls, failures;
+    Result_breakerSum(self, Result_deadlineNow(), 0, &calls, &failures);
+    return calls;
+}
+
+size_t ResultBreaker_failures(ResultBreaker self, Error error) {
+    assert(NULL != self);
+    assert(NULL != error);
+    size_t calls, failures;
+    Result_breakerSum(self, Result_deadlineNow(), Result_breakerKind(self, error), &calls, &failures);
+    return (Ok == error) ? 0 : failures;
+}
+
+size_t ResultBreaker_shortCircuits(ResultBreaker self) {
+    assert(NULL != self);
+    return __atomic_load_n(&self->shortCircuits, __ATOMIC_RELAXED);
+}
+
+void ResultBreaker_delete(ResultBreaker self) {
+    assert(NULL != self);
+    free(self->buckets);
+    free(self);
+}
+
+bool Result_breakerAnyError(Error error) {
+    return Ok != error;
+}
+
+size_t Result_breakerKind(ResultBreaker self, Error error) {
+    assert(NULL != self);
+    assert(NULL != error);
+    const size_t index = Error_index(error);
+    return (index < self->kinds) ? index : self->kinds - 1;
+}
+
+Result_BreakerBucket *Result_breakerBucketAt(ResultBreaker self, const size_t i) {
+    assert(NULL != self);
+    return (Result_BreakerBucket *) (self->buckets + i * self->stride);
+}
+
+Result_BreakerBucket *Result_breakerBucket(ResultBreaker self, const uint64_t epoch) {
+    assert(NULL != self);
+    Result_BreakerBucket *bucket = Result_breakerBucketAt(self, epoch % RESULT_BREAKER_BUCKETS);
+    uint64_t current = __atomic_load_n(&bucket->epoch, __ATOMIC_ACQUIRE);
+    // the first thread getting to a stale bucket recycles it, counts racing with the reset may be lost
+    if (current != epoch && (RESULT_BREAKER_UNUSED == current || current < epoch) &&
+        __atomic_compare_exchange_n(&bucket->epoch, &current, epoch, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+        __atomic_store_n(&bucket->calls, 0, __ATOMIC_RELAXED);
+        for (size_t i = 0; i < self->kinds; i++) {
+            __atomic_store_n(&bucket->failures[i], 0, __ATOMIC_RELAXED);
+        }
+    }
+    return bucket;
+}
+
+void Result_breakerSum(ResultBreaker self, const uint64_t now, const size_t kind, size_t *const calls,
+                       size_t *const failures) {
+    assert(NULL != self);
+    assert(NULL != calls);
+    assert(NULL != failures);
+    const uint64_t epoch = now / self->width;
+    *calls = *failures = 0;
+    for (size_t i = 0; i < RESULT_BREAKER_BUCKETS; i++) {
+        const Result_BreakerBucket *bucket = Result_breakerBucketAt(self, i);
+        const uint64_t bucketEpoch = __atomic_load_n(&bucket->epoch, __ATOMIC_ACQUIRE);
+        if (RESULT_BREAKER_UNUSED != bucketEpoch && bucketEpoch <= epoch &&
+            epoch - bucketEpoch < RESULT_BREAKER_BUCKETS) {
+            *calls += __atomic_load_n(&bucket->calls, __ATOMIC_RELAXED);
+            *failures += __atomic_load_n(&bucket->failures[kind], __ATOMIC_RELAXED);
+        }
+    }
+}
+
+void Result_breakerReset(ResultBreaker self) {
+    assert(NULL != self);
+    for (size_t i = 0; i < RESULT_BREAKER_BUCKETS; i++) {
+        __atomic_store_n(&Result_breakerBucketAt(self, i)->epoch, RESULT_BREAKER_UNUSED, __ATOMIC_RELEASE);
+    }
+}
@@ -0,0 +1,121 @@
+/*
+Author: daddinuz
+email:  daddinuz@gmail.com
+
+Copyright (c) 2018 Davide Di Carlo
+
+Permission is hereby granted, free of charge, to any person
+obtaining a copy of this software and associated documentation
+files (the "Software"), to deal in the Software without
+restriction, including without limitation the rights to use,
+copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be
+included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdbool.h>
+#include "result.h"
+
+#if !(defined(__GNUC__) || defined(__clang__))
+__attribute__(...)
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * A circuit breaker around a function returning `Result`s.
+ * Outcomes are counted per error kind over a sliding window; when the share of calls failing with one of the tripping
+ * errors crosses the threshold the breaker opens: calls return the configured error without calling the function.
+ * After a cooldown a single probe call is let through (half open): if it succeeds the breaker closes, else it opens again.
+ * A breaker may be shared among threads, counters are updated without locks.
+ *
+ * @attention this struct must be treated as opaque therefore its members must not be accessed directly.
+ */
+typedef struct ResultBreaker *ResultBreaker;
+
+/**
+ * Creates a breaker around `f` returning `Result_error(tripped)` while open.
+ * It opens when, over the last `window` milliseconds and at least `minimumCalls` calls, the calls failing with an error
+ * accepted by `trips` reach `threshold` percent, each error kind being counted on its own.
+ * If `trips` is `NULL` every error trips the breaker.
+ * Error kinds are told apart by `Error_index(...)`: the errors indexed after the breaker has been created share a single
+ * counter, custom errors should be indexed beforehand in order to be counted on their own.
+ *
+ * @attention f must not be `NULL`.
+ * @attention tripped must not be `NULL` nor `Ok`.
+ * @attention threshold must be between 1 and 100.
+ * @attention window must be greater than 0.
+ */
+extern ResultBreaker ResultBreaker_new(Result f(const void *), Error tripped, bool trips(Error), size_t threshold,
+                                       size_t minimumCalls, size_t window, size_t cooldown)
+__attribute__((__warn_unused_result__));
+
+/**
+ * Returns `f(value)` unless the breaker is open.
+ *
+ * @attention self must not be `NULL`.
+ */
+extern Result ResultBreaker_call(ResultBreaker self, const void *value)
+__attribute__((__warn_unused_result__, __nonnull__(1)));
+
+/**
+ * Returns `true` if calls are currently being short-circuited, `false` otherwise.
+ *
+ * @attention self must not be `NULL`.
+ */
+extern bool ResultBreaker_isOpen(ResultBreaker self)
+__attribute__((__warn_unused_result__, __nonnull__));
+
+/**
+ * Returns how many calls reached `f` within the current window.
+ *
+ * @attention self must not be `NULL`.
+ */
+extern size_t ResultBreaker_calls(ResultBreaker self)
+__attribute__((__warn_unused_result__, __nonnull__));
+
+/**
+ * Returns how many calls failed with `error` within the current window.
+ *
+ * @attention self must not be `NULL`.
+ * @attention error must not be `NULL`.
+ */
+extern size_t ResultBreaker_failures(ResultBreaker self, Error error)
+__attribute__((__warn_unused_result__, __nonnull__));
+
+/**
+ * Returns how many calls have been short-circuited since the breaker was created.
+ *
+ * @attention self must not be `NULL`.
+ */
+extern size_t ResultBreaker_shortCircuits(ResultBreaker self)
+__attribute__((__warn_unused_result__, __nonnull__));
+
+/**
+ * Releases the breaker.
+ *
+ * @attention self must not be `NULL`.
+ */
+extern void ResultBreaker_delete(ResultBreaker self)
+__attribute__((__nonnull__));
+
+#ifdef __cplusplus
+}
+#endif
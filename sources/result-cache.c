@@ -0,0 +1,305 @@
+/*
+ * Author: daddinuz
+ * email:  daddinuz@gmail.com
+ *
+ * Copyright (c) 2018 Davide Di Carlo
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <stdlib.h>
+#include <assert.h>
+#include <pthread.h>
+#include <panic/panic.h>
+#include "result-clock.h"
+#include "result-cache.h"
+
+#define RESULT_CACHE_CACHE_LINE     64
+
+/*
+ * Upper bound on the number of shards, and smallest number of entries worth a shard of its own.
+ */
+#define RESULT_CACHE_SHARDS         16
+#define RESULT_CACHE_SHARD_MINIMUM  8
+
+#define RESULT_CACHE_NOT_FOUND      SIZE_MAX
+
+typedef struct {
+    const void *key;
+    size_t hash;
+    uint64_t expiry;
+    Result result;
+    bool used;
+    bool referenced;
+} Result_CacheEntry;
+
+typedef struct {
+    pthread_mutex_t mutex;
+    size_t size;
+    size_t capacity;
+    size_t mask;
+    size_t hand;
+    size_t hits;
+    size_t misses;
+    size_t evictions;
+    Result_CacheEntry *entries;
+} __attribute__((__aligned__(RESULT_CACHE_CACHE_LINE))) Result_CacheShard;
+
+struct ResultCache {
+    Result (*f)(const void *);
+    size_t (*hash)(const void *);
+    bool (*equals)(const void *, const void *);
+    uint64_t okTtl;
+    uint64_t errorTtl;
+    size_t shardsMask;
+    Result_CacheShard shards[];
+};
+
+static size_t Result_cacheHash(ResultCache self, const void *key)
+__attribute__((__warn_unused_result__, __nonnull__(1)));
+
+static uint64_t Result_cacheTtl(size_t milliseconds)
+__attribute__((__warn_unused_result__));
+
+static size_t Result_cacheFind(ResultCache self, Result_CacheShard *shard, const void *key, size_t hash)
+__attribute__((__warn_unused_result__, __nonnull__(1, 2)));
+
+static void Result_cacheInsert(Result_CacheShard *shard, const void *key, size_t hash, Result result, uint64_t expiry)
+__attribute__((__nonnull__(1)));
+
+static void Result_cacheEvict(Result_CacheShard *shard, uint64_t now)
+__attribute__((__nonnull__));
+
+static void Result_cacheRemove(Result_CacheShard *shard, size_t index)
+__attribute__((__nonnull__));
+
+ResultCache ResultCache_new(Result (*const f)(const void *), size_t (*const hash)(const void *),
+                            bool (*const equals)(const void *, const void *), const size_t capacity,
+                            const size_t okTtl, const size_t errorTtl) {
+    Panic_when(NULL == f || NULL == hash || NULL == equals);
+    Panic_when(0 == capacity);
+    size_t shards = 1;
+    while (shards < RESULT_CACHE_SHARDS && shards * 2 * RESULT_CACHE_SHARD_MINIMUM <= capacity) {
+        shards *= 2;
+    }
+
+    ResultCache self = NULL;
+    Panic_unless(0 == posix_memalign((void **) &self, RESULT_CACHE_CACHE_LINE,
+                                     sizeof(*self) + shards * sizeof(self->shards[0])));
+    self->f = f;
+    self->hash = hash;
+    self->equals = equals;
+    self->okTtl = Result_cacheTtl(okTtl);
+    self->errorTtl = Result_cacheTtl(errorTtl);
+    self->shardsMask = shards - 1;
+    for (size_t i = 0; i < shards; i++) {
+        Result_CacheShard *shard = &self->shards[i];
+        // keep the load factor at most 1/2 so that probe sequences stay short
+        size_t slots = 2;
+        shard->capacity = (capacity + shards - 1) / shards;
+        while (slots < 2 * shard->capacity) {
+            slots *= 2;
+        }
+        shard->size = shard->hand = shard->hits = shard->misses = shard->evictions = 0;
+        shard->mask = slots - 1;
+        shard->entries = calloc(slots, sizeof(shard->entries[0]));
+        Panic_when(NULL == shard->entries);
+        Panic_unless(0 == pthread_mutex_init(&shard->mutex, NULL));
+    }
+    return self;
+}
+
+Result ResultCache_get(ResultCache self, const void *const key) {
+    assert(NULL != self);
+    const size_t hash = Result_cacheHash(self, key);
+    Result_CacheShard *shard = &self->shards[(hash >> (sizeof(hash) * 4)) & self->shardsMask];
+    uint64_t now = Result_deadlineNow();
+
+    Panic_unless(0 == pthread_mutex_lock(&shard->mutex));
+    size_t index = Result_cacheFind(self, shard, key, hash);
+    if (RESULT_CACHE_NOT_FOUND != index) {
+        Result_CacheEntry *entry = &shard->entries[index];
+        if (now < entry->expiry) {
+            const Result result = entry->result;
+            entry->referenced = true;
+            __atomic_add_fetch(&shard->hits, 1, __ATOMIC_RELAXED);
+            Panic_unless(0 == pthread_mutex_unlock(&shard->mutex));
+            return result;
+        }
+        Result_cacheRemove(shard, index);
+    }
+    __atomic_add_fetch(&shard->misses, 1, __ATOMIC_RELAXED);
+    Panic_unless(0 == pthread_mutex_unlock(&shard->mutex));
+
+    const Result result = self->f(key);
+    const uint64_t ttl = Result_isOk(result) ? self->okTtl : self->errorTtl;
+    if (0 == ttl) {
+        return result;
+    }
+    now = Result_deadlineNow();
+    const uint64_t expiry = (ttl > UINT64_MAX - now) ? UINT64_MAX : now + ttl;
+
+    Panic_unless(0 == pthread_mutex_lock(&shard->mutex));
+    // somebody else may have cached it meanwhile
+    index = Result_cacheFind(self, shard, key, hash);
+    if (RESULT_CACHE_NOT_FOUND != index) {
+        shard->entries[index].result = result;
+        shard->entries[index].expiry = expiry;
+    } else {
+        if (shard->size >= shard->capacity) {
+            Result_cacheEvict(shard, now);
+        }
+        Result_cacheInsert(shard, key, hash, result, expiry);
+    }
+    Panic_unless(0 == pthread_mutex_unlock(&shard->mutex));
+    return result;
+}
+
+void ResultCache_invalidate(ResultCache self, const void *const key) {
+    assert(NULL != self);
+    const size_t hash = Result_cacheHash(self, key);
+    Result_CacheShard *shard = &self->shards[(hash >> (sizeof(hash) * 4)) & self->shardsMask];
+    Panic_unless(0 == pthread_mutex_lock(&shard->mutex));
+    const size_t index = Result_cacheFind(self, shard, key, hash);
+    if (RESULT_CACHE_NOT_FOUND != index) {
+        Result_cacheRemove(shard, index);
+    }
+    Panic_unless(0 == pthread_mutex_unlock(&shard->mutex));
+}
+
+size_t ResultCache_hits(ResultCache self) {
+    assert(NULL != self);
+    size_t hits = 0;
+    for (size_t i = 0; i <= self->shardsMask; i++) {
+        hits += __atomic_load_n(&self->shards[i].hits, __ATOMIC_RELAXED);
+    }
+    return hits;
+}
+
+size_t ResultCache_misses(ResultCache self) {
+    assert(NULL != self);
+    size_t misses = 0;
+    for (size_t i = 0; i <= self->shardsMask; i++) {
+        misses += __atomic_load_n(&self->shards[i].misses, __ATOMIC_RELAXED);
+    }
+    return misses;
+}
+
+size_t ResultCache_evictions(ResultCache self) {
+    assert(NULL != self);
+    size_t evictions = 0;
+    for (size_t i = 0; i <= self->shardsMask; i++) {
+        evictions += __atomic_load_n(&self->shards[i].evictions, __ATOMIC_RELAXED);
+    }
+    return evictions;
+}
+
+void ResultCache_delete(ResultCache self) {
+    assert(NULL != self);
+    for (size_t i = 0; i <= self->shardsMask; i++) {
+        pthread_mutex_destroy(&self->shards[i].mutex);
+        free(self->shards[i].entries);
+    }
+    free(self);
+}
+
+/*
+ * User hashes may be weak in their low bits, which pick the slot, or in their high bits, which pick the shard.
+ */
+size_t Result_cacheHash(ResultCache self, const void *const key) {
+    assert(NULL != self);
+    uint64_t hash = (uint64_t) self->hash(key);
+    hash ^= hash >> 33;
+    hash *= UINT64_C(0xff51afd7ed558ccd);
+    hash ^= hash >> 33;
+    hash *= UINT64_C(0xc4ceb9fe1a85ec53);
+    hash ^= hash >> 33;
+    return (size_t) hash;
+}
+
+uint64_t Result_cacheTtl(const size_t milliseconds) {
+    if (RESULT_CACHE_FOREVER == milliseconds || milliseconds > UINT64_MAX / UINT64_C(1000000)) {
+        return UINT64_MAX;
+    }
+    return (uint64_t) milliseconds * UINT64_C(1000000);
+}
+
+size_t Result_cacheFind(ResultCache self, Result_CacheShard *const shard, const void *const key, const size_t hash) {
+    assert(NULL != self);
+    assert(NULL != shard);
+    for (size_t i = hash & shard->mask; shard->entries[i].used; i = (i + 1) & shard->mask) {
+        if (hash == shard->entries[i].hash && self->equals(key, shard->entries[i].key)) {
+            return i;
+        }
+    }
+    return RESULT_CACHE_NOT_FOUND;
+}
+
+void Result_cacheInsert(Result_CacheShard *const shard, const void *const key, const size_t hash, const Result result,
+                        const uint64_t expiry) {
+    assert(NULL != shard);
+    size_t i = hash & shard->mask;
+    while (shard->entries[i].used) {
+        i = (i + 1) & shard->mask;
+    }
+    shard->entries[i] = (Result_CacheEntry) {
+            .key=key, .hash=hash, .expiry=expiry, .result=result, .used=true, .referenced=false
+    };
+    shard->size++;
+}
+
+void Result_cacheEvict(Result_CacheShard *const shard, const uint64_t now) {
+    assert(NULL != shard);
+    // second chance: referenced entries are spared once, expired entries go first
+    for (;;) {
+        Result_CacheEntry *entry = &shard->entries[shard->hand];
+        if (entry->used) {
+            if (now >= entry->expiry) {
+                Result_cacheRemove(shard, shard->hand);
+                return;
+            }
+            if (!entry->referenced) {
+                __atomic_add_fetch(&shard->evictions, 1, __ATOMIC_RELAXED);
+                Result_cacheRemove(shard, shard->hand);
+                return;
+            }
+            entry->referenced = false;
+        }
+        shard->hand = (shard->hand + 1) & shard->mask;
+    }
+}
+
+void Result_cacheRemove(Result_CacheShard *const shard, size_t index) {
+    assert(NULL != shard);
+    // backward shift deletion: pull back the entries whose probe sequence went through the freed slot
+    shard->entries[index].used = false;
+    shard->size--;
+    for (size_t next = (index + 1) & shard->mask; shard->entries[next].used; next = (next + 1) & shard->mask) {
+        const size_t home = shard->entries[next].hash & shard->mask;
+        const bool stays = (index <= next) ? (index < home && home <= next) : (index < home || home <= next);
+        if (!stays) {
+            shard->entries[index] = shard->entries[next];
+            shard->entries[next].used = false;
+            index = next;
+        }
+    }
+}
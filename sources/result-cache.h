@@ -0,0 +1,122 @@
+/*
+Author: daddinuz
+email:  daddinuz@gmail.com
+
+Copyright (c) 2018 Davide Di Carlo
+
+Permission is hereby granted, free of charge, to any person
+obtaining a copy of this software and associated documentation
+files (the "Software"), to deal in the Software without
+restriction, including without limitation the rights to use,
+copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be
+included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "result.h"
+
+#if !(defined(__GNUC__) || defined(__clang__))
+__attribute__(...)
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Time to live of entries that never expire.
+ */
+#define RESULT_CACHE_FOREVER    SIZE_MAX
+
+/**
+ * Memoizes a function returning `Result`s, both values and errors are cached, each with its own time to live.
+ * The cache is split into shards, each one an open addressing table guarded by its own lock, entries are evicted
+ * following the CLOCK (second chance) policy once a shard is full.
+ *
+ * Keys and values are stored as pointers: they must outlive their cache entries.
+ *
+ * @attention this struct must be treated as opaque therefore its members must not be accessed directly.
+ */
+typedef struct ResultCache *ResultCache;
+
+/**
+ * Creates a cache holding up to about `capacity` outcomes of `f`, keys are compared by `hash` and `equals`.
+ * Times to live are expressed in milliseconds: 0 disables caching of that variant, `RESULT_CACHE_FOREVER` never expires.
+ *
+ * @attention f, hash and equals must not be `NULL`.
+ * @attention capacity must be greater than 0.
+ */
+extern ResultCache ResultCache_new(Result f(const void *), size_t hash(const void *),
+                                   bool equals(const void *, const void *), size_t capacity, size_t okTtl,
+                                   size_t errorTtl)
+__attribute__((__warn_unused_result__));
+
+/**
+ * Returns the cached outcome of `f(key)`, calling `f` if it isn't cached or has expired.
+ * `f` is called without holding any lock, concurrent misses on the same key may call it more than once.
+ *
+ * @attention self must not be `NULL`.
+ */
+extern Result ResultCache_get(ResultCache self, const void *key)
+__attribute__((__warn_unused_result__, __nonnull__(1)));
+
+/**
+ * Drops the cached outcome of `f(key)`, if any.
+ *
+ * @attention self must not be `NULL`.
+ */
+extern void ResultCache_invalidate(ResultCache self, const void *key)
+__attribute__((__nonnull__(1)));
+
+/**
+ * Returns how many lookups found a live entry.
+ *
+ * @attention self must not be `NULL`.
+ */
+extern size_t ResultCache_hits(ResultCache self)
+__attribute__((__warn_unused_result__, __nonnull__));
+
+/**
+ * Returns how many lookups had to call `f`, expired entries included.
+ *
+ * @attention self must not be `NULL`.
+ */
+extern size_t ResultCache_misses(ResultCache self)
+__attribute__((__warn_unused_result__, __nonnull__));
+
+/**
+ * Returns how many live entries have been dropped to make room for new ones.
+ *
+ * @attention self must not be `NULL`.
+ */
+extern size_t ResultCache_evictions(ResultCache self)
+__attribute__((__warn_unused_result__, __nonnull__));
+
+/**
+ * Releases the cache.
+ *
+ * @attention self must not be `NULL`.
+ */
+extern void ResultCache_delete(ResultCache self)
+__attribute__((__nonnull__));
+
+#ifdef __cplusplus
+}
+#endif
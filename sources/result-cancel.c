@@ -0,0 +1,55 @@
+/*
+ * Author: daddinuz
+ * email:  daddinuz@gmail.com
+ *
+ * Copyright (c) 2018 Davide Di Carlo
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <assert.h>
+#include <panic/panic.h>
+#include "result-cancel.h"
+
+ResultCancel ResultCancel_new(void) {
+    return (ResultCancel) {.__cancelled=false};
+}
+
+void ResultCancel_cancel(ResultCancel *const self) {
+    assert(NULL != self);
+    __atomic_store_n(&self->__cancelled, true, __ATOMIC_RELEASE);
+}
+
+bool ResultCancel_isCancelled(const ResultCancel *const self) {
+    assert(NULL != self);
+    // checked between stages, a plain load keeps it as cheap as possible
+    return __atomic_load_n(&self->__cancelled, __ATOMIC_RELAXED);
+}
+
+Result Result_chainCancellable(const Result self, Result (*const f)(const void *), const ResultCancel *const cancel) {
+    Panic_when(NULL == f);
+    Panic_when(NULL == cancel);
+    if (Result_isError(self)) {
+        return self;
+    }
+    return ResultCancel_isCancelled(cancel) ? Result_error(Cancelled) : f(Result_unwrap(self));
+}
@@ -0,0 +1,85 @@
+/*
+Author: daddinuz
+email:  daddinuz@gmail.com
+
+Copyright (c) 2018 Davide Di Carlo
+
+Permission is hereby granted, free of charge, to any person
+obtaining a copy of this software and associated documentation
+files (the "Software"), to deal in the Software without
+restriction, including without limitation the rights to use,
+copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be
+included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include "result.h"
+
+#if !(defined(__GNUC__) || defined(__clang__))
+__attribute__(...)
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * A flag telling pending work to stop, shared between whoever cancels and the work being cancelled.
+ * It may be embedded anywhere and cancelled from any thread.
+ *
+ * @attention this struct must be treated as opaque therefore its members must not be accessed directly.
+ */
+typedef struct {
+    int __cancelled;
+} ResultCancel;
+
+/**
+ * Creates a token that has not been cancelled.
+ */
+extern ResultCancel ResultCancel_new(void)
+__attribute__((__warn_unused_result__));
+
+/**
+ * Cancels the token, cancelling twice has no further effect.
+ *
+ * @attention self must not be `NULL`.
+ */
+extern void ResultCancel_cancel(ResultCancel *self)
+__attribute__((__nonnull__));
+
+/**
+ * Returns `true` if the token has been cancelled, `false` otherwise.
+ *
+ * @attention self must not be `NULL`.
+ */
+extern bool ResultCancel_isCancelled(const ResultCancel *self)
+__attribute__((__warn_unused_result__, __nonnull__));
+
+/**
+ * Same as `Result_chain(...)` but if this `Result` is an `Ok` variant and the token has been cancelled, `f` is not called
+ * and a `Result` wrapping `Cancelled` is returned.
+ *
+ * @attention f must not be `NULL`.
+ * @attention cancel must not be `NULL`.
+ */
+extern Result Result_chainCancellable(Result self, Result f(const void *), const ResultCancel *cancel)
+__attribute__((__warn_unused_result__));
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,446 @@
+/*
+ * Author: daddinuz
+ * email:  daddinuz@gmail.com
+ *
+ * Copyright (c) 2018 Davide Di Carlo
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <limits.h>
+#include <assert.h>
+#include <sched.h>
+#include <pthread.h>
+#include <panic/panic.h>
+#include "result-channel.h"
+
+#ifdef __linux__
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#endif
+
+#define RESULT_CHANNEL_CACHE_LINE   64
+
+/*
+ * Number of times a waiter polls the channel before going to sleep.
+ */
+#define RESULT_CHANNEL_SPINS        128
+
+#if defined(__x86_64__) || defined(__i386__)
+#define Result_channelRelax()       __builtin_ia32_pause()
+#elif defined(__aarch64__)
+#define Result_channelRelax()       __asm__ __volatile__("yield")
+#else
+#define Result_channelRelax()       ((void) 0)
+#endif
+
+typedef enum {
+    Result_ChannelEmpty,
+    Result_ChannelReceived,
+    Result_ChannelDrained,
+} Result_ChannelPoll;
+
+/*
+ * Wakes up the threads waiting for a condition, the sleeping side is selected by the wait policy.
+ * The counter of waiters lets the notifying side skip the syscall when nobody is sleeping.
+ */
+typedef struct {
+    size_t waiters;
+    uint32_t epoch;
+    pthread_mutex_t mutex;
+    pthread_cond_t condition;
+} __attribute__((__aligned__(RESULT_CHANNEL_CACHE_LINE))) Result_ChannelSignal;
+
+struct ResultChannel {
+    size_t enqueuePosition __attribute__((__aligned__(RESULT_CHANNEL_CACHE_LINE)));
+    size_t dequeuePosition __attribute__((__aligned__(RESULT_CHANNEL_CACHE_LINE)));
+    size_t sending __attribute__((__aligned__(RESULT_CHANNEL_CACHE_LINE)));
+    bool closed;
+    size_t mask;
+    size_t stride;
+    ResultChannel_Layout layout;
+    ResultChannel_WaitPolicy policy;
+    Result_ChannelSignal notEmpty;
+    Result_ChannelSignal notFull;
+    unsigned char *cells;
+};
+
+/*
+ * Each cell is a sequence number followed by the payload: a `Result` or a tagged word, depending on the layout.
+ * The sequence number tells whether the cell is ready to be written (== position) or read (== position + 1)
+ * at a given position of the ring.
+ */
+static size_t *Result_channelSequence(ResultChannel self, size_t position)
+__attribute__((__warn_unused_result__, __nonnull__));
+
+static void Result_channelStore(ResultChannel self, size_t position, Result result)
+__attribute__((__nonnull__));
+
+static Result Result_channelLoad(ResultChannel self, size_t position)
+__attribute__((__warn_unused_result__, __nonnull__));
+
+static bool Result_channelEnqueue(ResultChannel self, Result result)
+__attribute__((__warn_unused_result__, __nonnull__));
+
+static bool Result_channelDequeue(ResultChannel self, Result *out)
+__attribute__((__warn_unused_result__, __nonnull__));
+
+static Result_ChannelPoll Result_channelPoll(ResultChannel self, Result *out)
+__attribute__((__warn_unused_result__, __nonnull__));
+
+static bool Result_channelIsFull(ResultChannel self)
+__attribute__((__warn_unused_result__, __nonnull__));
+
+static bool Result_channelIsEmpty(ResultChannel self)
+__attribute__((__warn_unused_result__, __nonnull__));
+
+static void Result_channelWait(ResultChannel self, Result_ChannelSignal *signal, bool isBlocked(ResultChannel))
+__attribute__((__nonnull__));
+
+static void Result_channelNotify(ResultChannel self, Result_ChannelSignal *signal)
+__attribute__((__nonnull__));
+
+ResultChannel ResultChannel_new(const size_t capacity, const ResultChannel_Layout layout,
+                                const ResultChannel_WaitPolicy policy) {
+    Panic_when(0 == capacity);
+    Panic_unless(ResultChannel_Wide == layout || ResultChannel_Compact == layout);
+    Panic_unless(ResultChannel_Spinning == policy || ResultChannel_Blocking == policy || ResultChannel_Futex == policy);
+#ifndef __linux__
+    Panic_when(ResultChannel_Futex == policy);
+#endif
+    size_t size = 2;
+    while (size < capacity) {
+        Panic_when(size > SIZE_MAX / 2);
+        size *= 2;
+    }
+
+    ResultChannel self = NULL;
+    Panic_unless(0 == posix_memalign((void **) &self, RESULT_CHANNEL_CACHE_LINE, sizeof(*self)));
+    self->enqueuePosition = 0;
+    self->dequeuePosition = 0;
+    self->sending = 0;
+    self->closed = false;
+    self->mask = size - 1;
+    self->stride = sizeof(size_t) + ((ResultChannel_Compact == layout) ? sizeof(uintptr_t) : sizeof(Result));
+    self->layout = layout;
+    self->policy = policy;
+    self->cells = NULL;
+    Panic_when(size > SIZE_MAX / self->stride);
+    Panic_unless(0 == posix_memalign((void **) &self->cells, RESULT_CHANNEL_CACHE_LINE, size * self->stride));
+    for (size_t i = 0; i < size; i++) {
+        *Result_channelSequence(self, i) = i;
+    }
+
+    Result_ChannelSignal *signals[] = {&self->notEmpty, &self->notFull};
+    for (size_t i = 0; i < sizeof(signals) / sizeof(signals[0]); i++) {
+        pthread_condattr_t attributes;
+        signals[i]->waiters = 0;
+        signals[i]->epoch = 0;
+        Panic_unless(0 == pthread_condattr_init(&attributes));
+        Panic_unless(0 == pthread_condattr_setclock(&attributes, CLOCK_MONOTONIC));
+        Panic_unless(0 == pthread_mutex_init(&signals[i]->mutex, NULL));
+        Panic_unless(0 == pthread_cond_init(&signals[i]->condition, &attributes));
+        pthread_condattr_destroy(&attributes);
+    }
+    return self;
+}
+
+bool ResultChannel_trySend(ResultChannel self, const Result result) {
+    assert(NULL != self);
+    if (Result_channelEnqueue(self, result)) {
+        Result_channelNotify(self, &self->notEmpty);
+        return true;
+    }
+    return false;
+}
+
+bool ResultChannel_send(ResultChannel self, const Result result) {
+    assert(NULL != self);
+    while (!Result_channelEnqueue(self, result)) {
+        if (__atomic_load_n(&self->closed, __ATOMIC_ACQUIRE)) {
+            return false;
+        }
+        Result_channelWait(self, &self->notFull, Result_channelIsFull);
+    }
+    Result_channelNotify(self, &self->notEmpty);
+    return true;
+}
+
+size_t ResultChannel_sendBatch(ResultChannel self, const Result *const results, const size_t size) {
+    assert(NULL != self);
+    Panic_when(NULL == results);
+    size_t sent = 0;
+    while (sent < size) {
+        if (Result_channelEnqueue(self, results[sent])) {
+            sent++;
+            continue;
+        }
+        if (__atomic_load_n(&self->closed, __ATOMIC_ACQUIRE)) {
+            break;
+        }
+        // let receivers drain what has been sent so far before waiting for room
+        Result_channelNotify(self, &self->notEmpty);
+        Result_channelWait(self, &self->notFull, Result_channelIsFull);
+    }
+    if (sent > 0) {
+        Result_channelNotify(self, &self->notEmpty);
+    }
+    return sent;
+}
+
+bool ResultChannel_tryReceive(ResultChannel self, Result *const out) {
+    assert(NULL != self);
+    Panic_when(NULL == out);
+    return Result_ChannelEmpty != Result_channelPoll(self, out);
+}
+
+Result ResultChannel_receive(ResultChannel self) {
+    assert(NULL != self);
+    Result result;
+    while (Result_ChannelEmpty == Result_channelPoll(self, &result)) {
+        Result_channelWait(self, &self->notEmpty, Result_channelIsEmpty);
+    }
+    return result;
+}
+
+size_t ResultChannel_receiveBatch(ResultChannel self, Result *const results, const size_t size) {
+    assert(NULL != self);
+    Panic_when(NULL == results);
+    Panic_when(0 == size);
+    Result_ChannelPoll poll;
+    while (Result_ChannelEmpty == (poll = Result_channelPoll(self, &results[0]))) {
+        Result_channelWait(self, &self->notEmpty, Result_channelIsEmpty);
+    }
+    if (Result_ChannelDrained == poll) {
+        return 1;
+    }
+    size_t received = 1;
+    while (received < size && Result_channelDequeue(self, &results[received])) {
+        received++;
+    }
+    if (received > 1) {
+        Result_channelNotify(self, &self->notFull);
+    }
+    return received;
+}
+
+void ResultChannel_close(ResultChannel self) {
+    assert(NULL != self);
+    __atomic_store_n(&self->closed, true, __ATOMIC_SEQ_CST);
+    Result_channelNotify(self, &self->notEmpty);
+    Result_channelNotify(self, &self->notFull);
+}
+
+void ResultChannel_delete(ResultChannel self) {
+    assert(NULL != self);
+    Result_ChannelSignal *signals[] = {&self->notEmpty, &self->notFull};
+    for (size_t i = 0; i < sizeof(signals) / sizeof(signals[0]); i++) {
+        pthread_cond_destroy(&signals[i]->condition);
+        pthread_mutex_destroy(&signals[i]->mutex);
+    }
+    free(self->cells);
+    free(self);
+}
+
+size_t *Result_channelSequence(ResultChannel self, const size_t position) {
+    assert(NULL != self);
+    return (size_t *) (self->cells + (position & self->mask) * self->stride);
+}
+
+void Result_channelStore(ResultChannel self, const size_t position, const Result result) {
+    assert(NULL != self);
+    void *payload = Result_channelSequence(self, position) + 1;
+    if (ResultChannel_Compact == self->layout) {
+        // errors are tagged by the lowest bit, values must leave it free
+        uintptr_t word;
+        if (Result_isOk(result)) {
+            word = (uintptr_t) Result_unwrap(result);
+            Panic_when(word & 1);
+        } else {
+            // there is no room for a payload, e.g. the errno of a ResultIO error, refuse to drop it silently
+            Panic_when(NULL != result.__value);
+            word = (uintptr_t) Result_inspect(result) | 1;
+        }
+        *(uintptr_t *) payload = word;
+    } else {
+        *(Result *) payload = result;
+    }
+}
+
+Result Result_channelLoad(ResultChannel self, const size_t position) {
+    assert(NULL != self);
+    const void *payload = Result_channelSequence(self, position) + 1;
+    if (ResultChannel_Compact == self->layout) {
+        const uintptr_t word = *(const uintptr_t *) payload;
+        return (word & 1) ? Result_error((Error) (word & ~(uintptr_t) 1)) : Result_ok((const void *) word);
+    }
+    return *(const Result *) payload;
+}
+
+bool Result_channelEnqueue(ResultChannel self, const Result result) {
+    assert(NULL != self);
+    bool enqueued = false;
+    __atomic_add_fetch(&self->sending, 1, __ATOMIC_SEQ_CST);
+    if (!__atomic_load_n(&self->closed, __ATOMIC_SEQ_CST)) {
+        size_t position = __atomic_load_n(&self->enqueuePosition, __ATOMIC_RELAXED);
+        for (;;) {
+            size_t *sequence = Result_channelSequence(self, position);
+            const intptr_t difference = (intptr_t) (__atomic_load_n(sequence, __ATOMIC_ACQUIRE) - position);
+            if (0 == difference) {
+                if (__atomic_compare_exchange_n(&self->enqueuePosition, &position, position + 1, true,
+                                                __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                    Result_channelStore(self, position, result);
+                    __atomic_store_n(sequence, position + 1, __ATOMIC_RELEASE);
+                    enqueued = true;
+                    break;
+                }
+            } else if (difference < 0) {
+                // the cell still holds the result sent one lap ago: full
+                break;
+            } else {
+                position = __atomic_load_n(&self->enqueuePosition, __ATOMIC_RELAXED);
+            }
+        }
+    }
+    __atomic_sub_fetch(&self->sending, 1, __ATOMIC_RELEASE);
+    return enqueued;
+}
+
+bool Result_channelDequeue(ResultChannel self, Result *const out) {
+    assert(NULL != self);
+    assert(NULL != out);
+    size_t position = __atomic_load_n(&self->dequeuePosition, __ATOMIC_RELAXED);
+    for (;;) {
+        size_t *sequence = Result_channelSequence(self, position);
+        const intptr_t difference = (intptr_t) (__atomic_load_n(sequence, __ATOMIC_ACQUIRE) - (position + 1));
+        if (0 == difference) {
+            if (__atomic_compare_exchange_n(&self->dequeuePosition, &position, position + 1, true,
+                                            __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                *out = Result_channelLoad(self, position);
+                __atomic_store_n(sequence, position + self->mask + 1, __ATOMIC_RELEASE);
+                return true;
+            }
+        } else if (difference < 0) {
+            // the cell has not been written yet: empty
+            return false;
+        } else {
+            position = __atomic_load_n(&self->dequeuePosition, __ATOMIC_RELAXED);
+        }
+    }
+}
+
+Result_ChannelPoll Result_channelPoll(ResultChannel self, Result *const out) {
+    assert(NULL != self);
+    assert(NULL != out);
+    if (Result_channelDequeue(self, out)) {
+        Result_channelNotify(self, &self->notFull);
+        return Result_ChannelReceived;
+    }
+    if (__atomic_load_n(&self->closed, __ATOMIC_ACQUIRE)) {
+        // senders that got in before close may still be publishing their results
+        while (__atomic_load_n(&self->sending, __ATOMIC_ACQUIRE) > 0) {
+            Result_channelRelax();
+        }
+        if (Result_channelDequeue(self, out)) {
+            return Result_ChannelReceived;
+        }
+        *out = Result_error(StopIteration);
+        return Result_ChannelDrained;
+    }
+    return Result_ChannelEmpty;
+}
+
+bool Result_channelIsFull(ResultChannel self) {
+    assert(NULL != self);
+    const size_t position = __atomic_load_n(&self->enqueuePosition, __ATOMIC_SEQ_CST);
+    return !__atomic_load_n(&self->closed, __ATOMIC_SEQ_CST) &&
+           __atomic_load_n(Result_channelSequence(self, position), __ATOMIC_SEQ_CST) != position;
+}
+
+bool Result_channelIsEmpty(ResultChannel self) {
+    assert(NULL != self);
+    const size_t position = __atomic_load_n(&self->dequeuePosition, __ATOMIC_SEQ_CST);
+    return !__atomic_load_n(&self->closed, __ATOMIC_SEQ_CST) &&
+           __atomic_load_n(Result_channelSequence(self, position), __ATOMIC_SEQ_CST) != position + 1;
+}
+
+void Result_channelWait(ResultChannel self, Result_ChannelSignal *const signal, bool isBlocked(ResultChannel)) {
+    assert(NULL != self);
+    assert(NULL != signal);
+    for (size_t i = 0; i < RESULT_CHANNEL_SPINS || ResultChannel_Spinning == self->policy; i++) {
+        if (!isBlocked(self)) {
+            return;
+        }
+        if (i < RESULT_CHANNEL_SPINS) {
+            Result_channelRelax();
+        } else {
+            // the thread we are waiting for may be sharing our core
+            sched_yield();
+        }
+    }
+
+    // announce the waiter before the last check: either the notifier sees it or the check sees the notifier's update
+    if (ResultChannel_Blocking == self->policy) {
+        Panic_unless(0 == pthread_mutex_lock(&signal->mutex));
+        __atomic_add_fetch(&signal->waiters, 1, __ATOMIC_SEQ_CST);
+        while (isBlocked(self)) {
+            pthread_cond_wait(&signal->condition, &signal->mutex);
+        }
+        __atomic_sub_fetch(&signal->waiters, 1, __ATOMIC_SEQ_CST);
+        Panic_unless(0 == pthread_mutex_unlock(&signal->mutex));
+    } else {
+#ifdef __linux__
+        const uint32_t epoch = __atomic_load_n(&signal->epoch, __ATOMIC_SEQ_CST);
+        __atomic_add_fetch(&signal->waiters, 1, __ATOMIC_SEQ_CST);
+        if (isBlocked(self)) {
+            // returns straight away if the epoch moved meanwhile
+            syscall(SYS_futex, &signal->epoch, FUTEX_WAIT_PRIVATE, epoch, NULL, NULL, 0);
+        }
+        __atomic_sub_fetch(&signal->waiters, 1, __ATOMIC_SEQ_CST);
+#endif
+    }
+}
+
+void Result_channelNotify(ResultChannel self, Result_ChannelSignal *const signal) {
+    assert(NULL != self);
+    assert(NULL != signal);
+    if (ResultChannel_Spinning == self->policy) {
+        return;
+    }
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (0 == __atomic_load_n(&signal->waiters, __ATOMIC_SEQ_CST)) {
+        return;
+    }
+    if (ResultChannel_Blocking == self->policy) {
+        Panic_unless(0 == pthread_mutex_lock(&signal->mutex));
+        pthread_cond_broadcast(&signal->condition);
+        Panic_unless(0 == pthread_mutex_unlock(&signal->mutex));
+    } else {
+#ifdef __linux__
+        __atomic_add_fetch(&signal->epoch, 1, __ATOMIC_SEQ_CST);
+        syscall(SYS_futex, &signal->epoch, FUTEX_WAKE_PRIVATE, INT_MAX, NULL, NULL, 0);
+#endif
+    }
+}
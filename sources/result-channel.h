@@ -0,0 +1,176 @@
+/*
+Author: daddinuz
+email:  daddinuz@gmail.com
+
+Copyright (c) 2018 Davide Di Carlo
+
+Permission is hereby granted, free of charge, to any person
+obtaining a copy of this software and associated documentation
+files (the "Software"), to deal in the Software without
+restriction, including without limitation the rights to use,
+copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be
+included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdbool.h>
+#include "result.h"
+
+#if !(defined(__GNUC__) || defined(__clang__))
+__attribute__(...)
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * A bounded lock-free multi-producer multi-consumer queue of results.
+ * Once closed and drained, receiving yields a `Result` wrapping `StopIteration`.
+ *
+ * @attention this struct must be treated as opaque therefore its members must not be accessed directly.
+ */
+typedef struct ResultChannel *ResultChannel;
+
+/**
+ * How results are stored.
+ */
+typedef enum {
+    /**
+     * Results are stored as they are.
+     */
+    ResultChannel_Wide,
+
+    /**
+     * Results are stored in a single tagged word, halving the memory traffic.
+     * Values must be aligned to at least 2 bytes and errors can't carry a payload, so results built by e.g.
+     * `ResultIO_error(...)` must be sent through a wide channel.
+     */
+    ResultChannel_Compact,
+} ResultChannel_Layout;
+
+/**
+ * What senders and receivers do while the channel is full or empty.
+ */
+typedef enum {
+    /**
+     * Busy-wait yielding the processor, lowest latency, burns a core per waiting thread.
+     */
+    ResultChannel_Spinning,
+
+    /**
+     * Sleep on a condition variable.
+     */
+    ResultChannel_Blocking,
+
+    /**
+     * Sleep on a futex, cheaper than a condition variable when nobody is waiting (Linux only).
+     */
+    ResultChannel_Futex,
+} ResultChannel_WaitPolicy;
+
+/**
+ * Creates a channel holding at least `capacity` results (rounded up to a power of 2).
+ *
+ * @attention capacity must be greater than 0.
+ */
+extern ResultChannel ResultChannel_new(size_t capacity, ResultChannel_Layout layout, ResultChannel_WaitPolicy policy)
+__attribute__((__warn_unused_result__));
+
+/**
+ * Sends a result without waiting, returns `false` if the channel is full or closed.
+ *
+ * @attention self must not be `NULL`.
+ * @attention in compact layout the value of an `Ok` result must be aligned to at least 2 bytes and an error must not
+ * carry a payload.
+ */
+extern bool ResultChannel_trySend(ResultChannel self, Result result)
+__attribute__((__warn_unused_result__, __nonnull__));
+
+/**
+ * Sends a result waiting while the channel is full, returns `false` if the channel is closed.
+ *
+ * @attention self must not be `NULL`.
+ * @attention in compact layout the value of an `Ok` result must be aligned to at least 2 bytes and an error must not
+ * carry a payload.
+ */
+extern bool ResultChannel_send(ResultChannel self, Result result)
+__attribute__((__nonnull__));
+
+/**
+ * Sends `size` results waking up receivers once, returns how many have been sent: less than `size` only if the channel
+ * has been closed meanwhile.
+ *
+ * @attention self must not be `NULL`.
+ * @attention results must not be `NULL`.
+ * @attention in compact layout the value of an `Ok` result must be aligned to at least 2 bytes and an error must not
+ * carry a payload.
+ */
+extern size_t ResultChannel_sendBatch(ResultChannel self, const Result *results, size_t size)
+__attribute__((__nonnull__(1)));
+
+/**
+ * Receives a result without waiting, returns `false` if the channel is empty.
+ * If the channel is closed and drained `out` is set to a `Result` wrapping `StopIteration`.
+ *
+ * @attention self must not be `NULL`.
+ * @attention out must not be `NULL`.
+ */
+extern bool ResultChannel_tryReceive(ResultChannel self, Result *out)
+__attribute__((__warn_unused_result__, __nonnull__(1)));
+
+/**
+ * Receives a result waiting while the channel is empty.
+ * If the channel is closed and drained returns a `Result` wrapping `StopIteration`.
+ *
+ * @attention self must not be `NULL`.
+ */
+extern Result ResultChannel_receive(ResultChannel self)
+__attribute__((__warn_unused_result__, __nonnull__));
+
+/**
+ * Receives up to `size` results waiting while the channel is empty, returns how many have been received.
+ * If the channel is closed and drained a single `Result` wrapping `StopIteration` is received.
+ *
+ * @attention self must not be `NULL`.
+ * @attention results must not be `NULL`.
+ * @attention size must be greater than 0.
+ */
+extern size_t ResultChannel_receiveBatch(ResultChannel self, Result *results, size_t size)
+__attribute__((__warn_unused_result__, __nonnull__(1)));
+
+/**
+ * Closes the channel: further sends fail, receivers drain the remaining results then get `StopIteration`.
+ *
+ * @attention self must not be `NULL`.
+ */
+extern void ResultChannel_close(ResultChannel self)
+__attribute__((__nonnull__));
+
+/**
+ * Releases the channel.
+ *
+ * @attention self must not be `NULL`.
+ * @attention no thread must be using the channel.
+ */
+extern void ResultChannel_delete(ResultChannel self)
+__attribute__((__nonnull__));
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,75 @@
+/*
+ * Author: daddinuz
+ * email:  daddinuz@gmail.com
+ *
+ * Copyright (c) 2018 Davide Di Carlo
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <time.h>
+#include <panic/panic.h>
+#include "result-clock.h"
+#include "result-deadline.h"
+
+#define RESULT_DEADLINE_NEVER   UINT64_MAX
+
+ResultDeadline ResultDeadline_after(const size_t milliseconds) {
+    const uint64_t now = Result_deadlineNow();
+    if (milliseconds > (RESULT_DEADLINE_NEVER - 1 - now) / UINT64_C(1000000)) {
+        return ResultDeadline_never();
+    }
+    return (ResultDeadline) {.__nanoseconds=now + (uint64_t) milliseconds * UINT64_C(1000000)};
+}
+
+ResultDeadline ResultDeadline_never(void) {
+    return (ResultDeadline) {.__nanoseconds=RESULT_DEADLINE_NEVER};
+}
+
+bool ResultDeadline_isExpired(const ResultDeadline self) {
+    return RESULT_DEADLINE_NEVER != self.__nanoseconds && Result_deadlineNow() >= self.__nanoseconds;
+}
+
+size_t ResultDeadline_remaining(const ResultDeadline self) {
+    if (RESULT_DEADLINE_NEVER == self.__nanoseconds) {
+        return SIZE_MAX;
+    }
+    const uint64_t now = Result_deadlineNow();
+    return (now >= self.__nanoseconds) ? 0 : (size_t) ((self.__nanoseconds - now + 999999) / UINT64_C(1000000));
+}
+
+Result Result_chainWithin(const Result self, Result (*const f)(const void *), const ResultDeadline deadline) {
+    Panic_when(NULL == f);
+    if (Result_isError(self)) {
+        return self;
+    }
+    return ResultDeadline_isExpired(deadline) ? Result_error(TimeoutError) : f(Result_unwrap(self));
+}
+
+/*
+ * Served from the vDSO on Linux, no system call involved.
+ */
+uint64_t Result_deadlineNow(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t) now.tv_sec * UINT64_C(1000000000) + (uint64_t) now.tv_nsec;
+}
@@ -0,0 +1,87 @@
+/*
+Author: daddinuz
+email:  daddinuz@gmail.com
+
+Copyright (c) 2018 Davide Di Carlo
+
+Permission is hereby granted, free of charge, to any person
+obtaining a copy of this software and associated documentation
+files (the "Software"), to deal in the Software without
+restriction, including without limitation the rights to use,
+copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be
+included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "result.h"
+
+#if !(defined(__GNUC__) || defined(__clang__))
+__attribute__(...)
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * A point in time on the monotonic clock after which pending work should be dropped.
+ *
+ * @attention this struct must be treated as opaque therefore its members must not be accessed directly.
+ */
+typedef struct {
+    uint64_t __nanoseconds;
+} ResultDeadline;
+
+/**
+ * Creates a deadline expiring `milliseconds` from now.
+ */
+extern ResultDeadline ResultDeadline_after(size_t milliseconds)
+__attribute__((__warn_unused_result__));
+
+/**
+ * Creates a deadline that never expires, checking it doesn't read the clock.
+ */
+extern ResultDeadline ResultDeadline_never(void)
+__attribute__((__warn_unused_result__));
+
+/**
+ * Returns `true` if the deadline has passed, `false` otherwise.
+ */
+extern bool ResultDeadline_isExpired(ResultDeadline self)
+__attribute__((__warn_unused_result__));
+
+/**
+ * Returns the milliseconds left before the deadline, rounded up, 0 if it has passed or `SIZE_MAX` if it never expires.
+ */
+extern size_t ResultDeadline_remaining(ResultDeadline self)
+__attribute__((__warn_unused_result__));
+
+/**
+ * Same as `Result_chain(...)` but if this `Result` is an `Ok` variant and the deadline has passed, `f` is not called and
+ * a `Result` wrapping `TimeoutError` is returned.
+ *
+ * @attention f must not be `NULL`.
+ */
+extern Result Result_chainWithin(Result self, Result f(const void *), ResultDeadline deadline)
+__attribute__((__warn_unused_result__));
+
+#ifdef __cplusplus
+}
+#endif
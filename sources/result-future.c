@@ -0,0 +1,329 @@
+/*
+ * Author: daddinuz
+ * email:  daddinuz@gmail.com
+ *
+ * Copyright (c) 2018 Davide Di Carlo
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <time.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <panic/panic.h>
+#include "result-future.h"
+
+typedef enum {
+    ResultFuture_Spawn,
+    ResultFuture_Then,
+    ResultFuture_Map,
+} ResultFuture_Kind;
+
+struct ResultFuture {
+    ResultPool pool;
+    ResultFuture nextTask;
+    ResultFuture nextContinuation;
+    ResultFuture continuations;
+    pthread_mutex_t mutex;
+    pthread_cond_t condition;
+    size_t references;
+    bool resolved;
+    Result input;
+    Result result;
+    ResultFuture_Kind kind;
+    union {
+        Result (*spawn)(void *);
+        Result (*then)(const void *);
+        const void *(*map)(const void *);
+    } f;
+    void *context;
+};
+
+struct ResultPool {
+    pthread_mutex_t mutex;
+    pthread_cond_t workAvailable;
+    pthread_cond_t workDone;
+    ResultFuture head;
+    ResultFuture tail;
+    size_t pending;
+    bool stopping;
+    size_t workersSize;
+    pthread_t workers[];
+};
+
+static ResultFuture ResultFuture_new(ResultPool pool, ResultFuture_Kind kind)
+__attribute__((__warn_unused_result__, __nonnull__));
+
+static void ResultFuture_release(ResultFuture self)
+__attribute__((__nonnull__));
+
+static void ResultFuture_attach(ResultFuture self, ResultFuture continuation)
+__attribute__((__nonnull__));
+
+static void ResultFuture_schedule(ResultFuture self, Result input)
+__attribute__((__nonnull__));
+
+static void ResultFuture_resolve(ResultFuture self, Result result)
+__attribute__((__nonnull__));
+
+static void ResultFuture_execute(ResultFuture self)
+__attribute__((__nonnull__));
+
+static void ResultPool_submit(ResultPool self, ResultFuture future)
+__attribute__((__nonnull__));
+
+static void *ResultPool_work(void *self)
+__attribute__((__nonnull__));
+
+ResultPool ResultPool_new(size_t workers) {
+    if (0 == workers) {
+        const long processors = sysconf(_SC_NPROCESSORS_ONLN);
+        workers = (processors > 0) ? (size_t) processors : 1;
+    }
+    ResultPool self = malloc(sizeof(*self) + workers * sizeof(self->workers[0]));
+    Panic_when(NULL == self);
+    Panic_unless(0 == pthread_mutex_init(&self->mutex, NULL));
+    Panic_unless(0 == pthread_cond_init(&self->workAvailable, NULL));
+    Panic_unless(0 == pthread_cond_init(&self->workDone, NULL));
+    self->head = self->tail = NULL;
+    self->pending = 0;
+    self->stopping = false;
+    self->workersSize = workers;
+    for (size_t i = 0; i < workers; i++) {
+        Panic_unless(0 == pthread_create(&self->workers[i], NULL, ResultPool_work, self));
+    }
+    return self;
+}
+
+void ResultPool_delete(ResultPool self) {
+    assert(NULL != self);
+    pthread_mutex_lock(&self->mutex);
+    while (self->pending > 0) {
+        pthread_cond_wait(&self->workDone, &self->mutex);
+    }
+    self->stopping = true;
+    pthread_cond_broadcast(&self->workAvailable);
+    pthread_mutex_unlock(&self->mutex);
+    for (size_t i = 0; i < self->workersSize; i++) {
+        pthread_join(self->workers[i], NULL);
+    }
+    pthread_cond_destroy(&self->workDone);
+    pthread_cond_destroy(&self->workAvailable);
+    pthread_mutex_destroy(&self->mutex);
+    free(self);
+}
+
+ResultFuture ResultFuture_spawn(ResultPool pool, Result f(void *), void *const context) {
+    assert(NULL != pool);
+    Panic_when(NULL == f);
+    ResultFuture self = ResultFuture_new(pool, ResultFuture_Spawn);
+    self->f.spawn = f;
+    self->context = context;
+    ResultPool_submit(pool, self);
+    return self;
+}
+
+ResultFuture ResultFuture_then(ResultFuture self, Result f(const void *)) {
+    assert(NULL != self);
+    Panic_when(NULL == f);
+    ResultFuture continuation = ResultFuture_new(self->pool, ResultFuture_Then);
+    continuation->f.then = f;
+    ResultFuture_attach(self, continuation);
+    return continuation;
+}
+
+ResultFuture ResultFuture_map(ResultFuture self, const void *f(const void *)) {
+    assert(NULL != self);
+    Panic_when(NULL == f);
+    ResultFuture continuation = ResultFuture_new(self->pool, ResultFuture_Map);
+    continuation->f.map = f;
+    ResultFuture_attach(self, continuation);
+    return continuation;
+}
+
+Result ResultFuture_await(ResultFuture self) {
+    assert(NULL != self);
+    pthread_mutex_lock(&self->mutex);
+    while (!self->resolved) {
+        pthread_cond_wait(&self->condition, &self->mutex);
+    }
+    const Result result = self->result;
+    pthread_mutex_unlock(&self->mutex);
+    ResultFuture_release(self);
+    return result;
+}
+
+bool ResultFuture_awaitTimeout(ResultFuture self, const size_t milliseconds) {
+    assert(NULL != self);
+    struct timespec deadline;
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    deadline.tv_sec += milliseconds / 1000;
+    deadline.tv_nsec += (long) (milliseconds % 1000) * 1000000L;
+    if (deadline.tv_nsec >= 1000000000L) {
+        deadline.tv_sec += 1;
+        deadline.tv_nsec -= 1000000000L;
+    }
+    pthread_mutex_lock(&self->mutex);
+    while (!self->resolved && 0 == pthread_cond_timedwait(&self->condition, &self->mutex, &deadline)) {}
+    const bool resolved = self->resolved;
+    pthread_mutex_unlock(&self->mutex);
+    return resolved;
+}
+
+void ResultFuture_delete(ResultFuture self) {
+    assert(NULL != self);
+    ResultFuture_release(self);
+}
+
+ResultFuture ResultFuture_new(ResultPool pool, const ResultFuture_Kind kind) {
+    assert(NULL != pool);
+    ResultFuture self = calloc(1, sizeof(*self));
+    Panic_when(NULL == self);
+    pthread_condattr_t attributes;
+    Panic_unless(0 == pthread_condattr_init(&attributes));
+    Panic_unless(0 == pthread_condattr_setclock(&attributes, CLOCK_MONOTONIC));
+    Panic_unless(0 == pthread_mutex_init(&self->mutex, NULL));
+    Panic_unless(0 == pthread_cond_init(&self->condition, &attributes));
+    pthread_condattr_destroy(&attributes);
+    self->pool = pool;
+    self->kind = kind;
+    // one reference is owned by the caller, the other one by the pending stage until it resolves
+    self->references = 2;
+    return self;
+}
+
+void ResultFuture_release(ResultFuture self) {
+    assert(NULL != self);
+    if (0 == __atomic_sub_fetch(&self->references, 1, __ATOMIC_ACQ_REL)) {
+        pthread_cond_destroy(&self->condition);
+        pthread_mutex_destroy(&self->mutex);
+        free(self);
+    }
+}
+
+void ResultFuture_attach(ResultFuture self, ResultFuture continuation) {
+    assert(NULL != self);
+    assert(NULL != continuation);
+    pthread_mutex_lock(&self->mutex);
+    if (self->resolved) {
+        const Result result = self->result;
+        pthread_mutex_unlock(&self->mutex);
+        ResultFuture_schedule(continuation, result);
+    } else {
+        continuation->nextContinuation = self->continuations;
+        self->continuations = continuation;
+        pthread_mutex_unlock(&self->mutex);
+    }
+    ResultFuture_release(self);
+}
+
+void ResultFuture_schedule(ResultFuture self, const Result input) {
+    assert(NULL != self);
+    if (Result_isError(input)) {
+        // errors short-circuit exactly as in Result_chain, there's no need to hop on a worker
+        ResultFuture_resolve(self, input);
+    } else {
+        self->input = input;
+        ResultPool_submit(self->pool, self);
+    }
+}
+
+void ResultFuture_resolve(ResultFuture self, const Result result) {
+    assert(NULL != self);
+    pthread_mutex_lock(&self->mutex);
+    ResultFuture continuation = self->continuations;
+    self->continuations = NULL;
+    self->result = result;
+    self->resolved = true;
+    pthread_cond_broadcast(&self->condition);
+    pthread_mutex_unlock(&self->mutex);
+    while (NULL != continuation) {
+        ResultFuture next = continuation->nextContinuation;
+        ResultFuture_schedule(continuation, result);
+        continuation = next;
+    }
+    ResultFuture_release(self);
+}
+
+void ResultFuture_execute(ResultFuture self) {
+    assert(NULL != self);
+    switch (self->kind) {
+        case ResultFuture_Spawn:
+            ResultFuture_resolve(self, self->f.spawn(self->context));
+            break;
+        case ResultFuture_Then:
+            ResultFuture_resolve(self, Result_chain(self->input, self->f.then));
+            break;
+        case ResultFuture_Map:
+            ResultFuture_resolve(self, Result_map(self->input, self->f.map));
+            break;
+        default:
+            Panic_terminate("Unexpected future kind: %d", self->kind);
+    }
+}
+
+void ResultPool_submit(ResultPool self, ResultFuture future) {
+    assert(NULL != self);
+    assert(NULL != future);
+    future->nextTask = NULL;
+    pthread_mutex_lock(&self->mutex);
+    if (NULL == self->tail) {
+        self->head = self->tail = future;
+    } else {
+        self->tail->nextTask = future;
+        self->tail = future;
+    }
+    self->pending += 1;
+    pthread_cond_signal(&self->workAvailable);
+    pthread_mutex_unlock(&self->mutex);
+}
+
+void *ResultPool_work(void *const pool) {
+    assert(NULL != pool);
+    ResultPool self = pool;
+    for (;;) {
+        pthread_mutex_lock(&self->mutex);
+        while (NULL == self->head && !self->stopping) {
+            pthread_cond_wait(&self->workAvailable, &self->mutex);
+        }
+        ResultFuture future = self->head;
+        if (NULL == future) {
+            pthread_mutex_unlock(&self->mutex);
+            return NULL;
+        }
+        self->head = future->nextTask;
+        if (NULL == self->head) {
+            self->tail = NULL;
+        }
+        pthread_mutex_unlock(&self->mutex);
+
+        ResultFuture_execute(future);
+
+        pthread_mutex_lock(&self->mutex);
+        if (0 == --self->pending) {
+            pthread_cond_broadcast(&self->workDone);
+        }
+        pthread_mutex_unlock(&self->mutex);
+    }
+}
@@ -0,0 +1,131 @@
+/*
+Author: daddinuz
+email:  daddinuz@gmail.com
+
+Copyright (c) 2018 Davide Di Carlo
+
+Permission is hereby granted, free of charge, to any person
+obtaining a copy of this software and associated documentation
+files (the "Software"), to deal in the Software without
+restriction, including without limitation the rights to use,
+copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be
+included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdbool.h>
+#include "result.h"
+
+#if !(defined(__GNUC__) || defined(__clang__))
+__attribute__(...)
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * A fixed-size pool of worker threads running the stages of futures.
+ *
+ * @attention this struct must be treated as opaque therefore its members must not be accessed directly.
+ */
+typedef struct ResultPool *ResultPool;
+
+/**
+ * A `Result` that will be available later, computed asynchronously on a `ResultPool`.
+ * Every future must be consumed exactly once by `ResultFuture_then`, `ResultFuture_map`, `ResultFuture_await`
+ * or `ResultFuture_delete`.
+ *
+ * @attention this struct must be treated as opaque therefore its members must not be accessed directly.
+ */
+typedef struct ResultFuture *ResultFuture;
+
+/**
+ * Creates a pool running `workers` threads, if `workers` is 0 a thread for each online processor is started.
+ */
+extern ResultPool ResultPool_new(size_t workers)
+__attribute__((__warn_unused_result__));
+
+/**
+ * Waits for every pending stage to complete then stops the workers and releases the pool.
+ *
+ * @attention self must not be `NULL`.
+ * @attention futures spawned on this pool must have been consumed.
+ */
+extern void ResultPool_delete(ResultPool self)
+__attribute__((__nonnull__));
+
+/**
+ * Runs `f(context)` on a worker of the pool.
+ *
+ * @attention pool must not be `NULL`.
+ * @attention f must not be `NULL`.
+ */
+extern ResultFuture ResultFuture_spawn(ResultPool pool, Result f(void *), void *context)
+__attribute__((__warn_unused_result__, __nonnull__(1)));
+
+/**
+ * Asynchronous version of `Result_chain(...)`, once this future resolves `f` is run on a worker of the pool.
+ * This future is consumed.
+ *
+ * @attention self must not be `NULL`.
+ * @attention f must not be `NULL`.
+ */
+extern ResultFuture ResultFuture_then(ResultFuture self, Result f(const void *))
+__attribute__((__warn_unused_result__, __nonnull__(1)));
+
+/**
+ * Asynchronous version of `Result_map(...)`, once this future resolves `f` is run on a worker of the pool.
+ * This future is consumed.
+ *
+ * @attention self must not be `NULL`.
+ * @attention f must not be `NULL`.
+ */
+extern ResultFuture ResultFuture_map(ResultFuture self, const void *f(const void *))
+__attribute__((__warn_unused_result__, __nonnull__(1)));
+
+/**
+ * Blocks until this future resolves and returns its `Result`.
+ * This future is consumed.
+ *
+ * @attention self must not be `NULL`.
+ */
+extern Result ResultFuture_await(ResultFuture self)
+__attribute__((__warn_unused_result__, __nonnull__));
+
+/**
+ * Blocks until this future resolves or `milliseconds` elapse, returns `true` if the future has resolved.
+ * This future is not consumed, once resolved `ResultFuture_await(...)` returns immediately.
+ *
+ * @attention self must not be `NULL`.
+ */
+extern bool ResultFuture_awaitTimeout(ResultFuture self, size_t milliseconds)
+__attribute__((__warn_unused_result__, __nonnull__));
+
+/**
+ * Releases this future without waiting for it, its stages still run to completion.
+ * This future is consumed.
+ *
+ * @attention self must not be `NULL`.
+ */
+extern void ResultFuture_delete(ResultFuture self)
+__attribute__((__nonnull__));
+
+#ifdef __cplusplus
+}
+#endif
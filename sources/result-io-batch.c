@@ -0,0 +1,405 @@
+/*
+ * Author: daddinuz
+ * email:  daddinuz@gmail.com
+ *
+ * Copyright (c) 2018 Davide Di Carlo
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <unistd.h>
+#include <panic/panic.h>
+#include "result-io.h"
+#include "result-io-batch.h"
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#define RESULT_IO_BATCH_URING   1
+#endif
+#endif
+
+#ifdef RESULT_IO_BATCH_URING
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <linux/io_uring.h>
+#endif
+
+/*
+ * How many times in a row a request may be retried after `EINTR` or `EAGAIN` without making progress.
+ */
+#define RESULT_IO_BATCH_RETRIES 16
+
+/*
+ * A request in flight, slots index the submission queue entries one to one.
+ */
+typedef struct {
+    size_t request;
+    size_t done;
+    size_t retries;
+} Result_IOBatchSlot;
+
+#ifdef RESULT_IO_BATCH_URING
+typedef struct {
+    int fd;
+    unsigned *sqHead;
+    unsigned *sqTail;
+    unsigned *sqMask;
+    unsigned *sqArray;
+    unsigned *cqHead;
+    unsigned *cqTail;
+    unsigned *cqMask;
+    struct io_uring_cqe *cqes;
+    struct io_uring_sqe *sqes;
+    void *sqRing;
+    size_t sqRingSize;
+    void *cqRing;
+    size_t cqRingSize;
+    size_t sqesSize;
+    unsigned pending;
+    struct iovec *iovecs;
+} Result_IOBatchUring;
+#endif
+
+struct ResultIOBatch {
+    size_t depth;
+    bool uring;
+#ifdef RESULT_IO_BATCH_URING
+    Result_IOBatchUring ring;
+#endif
+    size_t freeSize;
+    size_t *free;
+    Result_IOBatchSlot *slots;
+};
+
+static Result Result_ioBatchComplete(const ResultIOBatch_Request *request, Result result)
+__attribute__((__warn_unused_result__, __nonnull__));
+
+static Result Result_ioBatchTransfer(const ResultIOBatch_Request *request)
+__attribute__((__warn_unused_result__, __nonnull__));
+
+static void Result_ioBatchRunFallback(size_t size, const ResultIOBatch_Request *requests, Result *results)
+__attribute__((__nonnull__));
+
+#ifdef RESULT_IO_BATCH_URING
+static bool Result_ioBatchUringSetup(Result_IOBatchUring *ring, size_t depth)
+__attribute__((__warn_unused_result__, __nonnull__));
+
+static void Result_ioBatchUringTeardown(Result_IOBatchUring *ring)
+__attribute__((__nonnull__));
+
+static void Result_ioBatchUringPrepare(ResultIOBatch self, const ResultIOBatch_Request *requests, size_t slot)
+__attribute__((__nonnull__));
+
+static void Result_ioBatchUringEnter(Result_IOBatchUring *ring)
+__attribute__((__nonnull__));
+
+static void Result_ioBatchRunUring(ResultIOBatch self, size_t size, const ResultIOBatch_Request *requests, Result *results)
+__attribute__((__nonnull__));
+#endif
+
+ResultIOBatch_Request
+ResultIOBatch_read(const int fd, void *const buffer, const size_t size, const off_t offset,
+                   Result (*const continuation)(const void *)) {
+    Panic_when(NULL == buffer);
+    return (ResultIOBatch_Request) {
+            .__write=0, .__fd=fd, .__buffer=buffer, .__size=size, .__offset=offset, .__continuation=continuation
+    };
+}
+
+ResultIOBatch_Request
+ResultIOBatch_write(const int fd, const void *const buffer, const size_t size, const off_t offset,
+                    Result (*const continuation)(const void *)) {
+    Panic_when(NULL == buffer);
+    return (ResultIOBatch_Request) {
+            .__write=1, .__fd=fd, .__buffer=(void *) buffer, .__size=size, .__offset=offset,
+            .__continuation=continuation
+    };
+}
+
+ResultIOBatch ResultIOBatch_new(const size_t depth, const ResultIOBatch_Backend backend) {
+    Panic_when(0 == depth);
+    Panic_unless(ResultIOBatch_Auto == backend || ResultIOBatch_Fallback == backend);
+    ResultIOBatch self = calloc(1, sizeof(*self));
+    Panic_when(NULL == self);
+    self->depth = depth;
+#ifdef RESULT_IO_BATCH_URING
+    if (ResultIOBatch_Auto == backend && Result_ioBatchUringSetup(&self->ring, depth)) {
+        self->uring = true;
+        self->free = malloc(depth * sizeof(self->free[0]));
+        self->slots = malloc(depth * sizeof(self->slots[0]));
+        self->ring.iovecs = malloc(depth * sizeof(self->ring.iovecs[0]));
+        Panic_when(NULL == self->free || NULL == self->slots || NULL == self->ring.iovecs);
+    }
+#else
+    (void) backend;
+#endif
+    return self;
+}
+
+bool ResultIOBatch_isUring(ResultIOBatch self) {
+    assert(NULL != self);
+    return self->uring;
+}
+
+void ResultIOBatch_run(ResultIOBatch self, const size_t size, const ResultIOBatch_Request *const requests,
+                       Result *const results) {
+    assert(NULL != self);
+    Panic_when(NULL == requests);
+    Panic_when(NULL == results);
+#ifdef RESULT_IO_BATCH_URING
+    if (self->uring) {
+        Result_ioBatchRunUring(self, size, requests, results);
+        return;
+    }
+#endif
+    Result_ioBatchRunFallback(size, requests, results);
+}
+
+void ResultIOBatch_delete(ResultIOBatch self) {
+    assert(NULL != self);
+#ifdef RESULT_IO_BATCH_URING
+    if (self->uring) {
+        Result_ioBatchUringTeardown(&self->ring);
+        free(self->ring.iovecs);
+    }
+#endif
+    free(self->slots);
+    free(self->free);
+    free(self);
+}
+
+Result Result_ioBatchComplete(const ResultIOBatch_Request *const request, const Result result) {
+    assert(NULL != request);
+    return (NULL == request->__continuation) ? result : Result_chain(result, request->__continuation);
+}
+
+Result Result_ioBatchTransfer(const ResultIOBatch_Request *const request) {
+    assert(NULL != request);
+    char *const buffer = request->__buffer;
+    size_t done = 0, retries = 0;
+    while (done < request->__size) {
+        const ssize_t transferred = request->__write ?
+                pwrite(request->__fd, buffer + done, request->__size - done, request->__offset + (off_t) done) :
+                pread(request->__fd, buffer + done, request->__size - done, request->__offset + (off_t) done);
+        if (transferred > 0) {
+            done += (size_t) transferred;
+            retries = 0;
+        } else if (0 == transferred) {
+            // the end of file for reads, a write making no progress would loop forever
+            if (request->__write) {
+                return ResultIO_error(EIO);
+            }
+            break;
+        } else if ((EINTR != errno && EAGAIN != errno) || ++retries > RESULT_IO_BATCH_RETRIES) {
+            return ResultIO_error(errno);
+        }
+    }
+    return Result_ok(buffer + done);
+}
+
+void Result_ioBatchRunFallback(const size_t size, const ResultIOBatch_Request *const requests, Result *const results) {
+    assert(NULL != requests);
+    assert(NULL != results);
+    for (size_t i = 0; i < size; i++) {
+        results[i] = Result_ioBatchComplete(&requests[i], Result_ioBatchTransfer(&requests[i]));
+    }
+}
+
+#ifdef RESULT_IO_BATCH_URING
+
+bool Result_ioBatchUringSetup(Result_IOBatchUring *const ring, const size_t depth) {
+    assert(NULL != ring);
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    if (depth > UINT32_MAX) {
+        return false;
+    }
+    const long fd = syscall(__NR_io_uring_setup, (unsigned) depth, &params);
+    if (fd < 0) {
+        // not built in, disabled by sysctl or forbidden by seccomp
+        return false;
+    }
+
+    ring->fd = (int) fd;
+    ring->sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    ring->cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    ring->sqesSize = params.sq_entries * sizeof(struct io_uring_sqe);
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+        ring->sqRingSize = ring->cqRingSize = (ring->sqRingSize > ring->cqRingSize) ? ring->sqRingSize : ring->cqRingSize;
+    }
+
+    ring->sqRing = mmap(NULL, ring->sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd,
+                        IORING_OFF_SQ_RING);
+    ring->cqRing = (params.features & IORING_FEAT_SINGLE_MMAP) ? ring->sqRing :
+                   mmap(NULL, ring->cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd,
+                        IORING_OFF_CQ_RING);
+    ring->sqes = mmap(NULL, ring->sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd,
+                      IORING_OFF_SQES);
+    if (MAP_FAILED == ring->sqRing || MAP_FAILED == ring->cqRing || MAP_FAILED == ring->sqes) {
+        if (MAP_FAILED != ring->sqes) {
+            munmap(ring->sqes, ring->sqesSize);
+        }
+        if (MAP_FAILED != ring->cqRing && ring->cqRing != ring->sqRing) {
+            munmap(ring->cqRing, ring->cqRingSize);
+        }
+        if (MAP_FAILED != ring->sqRing) {
+            munmap(ring->sqRing, ring->sqRingSize);
+        }
+        close(ring->fd);
+        return false;
+    }
+
+    char *const sq = ring->sqRing;
+    char *const cq = ring->cqRing;
+    ring->sqHead = (unsigned *) (sq + params.sq_off.head);
+    ring->sqTail = (unsigned *) (sq + params.sq_off.tail);
+    ring->sqMask = (unsigned *) (sq + params.sq_off.ring_mask);
+    ring->sqArray = (unsigned *) (sq + params.sq_off.array);
+    ring->cqHead = (unsigned *) (cq + params.cq_off.head);
+    ring->cqTail = (unsigned *) (cq + params.cq_off.tail);
+    ring->cqMask = (unsigned *) (cq + params.cq_off.ring_mask);
+    ring->cqes = (struct io_uring_cqe *) (cq + params.cq_off.cqes);
+    ring->pending = 0;
+    return true;
+}
+
+void Result_ioBatchUringTeardown(Result_IOBatchUring *const ring) {
+    assert(NULL != ring);
+    munmap(ring->sqes, ring->sqesSize);
+    if (ring->cqRing != ring->sqRing) {
+        munmap(ring->cqRing, ring->cqRingSize);
+    }
+    munmap(ring->sqRing, ring->sqRingSize);
+    close(ring->fd);
+}
+
+void Result_ioBatchUringPrepare(ResultIOBatch self, const ResultIOBatch_Request *const requests, const size_t slot) {
+    assert(NULL != self);
+    assert(NULL != requests);
+    Result_IOBatchUring *const ring = &self->ring;
+    const ResultIOBatch_Request *const request = &requests[self->slots[slot].request];
+    const size_t done = self->slots[slot].done;
+
+    // the slot owns the entry with its same index, it is free once the previous submission has been consumed
+    struct io_uring_sqe *const sqe = &ring->sqes[slot];
+    memset(sqe, 0, sizeof(*sqe));
+    ring->iovecs[slot] = (struct iovec) {.iov_base=(char *) request->__buffer + done, .iov_len=request->__size - done};
+    sqe->opcode = request->__write ? IORING_OP_WRITEV : IORING_OP_READV;
+    sqe->fd = request->__fd;
+    sqe->off = (uint64_t) (request->__offset + (off_t) done);
+    sqe->addr = (uint64_t) (uintptr_t) &ring->iovecs[slot];
+    sqe->len = 1;
+    sqe->user_data = slot;
+
+    const unsigned tail = *ring->sqTail;
+    ring->sqArray[tail & *ring->sqMask] = (unsigned) slot;
+    __atomic_store_n(ring->sqTail, tail + 1, __ATOMIC_RELEASE);
+    ring->pending += 1;
+}
+
+void Result_ioBatchUringEnter(Result_IOBatchUring *const ring) {
+    assert(NULL != ring);
+    for (;;) {
+        const long submitted = syscall(__NR_io_uring_enter, ring->fd, ring->pending, 1, IORING_ENTER_GETEVENTS, NULL, 0);
+        if (submitted >= 0) {
+            ring->pending -= (unsigned) submitted;
+            if (0 == ring->pending) {
+                return;
+            }
+        } else {
+            Panic_unless(EINTR == errno || EAGAIN == errno || EBUSY == errno);
+        }
+    }
+}
+
+void Result_ioBatchRunUring(ResultIOBatch self, const size_t size, const ResultIOBatch_Request *const requests,
+                            Result *const results) {
+    assert(NULL != self);
+    assert(NULL != requests);
+    assert(NULL != results);
+    Result_IOBatchUring *const ring = &self->ring;
+    size_t next = 0, inFlight = 0;
+
+    self->freeSize = self->depth;
+    for (size_t i = 0; i < self->depth; i++) {
+        self->free[i] = self->depth - 1 - i;
+    }
+
+    while (next < size || inFlight > 0) {
+        for (; next < size && self->freeSize > 0; next++) {
+            if (0 == requests[next].__size) {
+                results[next] = Result_ioBatchComplete(&requests[next], Result_ok(requests[next].__buffer));
+                continue;
+            }
+            const size_t slot = self->free[--self->freeSize];
+            self->slots[slot] = (Result_IOBatchSlot) {.request=next, .done=0, .retries=0};
+            Result_ioBatchUringPrepare(self, requests, slot);
+            inFlight += 1;
+        }
+        if (0 == inFlight) {
+            break;
+        }
+
+        Result_ioBatchUringEnter(ring);
+
+        const unsigned tail = __atomic_load_n(ring->cqTail, __ATOMIC_ACQUIRE);
+        unsigned head = *ring->cqHead;
+        for (; head != tail; head++) {
+            const struct io_uring_cqe *const cqe = &ring->cqes[head & *ring->cqMask];
+            const size_t slot = (size_t) cqe->user_data;
+            const int transferred = cqe->res;
+            Result_IOBatchSlot *const current = &self->slots[slot];
+            const ResultIOBatch_Request *const request = &requests[current->request];
+
+            if (transferred < 0 && ((-EINTR != transferred && -EAGAIN != transferred) ||
+                                    ++current->retries > RESULT_IO_BATCH_RETRIES)) {
+                results[current->request] = Result_ioBatchComplete(request, ResultIO_error(-transferred));
+            } else if (0 == transferred && request->__write) {
+                // a write making no progress would be resubmitted forever
+                results[current->request] = Result_ioBatchComplete(request, ResultIO_error(EIO));
+            } else {
+                if (transferred > 0) {
+                    current->done += (size_t) transferred;
+                    current->retries = 0;
+                }
+                if (current->done < request->__size && 0 != transferred) {
+                    // short transfer, resubmit the rest from the same slot
+                    Result_ioBatchUringPrepare(self, requests, slot);
+                    continue;
+                }
+                results[current->request] =
+                        Result_ioBatchComplete(request, Result_ok((char *) request->__buffer + current->done));
+            }
+            self->free[self->freeSize++] = slot;
+            inFlight -= 1;
+        }
+        __atomic_store_n(ring->cqHead, head, __ATOMIC_RELEASE);
+    }
+}
+
+#endif
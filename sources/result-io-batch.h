@@ -0,0 +1,142 @@
+/*
+Author: daddinuz
+email:  daddinuz@gmail.com
+
+Copyright (c) 2018 Davide Di Carlo
+
+Permission is hereby granted, free of charge, to any person
+obtaining a copy of this software and associated documentation
+files (the "Software"), to deal in the Software without
+restriction, including without limitation the rights to use,
+copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be
+included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <sys/types.h>
+#include "result.h"
+
+#if !(defined(__GNUC__) || defined(__clang__))
+__attribute__(...)
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Batches of positional reads and writes, issued through io_uring when the kernel provides it and through plain
+ * `pread`/`pwrite` otherwise.
+ * Each request yields its own `Result`: on success it wraps a pointer one past the last byte transferred, on failure it
+ * is a `SystemError` carrying the `errno` (see `ResultIO_errno(...)`).
+ */
+
+/**
+ * The backend used to issue the requests.
+ */
+typedef enum {
+    /** io_uring if available, the fallback otherwise */
+    ResultIOBatch_Auto,
+    /** plain pread/pwrite calls */
+    ResultIOBatch_Fallback,
+} ResultIOBatch_Backend;
+
+/**
+ * A single read or write request.
+ *
+ * @attention this struct must be treated as opaque therefore its members must not be accessed directly.
+ */
+typedef struct {
+    int __write;
+    int __fd;
+    void *__buffer;
+    size_t __size;
+    off_t __offset;
+    Result (*__continuation)(const void *);
+} ResultIOBatch_Request;
+
+/**
+ * An engine issuing batches of requests.
+ */
+typedef struct ResultIOBatch *ResultIOBatch;
+
+/**
+ * Creates a read request of `size` bytes at `offset` of `fd` into `buffer`, reads stop early at the end of file.
+ * If `continuation` is not `NULL` it is chained to the `Result` of the request as soon as it completes, as `Result_chain`
+ * would do.
+ *
+ * @attention buffer must not be `NULL`.
+ */
+extern ResultIOBatch_Request
+ResultIOBatch_read(int fd, void *buffer, size_t size, off_t offset, Result (*continuation)(const void *))
+__attribute__((__warn_unused_result__));
+
+/**
+ * Creates a write request of `size` bytes from `buffer` at `offset` of `fd`, resuming after partial writes.
+ * A write transferring nothing fails with `EIO`.
+ * If `continuation` is not `NULL` it is chained to the `Result` of the request as soon as it completes, as `Result_chain`
+ * would do.
+ *
+ * @attention buffer must not be `NULL`.
+ */
+extern ResultIOBatch_Request
+ResultIOBatch_write(int fd, const void *buffer, size_t size, off_t offset, Result (*continuation)(const void *))
+__attribute__((__warn_unused_result__));
+
+/**
+ * Creates an engine keeping at most `depth` requests in flight.
+ * With `ResultIOBatch_Auto` an io_uring is set up, falling back silently if the kernel refuses to.
+ *
+ * @attention depth must be greater than 0.
+ * @attention the engine is meant to be used by one thread at a time.
+ */
+extern ResultIOBatch ResultIOBatch_new(size_t depth, ResultIOBatch_Backend backend)
+__attribute__((__warn_unused_result__));
+
+/**
+ * Tells whether this engine issues its requests through io_uring.
+ *
+ * @attention self must not be `NULL`.
+ */
+extern bool ResultIOBatch_isUring(ResultIOBatch self)
+__attribute__((__warn_unused_result__, __nonnull__));
+
+/**
+ * Issues all the `size` requests, storing the `Result` of the i-th request in `results[i]`.
+ * Requests are not ordered with respect to each other, continuations run in completion order on the calling thread.
+ * Requests interrupted by `EINTR` or `EAGAIN` are retried a bounded number of times in a row, then fail with that error.
+ *
+ * @attention self must not be `NULL`.
+ * @attention requests must not be `NULL`.
+ * @attention results must not be `NULL`.
+ */
+extern void ResultIOBatch_run(ResultIOBatch self, size_t size, const ResultIOBatch_Request *requests, Result *results)
+__attribute__((__nonnull__(1)));
+
+/**
+ * Releases the engine.
+ *
+ * @attention self must not be `NULL`.
+ */
+extern void ResultIOBatch_delete(ResultIOBatch self)
+__attribute__((__nonnull__));
+
+#ifdef __cplusplus
+}
+#endif
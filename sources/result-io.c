@@ -0,0 +1,165 @@
+/*
+ * Author: daddinuz
+ * email:  daddinuz@gmail.com
+ *
+ * Copyright (c) 2018 Davide Di Carlo
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <assert.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <panic/panic.h>
+#include "result-io.h"
+
+/*
+ * Buffers handed to a single writev call, further ones cost one more call each.
+ */
+#define RESULT_IO_WINDOW    64
+
+#ifndef MAP_POPULATE
+#define MAP_POPULATE        0
+#endif
+
+Result ResultIO_error(const int errnum) {
+    // errors never expose their value, it is free to carry the errno
+    return (Result) {.__error=SystemError, .__value=(const void *) (intptr_t) errnum};
+}
+
+int ResultIO_errno(const Result self) {
+    return (SystemError == self.__error) ? (int) (intptr_t) self.__value : 0;
+}
+
+Result ResultIO_mapFile(const char *const path, const ResultIO_Advice advice, ResultIO_Mapping *const mapping) {
+    Panic_when(NULL == path);
+    Panic_when(NULL == mapping);
+    struct stat status;
+    int fd;
+    while ((fd = open(path, O_RDONLY | O_CLOEXEC)) < 0) {
+        if (EINTR != errno) {
+            return ResultIO_error(errno);
+        }
+    }
+    if (fstat(fd, &status) < 0) {
+        const int errnum = errno;
+        close(fd);
+        return ResultIO_error(errnum);
+    }
+
+    mapping->__data = NULL;
+    mapping->__size = (size_t) status.st_size;
+    if (mapping->__size > 0) {
+        void *data = mmap(NULL, mapping->__size, PROT_READ, MAP_PRIVATE | MAP_POPULATE, fd, 0);
+        if (MAP_FAILED == data) {
+            const int errnum = errno;
+            close(fd);
+            return ResultIO_error(errnum);
+        }
+        // just a hint, failing to give it is not an error
+        const int hints[] = {[ResultIO_Normal]=MADV_NORMAL, [ResultIO_Sequential]=MADV_SEQUENTIAL,
+                             [ResultIO_Random]=MADV_RANDOM};
+        if (advice >= ResultIO_Normal && advice <= ResultIO_Random) {
+            madvise(data, mapping->__size, hints[advice]);
+        }
+        mapping->__data = data;
+    }
+    // the mapping holds its own reference to the file
+    close(fd);
+    return Result_ok(mapping);
+}
+
+const void *ResultIO_mappingData(const ResultIO_Mapping *const self) {
+    assert(NULL != self);
+    return self->__data;
+}
+
+size_t ResultIO_mappingSize(const ResultIO_Mapping *const self) {
+    assert(NULL != self);
+    return self->__size;
+}
+
+void ResultIO_unmap(ResultIO_Mapping *const self) {
+    assert(NULL != self);
+    if (NULL != self->__data) {
+        munmap((void *) self->__data, self->__size);
+    }
+    self->__data = NULL;
+    self->__size = 0;
+}
+
+Result ResultIO_readInto(const int fd, void *const buffer, const size_t size) {
+    Panic_when(NULL == buffer);
+    unsigned char *cursor = buffer;
+    const unsigned char *end = cursor + size;
+    while (cursor < end) {
+        const ssize_t bytes = read(fd, cursor, (size_t) (end - cursor));
+        if (bytes > 0) {
+            cursor += bytes;
+        } else if (0 == bytes) {
+            break;
+        } else if (EINTR != errno) {
+            return ResultIO_error(errno);
+        }
+    }
+    return Result_ok(cursor);
+}
+
+Result ResultIO_writev(const int fd, const struct iovec *const iov, const size_t count) {
+    Panic_when(NULL == iov);
+    size_t index = 0, offset = 0;
+    while (index < count) {
+        // resume from where the last write stopped, without touching the caller's vector
+        struct iovec window[RESULT_IO_WINDOW];
+        size_t size = 0, bytes = 0;
+        for (size_t i = index; i < count && size < RESULT_IO_WINDOW; i++, size++) {
+            window[size] = iov[i];
+            bytes += iov[i].iov_len;
+        }
+        window[0].iov_base = (unsigned char *) window[0].iov_base + offset;
+        window[0].iov_len -= offset;
+        bytes -= offset;
+
+        ssize_t written = writev(fd, window, (int) size);
+        if (written < 0) {
+            if (EINTR == errno) {
+                continue;
+            }
+            return ResultIO_error(errno);
+        }
+        if (0 == written && bytes > 0) {
+            // no progress, trying again would spin forever
+            return ResultIO_error(EIO);
+        }
+        for (size_t remaining; index < count && (size_t) written >= (remaining = iov[index].iov_len - offset);) {
+            written -= (ssize_t) remaining;
+            offset = 0;
+            index++;
+        }
+        offset += (size_t) written;
+    }
+    return Result_ok(iov);
+}
@@ -0,0 +1,133 @@
+/*
+Author: daddinuz
+email:  daddinuz@gmail.com
+
+Copyright (c) 2018 Davide Di Carlo
+
+Permission is hereby granted, free of charge, to any person
+obtaining a copy of this software and associated documentation
+files (the "Software"), to deal in the Software without
+restriction, including without limitation the rights to use,
+copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be
+included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <sys/uio.h>
+#include "result.h"
+
+#if !(defined(__GNUC__) || defined(__clang__))
+__attribute__(...)
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * File I/O returning `Result`s.
+ * Failures are reported as `SystemError` results carrying the `errno` of the failing call, no memory is allocated to
+ * do so: the error kind stays `SystemError` and `ResultIO_errno(...)` tells the cause.
+ */
+
+/**
+ * A read-only memory mapping of a whole file.
+ *
+ * @attention this struct must be treated as opaque therefore its members must not be accessed directly.
+ */
+typedef struct {
+    const void *__data;
+    size_t __size;
+} ResultIO_Mapping;
+
+/**
+ * How a mapping is going to be accessed, passed to the kernel as a hint.
+ */
+typedef enum {
+    ResultIO_Normal,
+    ResultIO_Sequential,
+    ResultIO_Random,
+} ResultIO_Advice;
+
+/**
+ * Creates a `SystemError` result carrying `errnum`.
+ */
+extern Result ResultIO_error(int errnum)
+__attribute__((__warn_unused_result__));
+
+/**
+ * Returns the `errno` carried by this `Result`, 0 if it's an `Ok` variant or an error not coming from this module.
+ */
+extern int ResultIO_errno(Result self)
+__attribute__((__warn_unused_result__));
+
+/**
+ * Maps the whole file at `path` into memory, prefaulting its pages.
+ * Returns a `Result` wrapping `mapping`, that must be released with `ResultIO_unmap(...)`.
+ *
+ * @attention path must not be `NULL`.
+ * @attention mapping must not be `NULL`.
+ */
+extern Result ResultIO_mapFile(const char *path, ResultIO_Advice advice, ResultIO_Mapping *mapping)
+__attribute__((__warn_unused_result__));
+
+/**
+ * Returns the first byte of the mapping, `NULL` if the file is empty.
+ *
+ * @attention self must not be `NULL`.
+ */
+extern const void *ResultIO_mappingData(const ResultIO_Mapping *self)
+__attribute__((__warn_unused_result__, __nonnull__));
+
+/**
+ * Returns the size of the mapping in bytes.
+ *
+ * @attention self must not be `NULL`.
+ */
+extern size_t ResultIO_mappingSize(const ResultIO_Mapping *self)
+__attribute__((__warn_unused_result__, __nonnull__));
+
+/**
+ * Releases the mapping.
+ *
+ * @attention self must not be `NULL`.
+ */
+extern void ResultIO_unmap(ResultIO_Mapping *self)
+__attribute__((__nonnull__));
+
+/**
+ * Reads from `fd` into `buffer` until `size` bytes have been read or the end of file is reached.
+ * Returns a `Result` wrapping a pointer one past the last byte read.
+ *
+ * @attention buffer must not be `NULL`.
+ */
+extern Result ResultIO_readInto(int fd, void *buffer, size_t size)
+__attribute__((__warn_unused_result__));
+
+/**
+ * Writes all the `count` buffers described by `iov` to `fd`, resuming after partial writes.
+ * Returns a `Result` wrapping `iov`, which is left untouched; a write making no progress fails with `EIO`.
+ *
+ * @attention iov must not be `NULL`.
+ */
+extern Result ResultIO_writev(int fd, const struct iovec *iov, size_t count)
+__attribute__((__warn_unused_result__));
+
+#ifdef __cplusplus
+}
+#endif
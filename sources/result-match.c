@@ -0,0 +1,81 @@
+/*
+ * Author: daddinuz
+ * email:  daddinuz@gmail.com
+ *
+ * Copyright (c) 2018 Davide Di Carlo
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <stdlib.h>
+#include <assert.h>
+#include <panic/panic.h>
+#include "result-match.h"
+
+struct ResultMatch {
+    Result (*otherwise)(Result, void *);
+    size_t size;
+    Result (*arms[])(Result, void *);
+};
+
+ResultMatch_Arm ResultMatch_on(Error error, Result (*const f)(Result, void *)) {
+    return (ResultMatch_Arm) {.__error=error, .__f=f};
+}
+
+ResultMatch ResultMatch_new(Result (*const otherwise)(Result, void *), const size_t size,
+                            const ResultMatch_Arm *const arms) {
+    Panic_when(NULL == otherwise);
+    Panic_when(NULL == arms && size > 0);
+    size_t tableSize = 0;
+    for (size_t i = 0; i < size; i++) {
+        Panic_when(NULL == arms[i].__error || NULL == arms[i].__f);
+        for (size_t j = 0; j < i; j++) {
+            Panic_when(arms[i].__error == arms[j].__error);
+        }
+        const size_t index = Error_index(arms[i].__error);
+        tableSize = (index >= tableSize) ? index + 1 : tableSize;
+    }
+
+    ResultMatch self = calloc(1, sizeof(*self) + tableSize * sizeof(self->arms[0]));
+    Panic_when(NULL == self);
+    self->otherwise = otherwise;
+    self->size = tableSize;
+    for (size_t i = 0; i < size; i++) {
+        self->arms[Error_index(arms[i].__error)] = arms[i].__f;
+    }
+    // holes fall back to the default arm so dispatching never needs to check
+    for (size_t i = 0; i < tableSize; i++) {
+        self->arms[i] = (NULL == self->arms[i]) ? otherwise : self->arms[i];
+    }
+    return self;
+}
+
+Result Result_match(const Result self, ResultMatch match, void *const context) {
+    Panic_when(NULL == match);
+    const size_t index = Error_index(Result_inspect(self));
+    return ((index < match->size) ? match->arms[index] : match->otherwise)(self, context);
+}
+
+void ResultMatch_delete(ResultMatch self) {
+    assert(NULL != self);
+    free(self);
+}
@@ -0,0 +1,98 @@
+/*
+Author: daddinuz
+email:  daddinuz@gmail.com
+
+Copyright (c) 2018 Davide Di Carlo
+
+Permission is hereby granted, free of charge, to any person
+obtaining a copy of this software and associated documentation
+files (the "Software"), to deal in the Software without
+restriction, including without limitation the rights to use,
+copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be
+included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include "result.h"
+
+#if !(defined(__GNUC__) || defined(__clang__))
+__attribute__(...)
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * A jump table from errors to handlers, indexed by `Error_index(...)`: dispatching a `Result` costs the same whatever
+ * the number of arms.
+ *
+ * @attention this struct must be treated as opaque therefore its members must not be accessed directly.
+ */
+typedef struct ResultMatch *ResultMatch;
+
+/**
+ * @attention this struct must be treated as opaque therefore its members must not be accessed directly.
+ */
+typedef struct {
+    Error __error;
+    Result (*__f)(Result, void *);
+} ResultMatch_Arm;
+
+/**
+ * An arm handling results wrapping `error`, `Ok` may be used to handle values.
+ */
+extern ResultMatch_Arm ResultMatch_on(Error error, Result f(Result, void *))
+__attribute__((__warn_unused_result__));
+
+/**
+ * Creates a jump table from the given arms, results not handled by any arm are handled by `otherwise`.
+ *
+ * @attention otherwise must not be `NULL`.
+ * @attention arms must not be `NULL` unless size is 0.
+ * @attention every arm error and function must not be `NULL`, errors must not be repeated.
+ */
+extern ResultMatch ResultMatch_new(Result otherwise(Result, void *), size_t size, const ResultMatch_Arm *arms)
+__attribute__((__warn_unused_result__));
+
+/**
+ * Creates a jump table from the arms passed as arguments.
+ */
+#define ResultMatch_of(otherwise, ...) \
+    ResultMatch_new((otherwise), sizeof((ResultMatch_Arm[]) {__VA_ARGS__}) / sizeof(ResultMatch_Arm), \
+                    (ResultMatch_Arm[]) {__VA_ARGS__})
+
+/**
+ * Calls the handler for the error of this `Result` with this `Result` and `context`, returning its outcome.
+ *
+ * @attention match must not be `NULL`.
+ */
+extern Result Result_match(Result self, ResultMatch match, void *context)
+__attribute__((__warn_unused_result__));
+
+/**
+ * Releases the jump table.
+ *
+ * @attention self must not be `NULL`.
+ */
+extern void ResultMatch_delete(ResultMatch self)
+__attribute__((__nonnull__));
+
+#ifdef __cplusplus
+}
+#endif
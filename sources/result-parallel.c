@@ -0,0 +1,275 @@
+/*
+ * Author: daddinuz
+ * email:  daddinuz@gmail.com
+ *
+ * Copyright (c) 2018 Davide Di Carlo
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <stdlib.h>
+#include <assert.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <panic/panic.h>
+#include "result-parallel.h"
+
+/*
+ * Number of elements taken at once by the owner of a range, also the smallest range worth stealing.
+ */
+#define RESULT_PARALLEL_GRAIN       256
+
+#define RESULT_PARALLEL_CACHE_LINE  64
+
+typedef enum {
+    Result_ParallelMap,
+    Result_ParallelChain,
+} Result_ParallelKind;
+
+/*
+ * Stands in for a per-worker deque: the tasks of a flat array are its indices, so a deque of them is just the pending
+ * interval, popping a grain and stealing half are both O(1) and no task is ever allocated.
+ */
+typedef struct {
+    bool lock;
+    size_t begin;
+    size_t end;
+} __attribute__((__aligned__(RESULT_PARALLEL_CACHE_LINE))) Result_ParallelRange;
+
+typedef struct {
+    const Result *inputs;
+    Result *outputs;
+    Result_ParallelKind kind;
+    union {
+        const void *(*map)(const void *);
+        Result (*chain)(const void *);
+    } f;
+    const ResultCancel *cancel;
+    bool stopOnError;
+    bool cancelled;
+    Result error;
+    size_t rangesSize;
+    Result_ParallelRange *ranges;
+} Result_ParallelJob;
+
+typedef struct {
+    Result_ParallelJob *job;
+    size_t index;
+} Result_ParallelWorker;
+
+static Result Result_parallelRun(Result_ParallelJob *job, size_t size, size_t workers)
+__attribute__((__warn_unused_result__, __nonnull__));
+
+static void *Result_parallelWork(void *worker)
+__attribute__((__nonnull__));
+
+static bool Result_parallelTake(Result_ParallelRange *range, size_t *begin, size_t *end)
+__attribute__((__nonnull__));
+
+static bool Result_parallelSteal(Result_ParallelJob *job, size_t thief)
+__attribute__((__nonnull__));
+
+void Result_parallelMap(const Result *const inputs, Result *const outputs, const size_t size,
+                        const void *(*const f)(const void *), const size_t workers) {
+    Panic_when(NULL == f);
+    Result_ParallelJob job = {.inputs=inputs, .outputs=outputs, .kind=Result_ParallelMap, .f.map=f};
+    const Result _ = Result_parallelRun(&job, size, workers);
+    (void) _;
+}
+
+void Result_parallelChain(const Result *const inputs, Result *const outputs, const size_t size,
+                          Result (*const f)(const void *), const size_t workers) {
+    Panic_when(NULL == f);
+    Result_ParallelJob job = {.inputs=inputs, .outputs=outputs, .kind=Result_ParallelChain, .f.chain=f};
+    const Result _ = Result_parallelRun(&job, size, workers);
+    (void) _;
+}
+
+Result Result_parallelTryAll(const Result *const inputs, Result *const outputs, const size_t size,
+                             Result (*const f)(const void *), const size_t workers) {
+    Panic_when(NULL == f);
+    Result_ParallelJob job = {
+            .inputs=inputs, .outputs=outputs, .kind=Result_ParallelChain, .f.chain=f, .stopOnError=true
+    };
+    return Result_parallelRun(&job, size, workers);
+}
+
+void Result_parallelMapCancellable(const Result *const inputs, Result *const outputs, const size_t size,
+                                   const void *(*const f)(const void *), const size_t workers,
+                                   const ResultCancel *const cancel) {
+    Panic_when(NULL == f);
+    Panic_when(NULL == cancel);
+    Result_ParallelJob job = {.inputs=inputs, .outputs=outputs, .kind=Result_ParallelMap, .f.map=f, .cancel=cancel};
+    const Result _ = Result_parallelRun(&job, size, workers);
+    (void) _;
+}
+
+void Result_parallelChainCancellable(const Result *const inputs, Result *const outputs, const size_t size,
+                                     Result (*const f)(const void *), const size_t workers,
+                                     const ResultCancel *const cancel) {
+    Panic_when(NULL == f);
+    Panic_when(NULL == cancel);
+    Result_ParallelJob job = {
+            .inputs=inputs, .outputs=outputs, .kind=Result_ParallelChain, .f.chain=f, .cancel=cancel
+    };
+    const Result _ = Result_parallelRun(&job, size, workers);
+    (void) _;
+}
+
+Result Result_parallelTryAllCancellable(const Result *const inputs, Result *const outputs, const size_t size,
+                                        Result (*const f)(const void *), const size_t workers,
+                                        const ResultCancel *const cancel) {
+    Panic_when(NULL == f);
+    Panic_when(NULL == cancel);
+    Result_ParallelJob job = {
+            .inputs=inputs, .outputs=outputs, .kind=Result_ParallelChain, .f.chain=f, .cancel=cancel,
+            .stopOnError=true
+    };
+    return Result_parallelRun(&job, size, workers);
+}
+
+Result Result_parallelRun(Result_ParallelJob *const job, const size_t size, size_t workers) {
+    assert(NULL != job);
+    Panic_when(NULL == job->inputs || NULL == job->outputs);
+    if (0 == workers) {
+        const long processors = sysconf(_SC_NPROCESSORS_ONLN);
+        workers = (processors > 0) ? (size_t) processors : 1;
+    }
+    // there's no point in having workers that can't get at least a grain each
+    const size_t grains = (size + RESULT_PARALLEL_GRAIN - 1) / RESULT_PARALLEL_GRAIN;
+    workers = (workers < grains) ? workers : (grains > 0 ? grains : 1);
+
+    Result_ParallelRange *ranges = NULL;
+    Panic_unless(0 == posix_memalign((void **) &ranges, RESULT_PARALLEL_CACHE_LINE, workers * sizeof(*ranges)));
+    Result_ParallelWorker *arguments = malloc(workers * sizeof(*arguments));
+    pthread_t *threads = malloc(workers * sizeof(*threads));
+    Panic_when(NULL == arguments || NULL == threads);
+
+    job->ranges = ranges;
+    job->rangesSize = workers;
+    job->cancelled = false;
+    for (size_t i = 0; i < workers; i++) {
+        ranges[i].lock = false;
+        ranges[i].begin = size * i / workers;
+        ranges[i].end = size * (i + 1) / workers;
+        arguments[i].job = job;
+        arguments[i].index = i;
+    }
+
+    // the calling thread is worker 0
+    for (size_t i = 1; i < workers; i++) {
+        Panic_unless(0 == pthread_create(&threads[i], NULL, Result_parallelWork, &arguments[i]));
+    }
+    Result_parallelWork(&arguments[0]);
+    for (size_t i = 1; i < workers; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    free(threads);
+    free(arguments);
+    free(ranges);
+    return job->cancelled ? job->error : Result_ok(job->outputs);
+}
+
+void *Result_parallelWork(void *const worker) {
+    assert(NULL != worker);
+    const Result_ParallelWorker *self = worker;
+    Result_ParallelJob *job = self->job;
+    Result_ParallelRange *range = &job->ranges[self->index];
+    size_t begin, end;
+
+    do {
+        while (Result_parallelTake(range, &begin, &end)) {
+            for (size_t i = begin; i < end; i++) {
+                if (job->stopOnError && __atomic_load_n(&job->cancelled, __ATOMIC_RELAXED)) {
+                    return NULL;
+                }
+                const Result input = job->inputs[i];
+                // once cancelled Ok inputs become Cancelled, which also stops the workers of a tryAll
+                const Result result = (NULL != job->cancel && Result_isOk(input) &&
+                                       ResultCancel_isCancelled(job->cancel))
+                                      ? Result_error(Cancelled)
+                                      : (Result_ParallelMap == job->kind)
+                                        ? Result_map(input, job->f.map)
+                                        : Result_chain(input, job->f.chain);
+                job->outputs[i] = result;
+                if (job->stopOnError && Result_isError(result)) {
+                    if (!__atomic_exchange_n(&job->cancelled, true, __ATOMIC_ACQ_REL)) {
+                        job->error = result;
+                    }
+                    return NULL;
+                }
+            }
+        }
+    } while (Result_parallelSteal(job, self->index));
+    return NULL;
+}
+
+static void Result_parallelLock(Result_ParallelRange *const range) {
+    while (__atomic_test_and_set(&range->lock, __ATOMIC_ACQUIRE)) {
+        while (__atomic_load_n(&range->lock, __ATOMIC_RELAXED)) {}
+    }
+}
+
+static void Result_parallelUnlock(Result_ParallelRange *const range) {
+    __atomic_clear(&range->lock, __ATOMIC_RELEASE);
+}
+
+bool Result_parallelTake(Result_ParallelRange *const range, size_t *const begin, size_t *const end) {
+    assert(NULL != range);
+    assert(NULL != begin);
+    assert(NULL != end);
+    Result_parallelLock(range);
+    *begin = range->begin;
+    *end = (range->end - range->begin > RESULT_PARALLEL_GRAIN) ? range->begin + RESULT_PARALLEL_GRAIN : range->end;
+    range->begin = *end;
+    Result_parallelUnlock(range);
+    return *begin < *end;
+}
+
+bool Result_parallelSteal(Result_ParallelJob *const job, const size_t thief) {
+    assert(NULL != job);
+    if (job->stopOnError && __atomic_load_n(&job->cancelled, __ATOMIC_RELAXED)) {
+        return false;
+    }
+    for (size_t i = 1; i < job->rangesSize; i++) {
+        Result_ParallelRange *victim = &job->ranges[(thief + i) % job->rangesSize];
+        size_t begin = 0, end = 0;
+        Result_parallelLock(victim);
+        if (victim->end - victim->begin > RESULT_PARALLEL_GRAIN) {
+            // take the back half, the owner keeps consuming the front
+            begin = victim->begin + (victim->end - victim->begin) / 2;
+            end = victim->end;
+            victim->end = begin;
+        }
+        Result_parallelUnlock(victim);
+        if (begin < end) {
+            Result_ParallelRange *range = &job->ranges[thief];
+            Result_parallelLock(range);
+            range->begin = begin;
+            range->end = end;
+            Result_parallelUnlock(range);
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,120 @@
+/*
+Author: daddinuz
+email:  daddinuz@gmail.com
+
+Copyright (c) 2018 Davide Di Carlo
+
+Permission is hereby granted, free of charge, to any person
+obtaining a copy of this software and associated documentation
+files (the "Software"), to deal in the Software without
+restriction, including without limitation the rights to use,
+copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be
+included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include "result.h"
+#include "result-cancel.h"
+
+#if !(defined(__GNUC__) || defined(__clang__))
+__attribute__(...)
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Parallel combinators over arrays of results.
+ * Work is split among `workers` threads (a thread for each online processor if 0, the calling thread included), each
+ * one owning a contiguous range of indices: owners consume their range from the front while idle workers steal the back
+ * half of the range of someone else. Small arrays are processed on the calling thread only.
+ * The threads are started by every call and joined before it returns, so these functions pay off on arrays that keep
+ * each worker busy for well over a thread start, i.e. tens of thousands of elements or more.
+ *
+ * outputs may alias inputs.
+ *
+ * The cancellable variants check the token before every element, as `Result_chainCancellable(...)` does: once it has
+ * been cancelled, `f` is no longer called and the remaining `Ok` inputs become errors wrapping `Cancelled`.
+ */
+
+/**
+ * Stores `Result_map(inputs[i], f)` into `outputs[i]` for every index.
+ *
+ * @attention inputs and outputs must not be `NULL`.
+ * @attention f must not be `NULL`.
+ */
+extern void Result_parallelMap(const Result *inputs, Result *outputs, size_t size, const void *f(const void *),
+                               size_t workers);
+
+/**
+ * Stores `Result_chain(inputs[i], f)` into `outputs[i]` for every index.
+ *
+ * @attention inputs and outputs must not be `NULL`.
+ * @attention f must not be `NULL`.
+ */
+extern void Result_parallelChain(const Result *inputs, Result *outputs, size_t size, Result f(const void *),
+                                 size_t workers);
+
+/**
+ * Like `Result_parallelChain(...)` but all workers stop as soon as any output is an `Error` variant.
+ * Returns a `Result` wrapping outputs if every output is an `Ok` variant, else the first error observed;
+ * in the latter case the content of outputs is unspecified.
+ *
+ * @attention inputs and outputs must not be `NULL`.
+ * @attention f must not be `NULL`.
+ */
+extern Result Result_parallelTryAll(const Result *inputs, Result *outputs, size_t size, Result f(const void *),
+                                    size_t workers)
+__attribute__((__warn_unused_result__));
+
+/**
+ * Same as `Result_parallelMap(...)` but stops calling `f` once `cancel` has been cancelled.
+ *
+ * @attention inputs and outputs must not be `NULL`.
+ * @attention f must not be `NULL`.
+ * @attention cancel must not be `NULL`.
+ */
+extern void Result_parallelMapCancellable(const Result *inputs, Result *outputs, size_t size,
+                                          const void *f(const void *), size_t workers, const ResultCancel *cancel);
+
+/**
+ * Same as `Result_parallelChain(...)` but stops calling `f` once `cancel` has been cancelled.
+ *
+ * @attention inputs and outputs must not be `NULL`.
+ * @attention f must not be `NULL`.
+ * @attention cancel must not be `NULL`.
+ */
+extern void Result_parallelChainCancellable(const Result *inputs, Result *outputs, size_t size,
+                                            Result f(const void *), size_t workers, const ResultCancel *cancel);
+
+/**
+ * Same as `Result_parallelTryAll(...)` but all workers stop once `cancel` has been cancelled, a `Result` wrapping
+ * `Cancelled` is returned in that case unless an error has been observed first.
+ *
+ * @attention inputs and outputs must not be `NULL`.
+ * @attention f must not be `NULL`.
+ * @attention cancel must not be `NULL`.
+ */
+extern Result Result_parallelTryAllCancellable(const Result *inputs, Result *outputs, size_t size,
+                                               Result f(const void *), size_t workers, const ResultCancel *cancel)
+__attribute__((__warn_unused_result__));
+
+#ifdef __cplusplus
+}
+#endif
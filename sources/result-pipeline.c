@@ -0,0 +1,247 @@
+/*
+ * Author: daddinuz
+ * email:  daddinuz@gmail.com
+ *
+ * Copyright (c) 2018 Davide Di Carlo
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <string.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <panic/panic.h>
+#include "result-pipeline.h"
+
+struct ResultPipeline {
+    size_t size;
+    ResultPipeline_Stage stages[];
+};
+
+static Result ResultPipeline_apply(const ResultPipeline_Stage *stage, Result input)
+__attribute__((__warn_unused_result__, __nonnull__));
+
+static void ResultPipeline_applyBatch(const ResultPipeline_Stage *stage, Result *results, size_t size)
+__attribute__((__nonnull__));
+
+static Error ResultPipeline_interruption(ResultDeadline deadline, const ResultCancel *cancel)
+__attribute__((__warn_unused_result__));
+
+ResultPipeline_Stage ResultPipeline_map(const void *(*const f)(const void *)) {
+    return (ResultPipeline_Stage) {.__kind=__ResultPipeline_Map, .__f.map=f};
+}
+
+ResultPipeline_Stage ResultPipeline_chain(Result (*const f)(const void *)) {
+    return (ResultPipeline_Stage) {.__kind=__ResultPipeline_Chain, .__f.chain=f};
+}
+
+ResultPipeline_Stage ResultPipeline_alt(const Result other) {
+    return (ResultPipeline_Stage) {.__kind=__ResultPipeline_Alt, .__other=other};
+}
+
+ResultPipeline_Stage ResultPipeline_orElse(Result (*const f)(void)) {
+    return (ResultPipeline_Stage) {.__kind=__ResultPipeline_OrElse, .__f.orElse=f};
+}
+
+ResultPipeline_Stage ResultPipeline_altThunk(ResultThunk *const other) {
+    return (ResultPipeline_Stage) {.__kind=__ResultPipeline_AltThunk, .__thunk=other};
+}
+
+ResultPipeline ResultPipeline_new(const size_t size, const ResultPipeline_Stage *const stages) {
+    Panic_when(NULL == stages && size > 0);
+    for (size_t i = 0; i < size; i++) {
+        switch (stages[i].__kind) {
+            case __ResultPipeline_Map:
+                Panic_when(NULL == stages[i].__f.map);
+                break;
+            case __ResultPipeline_Chain:
+                Panic_when(NULL == stages[i].__f.chain);
+                break;
+            case __ResultPipeline_Alt:
+                Panic_when(NULL == stages[i].__other.__error);
+                break;
+            case __ResultPipeline_OrElse:
+                Panic_when(NULL == stages[i].__f.orElse);
+                break;
+            case __ResultPipeline_AltThunk:
+                Panic_when(NULL == stages[i].__thunk);
+                break;
+            default:
+                Panic_when(true);
+        }
+    }
+    ResultPipeline self = malloc(sizeof(*self) + size * sizeof(self->stages[0]));
+    Panic_when(NULL == self);
+    self->size = size;
+    if (size > 0) {
+        memcpy(self->stages, stages, size * sizeof(self->stages[0]));
+    }
+    return self;
+}
+
+Result ResultPipeline_run(ResultPipeline self, Result input) {
+    assert(NULL != self);
+    for (size_t i = 0; i < self->size; i++) {
+        input = ResultPipeline_apply(&self->stages[i], input);
+    }
+    return input;
+}
+
+void ResultPipeline_runBatch(ResultPipeline self, const Result *const inputs, Result *const outputs, const size_t size) {
+    assert(NULL != self);
+    Panic_when((NULL == inputs || NULL == outputs) && size > 0);
+    if (0 == size) {
+        return;
+    }
+    if (inputs != outputs) {
+        memmove(outputs, inputs, size * sizeof(outputs[0]));
+    }
+    // stage by stage: a single function stays hot while it is applied to the whole batch
+    for (size_t s = 0; s < self->size; s++) {
+        ResultPipeline_applyBatch(&self->stages[s], outputs, size);
+    }
+}
+
+Result ResultPipeline_runWithin(ResultPipeline self, const Result input, const ResultDeadline deadline) {
+    assert(NULL != self);
+    return ResultPipeline_runCancellable(self, input, deadline, NULL);
+}
+
+void ResultPipeline_runBatchWithin(ResultPipeline self, const Result *const inputs, Result *const outputs,
+                                   const size_t size, const ResultDeadline deadline) {
+    assert(NULL != self);
+    ResultPipeline_runBatchCancellable(self, inputs, outputs, size, deadline, NULL);
+}
+
+Result ResultPipeline_runCancellable(ResultPipeline self, Result input, const ResultDeadline deadline,
+                                     const ResultCancel *const cancel) {
+    assert(NULL != self);
+    for (size_t i = 0; i < self->size; i++) {
+        // errors are never replaced, there is nothing to interrupt until a stage recovers a value
+        if (Ok == input.__error) {
+            const Error interruption = ResultPipeline_interruption(deadline, cancel);
+            if (NULL != interruption) {
+                return Result_error(interruption);
+            }
+        }
+        input = ResultPipeline_apply(&self->stages[i], input);
+    }
+    return input;
+}
+
+void ResultPipeline_runBatchCancellable(ResultPipeline self, const Result *const inputs, Result *const outputs,
+                                        const size_t size, const ResultDeadline deadline,
+                                        const ResultCancel *const cancel) {
+    assert(NULL != self);
+    Panic_when((NULL == inputs || NULL == outputs) && size > 0);
+    if (0 == size) {
+        return;
+    }
+    if (inputs != outputs) {
+        memmove(outputs, inputs, size * sizeof(outputs[0]));
+    }
+    for (size_t s = 0; s < self->size; s++) {
+        size_t values = 0;
+        for (size_t i = 0; i < size; i++) {
+            values += (Ok == outputs[i].__error);
+        }
+        if (values > 0) {
+            const Error interruption = ResultPipeline_interruption(deadline, cancel);
+            if (NULL != interruption) {
+                for (size_t i = 0; i < size; i++) {
+                    if (Ok == outputs[i].__error) {
+                        outputs[i] = Result_error(interruption);
+                    }
+                }
+                return;
+            }
+        }
+        ResultPipeline_applyBatch(&self->stages[s], outputs, size);
+    }
+}
+
+void ResultPipeline_delete(ResultPipeline self) {
+    assert(NULL != self);
+    free(self);
+}
+
+/*
+ * Stages have been validated when the pipeline was built, no need to check them again here.
+ */
+Result ResultPipeline_apply(const ResultPipeline_Stage *const stage, const Result input) {
+    assert(NULL != stage);
+    switch (stage->__kind) {
+        case __ResultPipeline_Map:
+            if (Ok == input.__error) {
+                const void *value = stage->__f.map(input.__value);
+                return (Result) {.__error=(NULL == value) ? NullReferenceError : Ok, .__value=value};
+            }
+            return input;
+        case __ResultPipeline_Chain:
+            return (Ok == input.__error) ? stage->__f.chain(input.__value) : input;
+        case __ResultPipeline_Alt:
+            return (Ok == input.__error) ? input : stage->__other;
+        case __ResultPipeline_OrElse:
+            return (Ok == input.__error) ? input : stage->__f.orElse();
+        case __ResultPipeline_AltThunk:
+            return (Ok == input.__error) ? input : ResultThunk_force(stage->__thunk);
+        default:
+            return input;
+    }
+}
+
+void ResultPipeline_applyBatch(const ResultPipeline_Stage *const stage, Result *const results, const size_t size) {
+    assert(NULL != stage);
+    assert(NULL != results);
+    switch (stage->__kind) {
+        case __ResultPipeline_Map:
+            for (size_t i = 0; i < size; i++) {
+                if (Ok == results[i].__error) {
+                    const void *value = stage->__f.map(results[i].__value);
+                    results[i] = (Result) {.__error=(NULL == value) ? NullReferenceError : Ok, .__value=value};
+                }
+            }
+            break;
+        case __ResultPipeline_Chain:
+            for (size_t i = 0; i < size; i++) {
+                if (Ok == results[i].__error) {
+                    results[i] = stage->__f.chain(results[i].__value);
+                }
+            }
+            break;
+        default:
+            for (size_t i = 0; i < size; i++) {
+                results[i] = ResultPipeline_apply(stage, results[i]);
+            }
+            break;
+    }
+}
+
+/*
+ * Returns the reason why the remaining stages must be skipped, `NULL` if they can run.
+ */
+Error ResultPipeline_interruption(const ResultDeadline deadline, const ResultCancel *const cancel) {
+    if (NULL != cancel && ResultCancel_isCancelled(cancel)) {
+        return Cancelled;
+    }
+    return ResultDeadline_isExpired(deadline) ? TimeoutError : NULL;
+}
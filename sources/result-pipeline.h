@@ -0,0 +1,192 @@
+/*
+Author: daddinuz
+email:  daddinuz@gmail.com
+
+Copyright (c) 2018 Davide Di Carlo
+
+Permission is hereby granted, free of charge, to any person
+obtaining a copy of this software and associated documentation
+files (the "Software"), to deal in the Software without
+restriction, including without limitation the rights to use,
+copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be
+included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include "result.h"
+#include "result-thunk.h"
+#include "result-deadline.h"
+#include "result-cancel.h"
+
+#if !(defined(__GNUC__) || defined(__clang__))
+__attribute__(...)
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * A sequence of combinators built and validated once, then applied to many results.
+ *
+ * @attention this struct must be treated as opaque therefore its members must not be accessed directly.
+ */
+typedef struct ResultPipeline *ResultPipeline;
+
+/**
+ * @attention this struct must be treated as opaque therefore its members must not be accessed directly.
+ */
+typedef struct {
+    enum {
+        __ResultPipeline_Map,
+        __ResultPipeline_Chain,
+        __ResultPipeline_Alt,
+        __ResultPipeline_OrElse,
+        __ResultPipeline_AltThunk,
+    } __kind;
+    union {
+        const void *(*map)(const void *);
+        Result (*chain)(const void *);
+        Result (*orElse)(void);
+    } __f;
+    Result __other;
+    ResultThunk *__thunk;
+} ResultPipeline_Stage;
+
+/**
+ * A stage behaving like `Result_map(..., f)`.
+ */
+extern ResultPipeline_Stage ResultPipeline_map(const void *f(const void *))
+__attribute__((__warn_unused_result__));
+
+/**
+ * A stage behaving like `Result_chain(..., f)`.
+ */
+extern ResultPipeline_Stage ResultPipeline_chain(Result f(const void *))
+__attribute__((__warn_unused_result__));
+
+/**
+ * A stage behaving like `Result_alt(..., other)`.
+ */
+extern ResultPipeline_Stage ResultPipeline_alt(Result other)
+__attribute__((__warn_unused_result__));
+
+/**
+ * A stage behaving like `Result_orElse(..., f)`.
+ */
+extern ResultPipeline_Stage ResultPipeline_orElse(Result f(void))
+__attribute__((__warn_unused_result__));
+
+/**
+ * A stage behaving like `Result_altThunk(..., other)`, other is shared by every run and forced at most once.
+ */
+extern ResultPipeline_Stage ResultPipeline_altThunk(ResultThunk *other)
+__attribute__((__warn_unused_result__));
+
+/**
+ * Creates a pipeline applying the given stages in order, stages are copied.
+ *
+ * @attention stages must not be `NULL` unless size is 0.
+ * @attention every stage function must not be `NULL`.
+ */
+extern ResultPipeline ResultPipeline_new(size_t size, const ResultPipeline_Stage *stages)
+__attribute__((__warn_unused_result__));
+
+/**
+ * Creates a pipeline applying the stages passed as arguments in order.
+ */
+#define ResultPipeline_of(...) \
+    ResultPipeline_new(sizeof((ResultPipeline_Stage[]) {__VA_ARGS__}) / sizeof(ResultPipeline_Stage), \
+                       (ResultPipeline_Stage[]) {__VA_ARGS__})
+
+/**
+ * Applies the pipeline to a `Result`.
+ *
+ * @attention self must not be `NULL`.
+ */
+extern Result ResultPipeline_run(ResultPipeline self, Result input)
+__attribute__((__warn_unused_result__, __nonnull__));
+
+/**
+ * Stores `ResultPipeline_run(self, inputs[i])` into `outputs[i]` for every index.
+ * Each stage is applied to the whole batch before moving to the next one, outputs may alias inputs.
+ *
+ * @attention self must not be `NULL`.
+ * @attention inputs and outputs must not be `NULL` unless size is 0.
+ */
+extern void ResultPipeline_runBatch(ResultPipeline self, const Result *inputs, Result *outputs, size_t size)
+__attribute__((__nonnull__(1)));
+
+/**
+ * Same as `ResultPipeline_run(...)` but the deadline is checked before each stage reached by a value: once it has passed
+ * the remaining stages are skipped and a `Result` wrapping `TimeoutError` is returned.
+ * As with `Result_chainWithin(...)` errors are never replaced, an error goes on through the stages unchecked.
+ *
+ * @attention self must not be `NULL`.
+ */
+extern Result ResultPipeline_runWithin(ResultPipeline self, Result input, ResultDeadline deadline)
+__attribute__((__warn_unused_result__, __nonnull__));
+
+/**
+ * Same as `ResultPipeline_runBatch(...)` but the deadline is checked before each stage while the batch holds a value:
+ * once it has passed the remaining stages are skipped and every output wrapping a value is set to a `Result` wrapping
+ * `TimeoutError`, outputs wrapping an error are kept.
+ *
+ * @attention self must not be `NULL`.
+ * @attention inputs and outputs must not be `NULL` unless size is 0.
+ */
+extern void ResultPipeline_runBatchWithin(ResultPipeline self, const Result *inputs, Result *outputs, size_t size,
+                                          ResultDeadline deadline)
+__attribute__((__nonnull__(1)));
+
+/**
+ * Same as `ResultPipeline_runWithin(...)` but the token is checked before each stage too: once it has been cancelled the
+ * remaining stages are skipped and a `Result` wrapping `Cancelled` is returned.
+ * As with `Result_chainCancellable(...)` errors are never replaced.
+ * If cancel is `NULL` only the deadline is checked.
+ *
+ * @attention self must not be `NULL`.
+ */
+extern Result ResultPipeline_runCancellable(ResultPipeline self, Result input, ResultDeadline deadline,
+                                            const ResultCancel *cancel)
+__attribute__((__warn_unused_result__, __nonnull__(1)));
+
+/**
+ * Same as `ResultPipeline_runBatchWithin(...)` but the token is checked before each stage too: once it has been
+ * cancelled the remaining stages are skipped and every output wrapping a value is set to a `Result` wrapping
+ * `Cancelled`, outputs wrapping an error are kept.
+ * If cancel is `NULL` only the deadline is checked.
+ *
+ * @attention self must not be `NULL`.
+ * @attention inputs and outputs must not be `NULL` unless size is 0.
+ */
+extern void ResultPipeline_runBatchCancellable(ResultPipeline self, const Result *inputs, Result *outputs, size_t size,
+                                               ResultDeadline deadline, const ResultCancel *cancel)
+__attribute__((__nonnull__(1)));
+
+/**
+ * Releases the pipeline.
+ *
+ * @attention self must not be `NULL`.
+ */
+extern void ResultPipeline_delete(ResultPipeline self)
+__attribute__((__nonnull__));
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,413 @@
+/*
+ * Author: daddinuz
+ * email:  daddinuz@gmail.com
+ *
+ * Copyright (c) 2018 Davide Di Carlo
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <time.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <sys/syscall.h>
+#include <panic/panic.h>
+#include "result-clock.h"
+#include "result-io.h"
+#include "result-reactor.h"
+
+/*
+ * Events fetched by a single epoll_wait call.
+ */
+#define RESULT_REACTOR_EVENTS   64
+
+#define RESULT_REACTOR_NEVER    UINT64_MAX
+#define RESULT_REACTOR_NOWHERE  SIZE_MAX
+
+/*
+ * The epoll data of a watch is its descriptor and its generation: events still pending for a watch that has been
+ * replaced or removed are recognized as stale.
+ * The timer and the wakeup descriptors are registered with generation 0.
+ */
+typedef struct {
+    ResultReactor_Event event;
+    uint32_t interest;
+    uint32_t generation;
+    uint64_t timeout;
+    uint64_t expiry;
+    size_t heapIndex;
+    Result (*continuation)(Result, void *);
+    void *context;
+} Result_ReactorWatch;
+
+struct ResultReactor {
+    int epoll;
+    int timer;
+    int wakeup;
+    int stopped;
+    uint32_t generations;
+    uint64_t armed;
+    size_t watching;
+    // indexed by descriptor
+    size_t watchesSize;
+    Result_ReactorWatch **watches;
+    // a min-heap of the watches with a timeout, ordered by expiry
+    size_t heapSize;
+    size_t heapCapacity;
+    Result_ReactorWatch **heap;
+};
+
+static uint64_t Result_reactorData(int fd, uint32_t generation)
+__attribute__((__warn_unused_result__));
+
+static Result_ReactorWatch *Result_reactorLookup(ResultReactor self, uint64_t data)
+__attribute__((__warn_unused_result__, __nonnull__));
+
+static void Result_reactorDispatch(ResultReactor self, Result_ReactorWatch *watch, Result event)
+__attribute__((__nonnull__));
+
+static void Result_reactorExpire(ResultReactor self)
+__attribute__((__nonnull__));
+
+static void Result_reactorArm(ResultReactor self)
+__attribute__((__nonnull__));
+
+static void Result_reactorHeapSwap(ResultReactor self, size_t a, size_t b)
+__attribute__((__nonnull__));
+
+static void Result_reactorHeapFix(ResultReactor self, size_t index)
+__attribute__((__nonnull__));
+
+static void Result_reactorHeapPush(ResultReactor self, Result_ReactorWatch *watch)
+__attribute__((__nonnull__));
+
+static void Result_reactorHeapRemove(ResultReactor self, Result_ReactorWatch *watch)
+__attribute__((__nonnull__));
+
+ResultReactor ResultReactor_new(void) {
+    ResultReactor self = calloc(1, sizeof(*self));
+    Panic_when(NULL == self);
+    self->epoll = epoll_create1(EPOLL_CLOEXEC);
+    self->timer = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    self->wakeup = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    Panic_when(self->epoll < 0 || self->timer < 0 || self->wakeup < 0);
+    struct epoll_event timer = {.events=EPOLLIN, .data.u64=Result_reactorData(self->timer, 0)};
+    struct epoll_event wakeup = {.events=EPOLLIN, .data.u64=Result_reactorData(self->wakeup, 0)};
+    Panic_unless(0 == epoll_ctl(self->epoll, EPOLL_CTL_ADD, self->timer, &timer));
+    Panic_unless(0 == epoll_ctl(self->epoll, EPOLL_CTL_ADD, self->wakeup, &wakeup));
+    self->armed = RESULT_REACTOR_NEVER;
+    return self;
+}
+
+Result ResultReactor_watch(ResultReactor self, const int fd, const int interest, const size_t timeout,
+                           Result (*const continuation)(Result, void *), void *const context) {
+    assert(NULL != self);
+    Panic_when(0 == interest || 0 != (interest & ~(ResultReactor_Readable | ResultReactor_Writable)));
+    Panic_when(0 == timeout);
+    Panic_when(NULL == continuation);
+    if (fd < 0) {
+        return ResultIO_error(EBADF);
+    }
+
+    if ((size_t) fd >= self->watchesSize) {
+        const size_t size = ((size_t) fd + 1) * 2;
+        self->watches = realloc(self->watches, size * sizeof(self->watches[0]));
+        Panic_when(NULL == self->watches);
+        memset(self->watches + self->watchesSize, 0, (size - self->watchesSize) * sizeof(self->watches[0]));
+        self->watchesSize = size;
+    }
+
+    Result_ReactorWatch *watch = self->watches[fd];
+    const bool replacing = NULL != watch;
+    if (!replacing) {
+        watch = calloc(1, sizeof(*watch));
+        Panic_when(NULL == watch);
+        watch->heapIndex = RESULT_REACTOR_NOWHERE;
+    }
+    // generation 0 is reserved to the reactor's own descriptors
+    self->generations = (UINT32_MAX == self->generations) ? 1 : self->generations + 1;
+    const uint32_t events = ((interest & ResultReactor_Readable) ? EPOLLIN | EPOLLRDHUP : 0) |
+                            ((interest & ResultReactor_Writable) ? EPOLLOUT : 0);
+    struct epoll_event event = {.events=events, .data.u64=Result_reactorData(fd, self->generations)};
+    if (epoll_ctl(self->epoll, replacing ? EPOLL_CTL_MOD : EPOLL_CTL_ADD, fd, &event) < 0) {
+        const int errnum = errno;
+        if (!replacing) {
+            free(watch);
+        }
+        return ResultIO_error(errnum);
+    }
+
+    watch->event = (ResultReactor_Event) {.__fd=fd, .__events=0};
+    watch->interest = events;
+    watch->generation = self->generations;
+    watch->continuation = continuation;
+    watch->context = context;
+    watch->timeout = (RESULT_REACTOR_FOREVER == timeout) ? RESULT_REACTOR_NEVER : (uint64_t) timeout * 1000000;
+    if (!replacing) {
+        self->watches[fd] = watch;
+        self->watching += 1;
+    }
+    Result_reactorHeapRemove(self, watch);
+    if (RESULT_REACTOR_NEVER != watch->timeout) {
+        watch->expiry = Result_deadlineNow() + watch->timeout;
+        Result_reactorHeapPush(self, watch);
+    }
+    Result_reactorArm(self);
+    return Result_ok(self);
+}
+
+void ResultReactor_unwatch(ResultReactor self, const int fd) {
+    assert(NULL != self);
+    if (fd < 0 || (size_t) fd >= self->watchesSize || NULL == self->watches[fd]) {
+        return;
+    }
+    Result_ReactorWatch *const watch = self->watches[fd];
+    // the descriptor may have been closed already, which removed it from the epoll set
+    epoll_ctl(self->epoll, EPOLL_CTL_DEL, fd, &(struct epoll_event) {0});
+    Result_reactorHeapRemove(self, watch);
+    self->watches[fd] = NULL;
+    self->watching -= 1;
+    free(watch);
+    Result_reactorArm(self);
+}
+
+size_t ResultReactor_watching(ResultReactor self) {
+    assert(NULL != self);
+    return self->watching;
+}
+
+void ResultReactor_run(ResultReactor self) {
+    assert(NULL != self);
+    struct epoll_event events[RESULT_REACTOR_EVENTS];
+    while (self->watching > 0 && !__atomic_load_n(&self->stopped, __ATOMIC_ACQUIRE)) {
+        const int size = epoll_wait(self->epoll, events, RESULT_REACTOR_EVENTS, -1);
+        if (size < 0) {
+            Panic_unless(EINTR == errno);
+            continue;
+        }
+        for (int i = 0; i < size; i++) {
+            const uint64_t data = events[i].data.u64;
+            if (Result_reactorData(self->timer, 0) == data) {
+                uint64_t expirations;
+                (void) !read(self->timer, &expirations, sizeof(expirations));
+                self->armed = RESULT_REACTOR_NEVER;
+                Result_reactorExpire(self);
+                continue;
+            }
+            if (Result_reactorData(self->wakeup, 0) == data) {
+                uint64_t wakeups;
+                (void) !read(self->wakeup, &wakeups, sizeof(wakeups));
+                continue;
+            }
+
+            Result_ReactorWatch *const watch = Result_reactorLookup(self, data);
+            if (NULL == watch) {
+                continue;
+            }
+            if (0 == (events[i].events & (watch->interest | EPOLLHUP)) && (events[i].events & EPOLLERR)) {
+                int errnum = 0;
+                socklen_t size = sizeof(errnum);
+                if (getsockopt(watch->event.__fd, SOL_SOCKET, SO_ERROR, &errnum, &size) < 0 || 0 == errnum) {
+                    // not a socket, e.g. the read end of a pipe has been closed
+                    errnum = EPIPE;
+                }
+                Result_reactorDispatch(self, watch, ResultIO_error(errnum));
+            } else {
+                watch->event.__events = events[i].events;
+                Result_reactorDispatch(self, watch, Result_ok(&watch->event));
+            }
+        }
+        Result_reactorArm(self);
+    }
+    __atomic_store_n(&self->stopped, 0, __ATOMIC_RELEASE);
+}
+
+void ResultReactor_stop(ResultReactor self) {
+    assert(NULL != self);
+    __atomic_store_n(&self->stopped, 1, __ATOMIC_RELEASE);
+    const uint64_t wakeup = 1;
+    (void) !write(self->wakeup, &wakeup, sizeof(wakeup));
+}
+
+void ResultReactor_delete(ResultReactor self) {
+    assert(NULL != self);
+    for (size_t i = 0; i < self->watchesSize; i++) {
+        free(self->watches[i]);
+    }
+    free(self->watches);
+    free(self->heap);
+    close(self->wakeup);
+    close(self->timer);
+    close(self->epoll);
+    free(self);
+}
+
+int ResultReactor_eventFd(const ResultReactor_Event *const self) {
+    assert(NULL != self);
+    return self->__fd;
+}
+
+bool ResultReactor_isReadable(const ResultReactor_Event *const self) {
+    assert(NULL != self);
+    return 0 != (self->__events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP));
+}
+
+bool ResultReactor_isWritable(const ResultReactor_Event *const self) {
+    assert(NULL != self);
+    return 0 != (self->__events & EPOLLOUT);
+}
+
+bool ResultReactor_pin(const size_t core) {
+    unsigned long mask[16] = {0};
+    const size_t bits = 8 * sizeof(mask[0]);
+    if (core >= bits * (sizeof(mask) / sizeof(mask[0]))) {
+        return false;
+    }
+    mask[core / bits] = 1UL << (core % bits);
+    // tid 0 is the calling thread
+    return 0 == syscall(SYS_sched_setaffinity, 0, sizeof(mask), mask);
+}
+
+uint64_t Result_reactorData(const int fd, const uint32_t generation) {
+    return ((uint64_t) generation << 32) | (uint32_t) fd;
+}
+
+Result_ReactorWatch *Result_reactorLookup(ResultReactor self, const uint64_t data) {
+    assert(NULL != self);
+    const size_t fd = (uint32_t) data;
+    Result_ReactorWatch *const watch = (fd < self->watchesSize) ? self->watches[fd] : NULL;
+    return (NULL != watch && watch->generation == (uint32_t) (data >> 32)) ? watch : NULL;
+}
+
+void Result_reactorDispatch(ResultReactor self, Result_ReactorWatch *const watch, const Result event) {
+    assert(NULL != self);
+    assert(NULL != watch);
+    const int fd = watch->event.__fd;
+    const uint32_t generation = watch->generation;
+    const Result outcome = watch->continuation(event, watch->context);
+
+    // the continuation may have replaced or removed its own watch
+    if (Result_reactorLookup(self, Result_reactorData(fd, generation)) != watch) {
+        return;
+    }
+    if (!Result_isOk(outcome)) {
+        ResultReactor_unwatch(self, fd);
+    } else if (RESULT_REACTOR_NEVER != watch->timeout) {
+        watch->expiry = Result_deadlineNow() + watch->timeout;
+        Result_reactorHeapFix(self, watch->heapIndex);
+    }
+}
+
+void Result_reactorExpire(ResultReactor self) {
+    assert(NULL != self);
+    const uint64_t now = Result_deadlineNow();
+    while (self->heapSize > 0 && self->heap[0]->expiry <= now) {
+        Result_ReactorWatch *const watch = self->heap[0];
+        // pushed back by the dispatch if the continuation keeps watching
+        watch->expiry = RESULT_REACTOR_NEVER;
+        Result_reactorHeapFix(self, 0);
+        Result_reactorDispatch(self, watch, Result_error(TimeoutError));
+    }
+}
+
+void Result_reactorArm(ResultReactor self) {
+    assert(NULL != self);
+    const uint64_t expiry = (self->heapSize > 0) ? self->heap[0]->expiry : RESULT_REACTOR_NEVER;
+    if (expiry == self->armed) {
+        return;
+    }
+    // an all zero value disarms the timer, the earliest expiry is never 0 on a monotonic clock
+    struct itimerspec value = {0};
+    if (RESULT_REACTOR_NEVER != expiry) {
+        value.it_value.tv_sec = (time_t) (expiry / UINT64_C(1000000000));
+        value.it_value.tv_nsec = (long) (expiry % UINT64_C(1000000000));
+    }
+    Panic_unless(0 == timerfd_settime(self->timer, TFD_TIMER_ABSTIME, &value, NULL));
+    self->armed = expiry;
+}
+
+void Result_reactorHeapSwap(ResultReactor self, const size_t a, const size_t b) {
+    assert(NULL != self);
+    Result_ReactorWatch *const watch = self->heap[a];
+    self->heap[a] = self->heap[b];
+    self->heap[b] = watch;
+    self->heap[a]->heapIndex = a;
+    self->heap[b]->heapIndex = b;
+}
+
+void Result_reactorHeapFix(ResultReactor self, size_t index) {
+    assert(NULL != self);
+    while (index > 0 && self->heap[index]->expiry < self->heap[(index - 1) / 2]->expiry) {
+        Result_reactorHeapSwap(self, index, (index - 1) / 2);
+        index = (index - 1) / 2;
+    }
+    for (;;) {
+        const size_t left = 2 * index + 1, right = left + 1;
+        size_t smallest = index;
+        if (left < self->heapSize && self->heap[left]->expiry < self->heap[smallest]->expiry) {
+            smallest = left;
+        }
+        if (right < self->heapSize && self->heap[right]->expiry < self->heap[smallest]->expiry) {
+            smallest = right;
+        }
+        if (smallest == index) {
+            return;
+        }
+        Result_reactorHeapSwap(self, index, smallest);
+        index = smallest;
+    }
+}
+
+void Result_reactorHeapPush(ResultReactor self, Result_ReactorWatch *const watch) {
+    assert(NULL != self);
+    assert(NULL != watch);
+    if (self->heapSize == self->heapCapacity) {
+        self->heapCapacity = (0 == self->heapCapacity) ? 16 : 2 * self->heapCapacity;
+        self->heap = realloc(self->heap, self->heapCapacity * sizeof(self->heap[0]));
+        Panic_when(NULL == self->heap);
+    }
+    watch->heapIndex = self->heapSize;
+    self->heap[self->heapSize++] = watch;
+    Result_reactorHeapFix(self, watch->heapIndex);
+}
+
+void Result_reactorHeapRemove(ResultReactor self, Result_ReactorWatch *const watch) {
+    assert(NULL != self);
+    assert(NULL != watch);
+    const size_t index = watch->heapIndex;
+    if (RESULT_REACTOR_NOWHERE == index) {
+        return;
+    }
+    Result_reactorHeapSwap(self, index, self->heapSize - 1);
+    self->heapSize -= 1;
+    watch->heapIndex = RESULT_REACTOR_NOWHERE;
+    if (index < self->heapSize) {
+        Result_reactorHeapFix(self, index);
+    }
+}
@@ -0,0 +1,179 @@
+/*
+Author: daddinuz
+email:  daddinuz@gmail.com
+
+Copyright (c) 2018 Davide Di Carlo
+
+Permission is hereby granted, free of charge, to any person
+obtaining a copy of this software and associated documentation
+files (the "Software"), to deal in the Software without
+restriction, including without limitation the rights to use,
+copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be
+included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "result.h"
+
+#if !(defined(__GNUC__) || defined(__clang__))
+__attribute__(...)
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * A single-threaded event loop turning readiness of file descriptors into `Result`s (Linux only).
+ *
+ * Each watched descriptor has a continuation receiving either a `Result` wrapping a `ResultReactor_Event` when it
+ * becomes ready, a `TimeoutError` if it stays idle for longer than its timeout, or a `SystemError` carrying the pending
+ * `errno` (see `ResultIO_errno(...)`) if the descriptor failed.
+ * The `Result` returned by the continuation decides what comes next: on `Ok` the descriptor keeps being watched and its
+ * timeout starts over, on errors it stops being watched; closing it is up to the caller.
+ *
+ * Readiness is level-triggered and multiplexed through epoll, timeouts share a single timerfd.
+ * Reactors have no shared state: to use every core run one reactor per thread, see `ResultReactor_pin(...)`.
+ *
+ * @attention this struct must be treated as opaque therefore its members must not be accessed directly.
+ */
+typedef struct ResultReactor *ResultReactor;
+
+/**
+ * Disables the timeout of a watch.
+ */
+#define RESULT_REACTOR_FOREVER  SIZE_MAX
+
+/**
+ * What a descriptor is watched for, may be combined.
+ */
+typedef enum {
+    ResultReactor_Readable = 1,
+    ResultReactor_Writable = 4,
+} ResultReactor_Interest;
+
+/**
+ * The readiness of a descriptor.
+ *
+ * @attention this struct must be treated as opaque therefore its members must not be accessed directly.
+ */
+typedef struct {
+    int __fd;
+    uint32_t __events;
+} ResultReactor_Event;
+
+/**
+ * Creates a reactor.
+ */
+extern ResultReactor ResultReactor_new(void)
+__attribute__((__warn_unused_result__));
+
+/**
+ * Watches `fd` for `interest`, replacing any previous watch on it.
+ * `continuation` is called with `context` on readiness, after `timeout` milliseconds of inactivity and on failures.
+ * May be called from within continuations.
+ *
+ * Returns a `Result` wrapping `self` or a `SystemError` carrying the `errno` if `fd` can't be watched.
+ *
+ * @attention self must not be `NULL`.
+ * @attention interest must not be 0.
+ * @attention timeout must be greater than 0.
+ * @attention continuation must not be `NULL`.
+ */
+extern Result ResultReactor_watch(ResultReactor self, int fd, int interest, size_t timeout,
+                                  Result continuation(Result, void *), void *context)
+__attribute__((__warn_unused_result__, __nonnull__(1)));
+
+/**
+ * Stops watching `fd`, does nothing if it is not watched.
+ * May be called from within continuations.
+ *
+ * @attention self must not be `NULL`.
+ */
+extern void ResultReactor_unwatch(ResultReactor self, int fd)
+__attribute__((__nonnull__));
+
+/**
+ * Returns the number of watched descriptors.
+ *
+ * @attention self must not be `NULL`.
+ */
+extern size_t ResultReactor_watching(ResultReactor self)
+__attribute__((__warn_unused_result__, __nonnull__));
+
+/**
+ * Dispatches events on the calling thread until nothing is watched anymore or `ResultReactor_stop(...)` is called.
+ *
+ * @attention self must not be `NULL`.
+ */
+extern void ResultReactor_run(ResultReactor self)
+__attribute__((__nonnull__));
+
+/**
+ * Makes `ResultReactor_run(...)` return after the continuations being dispatched, safe to call from any thread.
+ *
+ * @attention self must not be `NULL`.
+ */
+extern void ResultReactor_stop(ResultReactor self)
+__attribute__((__nonnull__));
+
+/**
+ * Releases the reactor, watched descriptors are left open.
+ *
+ * @attention self must not be `NULL`.
+ * @attention the reactor must not be running.
+ */
+extern void ResultReactor_delete(ResultReactor self)
+__attribute__((__nonnull__));
+
+/**
+ * Returns the descriptor that became ready.
+ *
+ * @attention self must not be `NULL`.
+ */
+extern int ResultReactor_eventFd(const ResultReactor_Event *self)
+__attribute__((__warn_unused_result__, __nonnull__));
+
+/**
+ * Tells whether the descriptor can be read without blocking, this includes the end of file.
+ *
+ * @attention self must not be `NULL`.
+ */
+extern bool ResultReactor_isReadable(const ResultReactor_Event *self)
+__attribute__((__warn_unused_result__, __nonnull__));
+
+/**
+ * Tells whether the descriptor can be written without blocking.
+ *
+ * @attention self must not be `NULL`.
+ */
+extern bool ResultReactor_isWritable(const ResultReactor_Event *self)
+__attribute__((__warn_unused_result__, __nonnull__));
+
+/**
+ * Pins the calling thread to `core`, meant to run one reactor per core.
+ * Returns `false` if the core does not exist or the thread is not allowed to run on it.
+ */
+extern bool ResultReactor_pin(size_t core)
+__attribute__((__warn_unused_result__));
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,133 @@
+/*
+ * Author: daddinuz
+ * email:  daddinuz@gmail.com
+ *
+ * Copyright (c) 2018 Davide Di Carlo
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <time.h>
+#include <errno.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <panic/panic.h>
+#include "result-clock.h"
+#include "result-retry.h"
+
+struct ResultRetryPolicy {
+    size_t maxAttempts;
+    uint64_t initialDelay;
+    uint64_t maxDelay;
+    uint64_t timeout;
+    bool (*shouldRetry)(Error);
+    size_t attempts;
+    size_t retries;
+    size_t exhausted;
+};
+
+static bool Result_retrySystemError(Error error)
+__attribute__((__warn_unused_result__));
+
+static void Result_retrySleepUntil(uint64_t wakeup);
+
+ResultRetryPolicy ResultRetryPolicy_new(const size_t maxAttempts, const size_t initialDelay, const size_t maxDelay,
+                                        const size_t timeout, bool (*const shouldRetry)(Error)) {
+    Panic_when(0 == maxAttempts);
+    Panic_when(initialDelay > maxDelay);
+    ResultRetryPolicy self = malloc(sizeof(*self));
+    Panic_when(NULL == self);
+    // everything is kept in nanoseconds from here on
+    self->maxAttempts = maxAttempts;
+    self->initialDelay = (uint64_t) initialDelay * UINT64_C(1000000);
+    self->maxDelay = (uint64_t) maxDelay * UINT64_C(1000000);
+    self->timeout = (uint64_t) timeout * UINT64_C(1000000);
+    self->shouldRetry = (NULL == shouldRetry) ? Result_retrySystemError : shouldRetry;
+    self->attempts = self->retries = self->exhausted = 0;
+    return self;
+}
+
+size_t ResultRetryPolicy_attempts(ResultRetryPolicy self) {
+    assert(NULL != self);
+    return __atomic_load_n(&self->attempts, __ATOMIC_RELAXED);
+}
+
+size_t ResultRetryPolicy_retries(ResultRetryPolicy self) {
+    assert(NULL != self);
+    return __atomic_load_n(&self->retries, __ATOMIC_RELAXED);
+}
+
+size_t ResultRetryPolicy_exhausted(ResultRetryPolicy self) {
+    assert(NULL != self);
+    return __atomic_load_n(&self->exhausted, __ATOMIC_RELAXED);
+}
+
+void ResultRetryPolicy_delete(ResultRetryPolicy self) {
+    assert(NULL != self);
+    free(self);
+}
+
+Result Result_retry(Result (*const f)(void *), void *const context, ResultRetryPolicy policy) {
+    Panic_when(NULL == f);
+    Panic_when(NULL == policy);
+    const uint64_t start = Result_deadlineNow();
+    const uint64_t deadline = (0 == policy->timeout || policy->timeout > UINT64_MAX - start)
+                              ? UINT64_MAX : start + policy->timeout;
+    // xorshift seeded per call, jitter only needs to decorrelate concurrent callers
+    uint64_t random = start ^ (uint64_t) (uintptr_t) &start ^ UINT64_C(0x9e3779b97f4a7c15);
+    uint64_t delay = policy->initialDelay;
+
+    for (size_t attempt = 1;; attempt++) {
+        __atomic_add_fetch(&policy->attempts, 1, __ATOMIC_RELAXED);
+        const Result result = f(context);
+        if (Result_isOk(result) || !policy->shouldRetry(Result_inspect(result))) {
+            return result;
+        }
+
+        random ^= random << 13;
+        random ^= random >> 7;
+        random ^= random << 17;
+        const uint64_t jittered = delay - ((delay > 1) ? random % (delay / 2 + 1) : 0);
+        const uint64_t wakeup = Result_deadlineNow() + jittered;
+        if (attempt >= policy->maxAttempts || wakeup >= deadline) {
+            __atomic_add_fetch(&policy->exhausted, 1, __ATOMIC_RELAXED);
+            return result;
+        }
+
+        Result_retrySleepUntil(wakeup);
+        __atomic_add_fetch(&policy->retries, 1, __ATOMIC_RELAXED);
+        delay = (delay > policy->maxDelay / 2) ? policy->maxDelay : delay * 2;
+    }
+}
+
+bool Result_retrySystemError(Error error) {
+    return SystemError == error;
+}
+
+void Result_retrySleepUntil(const uint64_t wakeup) {
+    const struct timespec time = {
+            .tv_sec=(time_t) (wakeup / UINT64_C(1000000000)), .tv_nsec=(long) (wakeup % UINT64_C(1000000000))
+    };
+    // absolute wakeups do not drift when interrupted by signals
+    while (EINTR == clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &time, NULL));
+}
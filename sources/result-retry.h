@@ -0,0 +1,108 @@
+/*
+Author: daddinuz
+email:  daddinuz@gmail.com
+
+Copyright (c) 2018 Davide Di Carlo
+
+Permission is hereby granted, free of charge, to any person
+obtaining a copy of this software and associated documentation
+files (the "Software"), to deal in the Software without
+restriction, including without limitation the rights to use,
+copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be
+included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdbool.h>
+#include "result.h"
+
+#if !(defined(__GNUC__) || defined(__clang__))
+__attribute__(...)
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Tells when and how often a failing computation is tried again, and counts the attempts made through it.
+ * A policy may be shared among threads.
+ *
+ * @attention this struct must be treated as opaque therefore its members must not be accessed directly.
+ */
+typedef struct ResultRetryPolicy *ResultRetryPolicy;
+
+/**
+ * Creates a retry policy.
+ * The n-th retry waits a random delay between half and all of `min(initialDelay * 2^(n-1), maxDelay)` milliseconds.
+ * Retries stop after `maxAttempts` attempts, or when the next attempt would start more than `timeout` milliseconds
+ * after the first one (0 means no timeout), or when the error is not accepted by `shouldRetry`.
+ * If `shouldRetry` is `NULL` only `SystemError` is retried.
+ *
+ * @attention maxAttempts must be greater than 0.
+ * @attention initialDelay must not be greater than maxDelay.
+ */
+extern ResultRetryPolicy ResultRetryPolicy_new(size_t maxAttempts, size_t initialDelay, size_t maxDelay, size_t timeout,
+                                               bool shouldRetry(Error))
+__attribute__((__warn_unused_result__));
+
+/**
+ * Returns how many times a computation has been called through this policy.
+ *
+ * @attention self must not be `NULL`.
+ */
+extern size_t ResultRetryPolicy_attempts(ResultRetryPolicy self)
+__attribute__((__warn_unused_result__, __nonnull__));
+
+/**
+ * Returns how many of the attempts were retries.
+ *
+ * @attention self must not be `NULL`.
+ */
+extern size_t ResultRetryPolicy_retries(ResultRetryPolicy self)
+__attribute__((__warn_unused_result__, __nonnull__));
+
+/**
+ * Returns how many times a retryable error has been returned because attempts or time ran out.
+ *
+ * @attention self must not be `NULL`.
+ */
+extern size_t ResultRetryPolicy_exhausted(ResultRetryPolicy self)
+__attribute__((__warn_unused_result__, __nonnull__));
+
+/**
+ * Releases the policy.
+ *
+ * @attention self must not be `NULL`.
+ */
+extern void ResultRetryPolicy_delete(ResultRetryPolicy self)
+__attribute__((__nonnull__));
+
+/**
+ * Calls `f(context)` until it returns an `Ok` variant or the policy gives up, returning the last outcome.
+ * Waits between attempts sleep on a monotonic clock.
+ *
+ * @attention f must not be `NULL`.
+ * @attention policy must not be `NULL`.
+ */
+extern Result Result_retry(Result f(void *), void *context, ResultRetryPolicy policy)
+__attribute__((__warn_unused_result__));
+
+#ifdef __cplusplus
+}
+#endif
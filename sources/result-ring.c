@@ -0,0 +1,517 @@
+/*
+ * Author: daddinuz
+ * email:  daddinuz@gmail.com
+ *
+ * Copyright (c) 2018 Davide Di Carlo
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <time.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#include <linux/memfd.h>
+#include <panic/panic.h>
+#include "result-io.h"
+#include "result-ring.h"
+
+#define RESULT_RING_CACHE_LINE  64
+#define RESULT_RING_MAGIC       "RESRING"
+#define RESULT_RING_VERSION     1
+#define RESULT_RING_UNKNOWN     UINT32_MAX
+
+/*
+ * Number of times a waiter polls the ring before going to sleep.
+ */
+#define RESULT_RING_SPINS       128
+
+#if defined(__x86_64__) || defined(__i386__)
+#define Result_ringRelax()      __builtin_ia32_pause()
+#elif defined(__aarch64__)
+#define Result_ringRelax()      __asm__ __volatile__("yield")
+#else
+#define Result_ringRelax()      ((void) 0)
+#endif
+
+#ifndef MAP_POPULATE
+#define MAP_POPULATE            0
+#endif
+
+typedef enum {
+    Result_RingEmpty,
+    Result_RingReceived,
+    Result_RingDrained,
+} Result_RingPoll;
+
+/*
+ * Wakes up the processes waiting for a condition, the counter of waiters lets the notifying side skip the syscall
+ * when nobody is sleeping.
+ */
+typedef struct {
+    uint32_t waiters;
+    uint32_t epoch;
+} __attribute__((__aligned__(RESULT_RING_CACHE_LINE))) Result_RingSignal;
+
+/*
+ * The shared part, followed by the slots.
+ * Every process maps it at its own address: it must not hold pointers.
+ */
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t producers;
+    uint64_t errors;
+    uint64_t mask;
+    uint64_t payloadSize;
+    uint64_t stride;
+    uint64_t enqueuePosition __attribute__((__aligned__(RESULT_RING_CACHE_LINE)));
+    uint64_t dequeuePosition __attribute__((__aligned__(RESULT_RING_CACHE_LINE)));
+    uint32_t sending __attribute__((__aligned__(RESULT_RING_CACHE_LINE)));
+    uint32_t closed;
+    Result_RingSignal notEmpty;
+    Result_RingSignal notFull;
+} Result_RingShared;
+
+/*
+ * The sequence number tells whether the slot is ready to be written (== position) or read (== position + 1) at a
+ * given position of the ring, the payload follows the slot.
+ */
+typedef struct {
+    uint64_t sequence;
+    uint32_t error;
+    uint32_t reserved;
+    // the raw value of an error
+    uint64_t value;
+} Result_RingSlot;
+
+struct ResultRing {
+    Result_RingShared *shared;
+    size_t mappingSize;
+    int fd;
+    pid_t creator;
+    char *name;
+    // the position of the slot handed out by the last receive plus 1, 0 if none
+    uint64_t held;
+    // error index -> id, id -> error
+    size_t idsSize;
+    uint32_t *ids;
+    size_t tableSize;
+    Error *table;
+};
+
+static Result Result_ringMap(int fd, const Result_RingShared *layout, const Error *errors, size_t errorsSize)
+__attribute__((__warn_unused_result__));
+
+static Result_RingSlot *Result_ringSlot(ResultRing self, uint64_t position)
+__attribute__((__warn_unused_result__, __nonnull__));
+
+static bool Result_ringEnqueue(ResultRing self, Result result, size_t size)
+__attribute__((__warn_unused_result__, __nonnull__));
+
+static void Result_ringRelease(ResultRing self)
+__attribute__((__nonnull__));
+
+static Result_RingPoll Result_ringPoll(ResultRing self, Result *out)
+__attribute__((__warn_unused_result__, __nonnull__));
+
+static bool Result_ringIsFull(ResultRing self)
+__attribute__((__warn_unused_result__, __nonnull__));
+
+static bool Result_ringIsEmpty(ResultRing self)
+__attribute__((__warn_unused_result__, __nonnull__));
+
+static void Result_ringWait(Result_RingSignal *signal, ResultRing self, bool isBlocked(ResultRing),
+                            ResultDeadline deadline)
+__attribute__((__nonnull__));
+
+static void Result_ringNotify(Result_RingSignal *signal)
+__attribute__((__nonnull__));
+
+Result ResultRing_create(const char *const name, const size_t capacity, const size_t payloadSize,
+                         const ResultRing_Producers producers, const Error *const errors, const size_t errorsSize) {
+    Panic_when(0 == capacity || capacity > (SIZE_MAX >> 2));
+    Panic_unless(ResultRing_SingleProducer == producers || ResultRing_MultipleProducers == producers);
+    Panic_when(NULL == errors && errorsSize > 0);
+    Panic_when(errorsSize >= RESULT_RING_UNKNOWN - ERROR_BUILTINS);
+    Result_RingShared layout = {.producers=producers, .errors=errorsSize, .payloadSize=payloadSize};
+    size_t slots = 1;
+    while (slots < capacity) {
+        slots <<= 1;
+    }
+    // payloads stay aligned
+    layout.mask = slots - 1;
+    layout.stride = sizeof(Result_RingSlot) + ((payloadSize + 7) & ~(size_t) 7);
+
+    const int fd = (NULL == name) ? (int) syscall(SYS_memfd_create, "result-ring", MFD_CLOEXEC) :
+                   shm_open(name, O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0600);
+    if (fd < 0) {
+        return ResultIO_error(errno);
+    }
+    Result mapped = (ftruncate(fd, (off_t) (sizeof(layout) + slots * layout.stride)) < 0) ?
+                    ResultIO_error(errno) : Result_ringMap(fd, &layout, errors, errorsSize);
+    if (!Result_isOk(mapped)) {
+        close(fd);
+        if (NULL != name) {
+            shm_unlink(name);
+        }
+        return mapped;
+    }
+
+    ResultRing self = (ResultRing) Result_unwrap(mapped);
+    if (NULL != name) {
+        self->name = strdup(name);
+        Panic_when(NULL == self->name);
+    }
+    return mapped;
+}
+
+Result ResultRing_attach(const int fd, const Error *const errors, const size_t errorsSize) {
+    Panic_when(NULL == errors && errorsSize > 0);
+    const int duplicate = fcntl(fd, F_DUPFD_CLOEXEC, 0);
+    if (duplicate < 0) {
+        return ResultIO_error(errno);
+    }
+    const Result mapped = Result_ringMap(duplicate, NULL, errors, errorsSize);
+    if (!Result_isOk(mapped)) {
+        close(duplicate);
+    }
+    return mapped;
+}
+
+Result ResultRing_open(const char *const name, const Error *const errors, const size_t errorsSize) {
+    Panic_when(NULL == name);
+    Panic_when(NULL == errors && errorsSize > 0);
+    const int fd = shm_open(name, O_RDWR | O_CLOEXEC, 0);
+    if (fd < 0) {
+        return ResultIO_error(errno);
+    }
+    const Result mapped = Result_ringMap(fd, NULL, errors, errorsSize);
+    if (!Result_isOk(mapped)) {
+        close(fd);
+    }
+    return mapped;
+}
+
+int ResultRing_fd(ResultRing self) {
+    assert(NULL != self);
+    return self->fd;
+}
+
+bool ResultRing_trySend(ResultRing self, const Result result, const size_t size) {
+    assert(NULL != self);
+    if (Result_ringEnqueue(self, result, size)) {
+        Result_ringNotify(&self->shared->notEmpty);
+        return true;
+    }
+    return false;
+}
+
+bool ResultRing_send(ResultRing self, const Result result, const size_t size, const ResultDeadline deadline) {
+    assert(NULL != self);
+    for (;;) {
+        if (Result_ringEnqueue(self, result, size)) {
+            Result_ringNotify(&self->shared->notEmpty);
+            return true;
+        }
+        if (__atomic_load_n(&self->shared->closed, __ATOMIC_ACQUIRE) || ResultDeadline_isExpired(deadline)) {
+            return false;
+        }
+        Result_ringWait(&self->shared->notFull, self, Result_ringIsFull, deadline);
+    }
+}
+
+bool ResultRing_tryReceive(ResultRing self, Result *const out) {
+    assert(NULL != self);
+    Panic_when(NULL == out);
+    Result_ringRelease(self);
+    return Result_RingEmpty != Result_ringPoll(self, out);
+}
+
+Result ResultRing_receive(ResultRing self, const ResultDeadline deadline) {
+    assert(NULL != self);
+    Result out;
+    Result_ringRelease(self);
+    for (;;) {
+        if (Result_RingEmpty != Result_ringPoll(self, &out)) {
+            return out;
+        }
+        if (ResultDeadline_isExpired(deadline)) {
+            return Result_error(TimeoutError);
+        }
+        Result_ringWait(&self->shared->notEmpty, self, Result_ringIsEmpty, deadline);
+    }
+}
+
+void ResultRing_close(ResultRing self) {
+    assert(NULL != self);
+    __atomic_store_n(&self->shared->closed, 1, __ATOMIC_SEQ_CST);
+    Result_ringNotify(&self->shared->notEmpty);
+    Result_ringNotify(&self->shared->notFull);
+}
+
+void ResultRing_delete(ResultRing self) {
+    assert(NULL != self);
+    Result_ringRelease(self);
+    munmap(self->shared, self->mappingSize);
+    close(self->fd);
+    // forked children share the handle, only the creator removes the name
+    if (NULL != self->name && getpid() == self->creator) {
+        shm_unlink(self->name);
+    }
+    free(self->name);
+    free(self->table);
+    free(self->ids);
+    free(self);
+}
+
+Result Result_ringMap(const int fd, const Result_RingShared *const layout, const Error *const errors,
+                      const size_t errorsSize) {
+    struct stat status;
+    if (fstat(fd, &status) < 0) {
+        return ResultIO_error(errno);
+    }
+    const size_t mappingSize = (size_t) status.st_size;
+    if (mappingSize < sizeof(Result_RingShared)) {
+        return Result_error(DomainError);
+    }
+    Result_RingShared *shared = mmap(NULL, mappingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, 0);
+    if (MAP_FAILED == shared) {
+        return ResultIO_error(errno);
+    }
+
+    if (NULL != layout) {
+        // a fresh object is zero filled, the magic is written last
+        shared->version = RESULT_RING_VERSION;
+        shared->producers = layout->producers;
+        shared->errors = layout->errors;
+        shared->mask = layout->mask;
+        shared->payloadSize = layout->payloadSize;
+        shared->stride = layout->stride;
+        for (uint64_t i = 0; i <= layout->mask; i++) {
+            ((Result_RingSlot *) ((unsigned char *) (shared + 1) + i * layout->stride))->sequence = i;
+        }
+        __atomic_thread_fence(__ATOMIC_RELEASE);
+        memcpy(shared->magic, RESULT_RING_MAGIC, sizeof(RESULT_RING_MAGIC));
+    } else {
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        const bool valid = 0 == memcmp(shared->magic, RESULT_RING_MAGIC, sizeof(shared->magic)) &&
+                           RESULT_RING_VERSION == shared->version && shared->stride >= sizeof(Result_RingSlot) &&
+                           shared->mask < mappingSize / shared->stride &&
+                           sizeof(*shared) + (shared->mask + 1) * shared->stride == mappingSize;
+        const Error failure = !valid ? DomainError : (shared->errors > errorsSize) ? LookupError : Ok;
+        if (Ok != failure) {
+            munmap(shared, mappingSize);
+            return Result_error(failure);
+        }
+    }
+
+    ResultRing self = calloc(1, sizeof(*self));
+    Panic_when(NULL == self);
+    self->shared = shared;
+    self->mappingSize = mappingSize;
+    self->fd = fd;
+    self->creator = getpid();
+
+    // registry errors follow the built-in ones, as in ResultArchive
+    self->table = malloc((ERROR_BUILTINS + errorsSize) * sizeof(self->table[0]));
+    Panic_when(NULL == self->table);
+    for (size_t i = 0; i < ERROR_BUILTINS; i++) {
+        self->table[i] = Error_builtinAt(i);
+    }
+    self->tableSize = ERROR_BUILTINS + errorsSize;
+    self->idsSize = ERROR_BUILTINS;
+    for (size_t i = 0; i < errorsSize; i++) {
+        Panic_when(NULL == errors[i]);
+        self->table[ERROR_BUILTINS + i] = errors[i];
+        const size_t index = Error_index(errors[i]);
+        self->idsSize = (index < self->idsSize) ? self->idsSize : index + 1;
+    }
+    self->ids = malloc(self->idsSize * sizeof(self->ids[0]));
+    Panic_when(NULL == self->ids);
+    for (size_t i = 0; i < self->idsSize; i++) {
+        self->ids[i] = (i < ERROR_BUILTINS) ? (uint32_t) i : RESULT_RING_UNKNOWN;
+    }
+    for (size_t i = 0; i < errorsSize; i++) {
+        const size_t index = Error_index(errors[i]);
+        if (index >= ERROR_BUILTINS) {
+            self->ids[index] = (uint32_t) (ERROR_BUILTINS + i);
+        }
+    }
+    return Result_ok(self);
+}
+
+Result_RingSlot *Result_ringSlot(ResultRing self, const uint64_t position) {
+    assert(NULL != self);
+    unsigned char *const slots = (unsigned char *) (self->shared + 1);
+    return (Result_RingSlot *) (slots + (position & self->shared->mask) * self->shared->stride);
+}
+
+bool Result_ringEnqueue(ResultRing self, const Result result, const size_t size) {
+    assert(NULL != self);
+    Result_RingShared *const shared = self->shared;
+    const size_t index = Error_index(result.__error);
+    const uint32_t id = (index < self->idsSize) ? self->ids[index] : RESULT_RING_UNKNOWN;
+    Panic_when(RESULT_RING_UNKNOWN == id);
+    Panic_when(Ok == result.__error && size > shared->payloadSize);
+
+    bool enqueued = false;
+    __atomic_add_fetch(&shared->sending, 1, __ATOMIC_SEQ_CST);
+    if (!__atomic_load_n(&shared->closed, __ATOMIC_SEQ_CST)) {
+        uint64_t position = __atomic_load_n(&shared->enqueuePosition, __ATOMIC_RELAXED);
+        for (;;) {
+            Result_RingSlot *const slot = Result_ringSlot(self, position);
+            const int64_t difference = (int64_t) (__atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE) - position);
+            if (0 == difference) {
+                // a single producer owns the position, no need to race for it
+                if (ResultRing_SingleProducer == shared->producers) {
+                    __atomic_store_n(&shared->enqueuePosition, position + 1, __ATOMIC_RELAXED);
+                } else if (!__atomic_compare_exchange_n(&shared->enqueuePosition, &position, position + 1, true,
+                                                        __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                    continue;
+                }
+                slot->error = id;
+                slot->value = (Ok == result.__error) ? size : (uint64_t) (uintptr_t) result.__value;
+                if (Ok == result.__error) {
+                    memcpy(slot + 1, result.__value, size);
+                }
+                __atomic_store_n(&slot->sequence, position + 1, __ATOMIC_RELEASE);
+                enqueued = true;
+                break;
+            } else if (difference < 0) {
+                // the slot still holds the result sent one lap ago: full
+                break;
+            } else {
+                position = __atomic_load_n(&shared->enqueuePosition, __ATOMIC_RELAXED);
+            }
+        }
+    }
+    __atomic_sub_fetch(&shared->sending, 1, __ATOMIC_SEQ_CST);
+    if (!enqueued && __atomic_load_n(&shared->closed, __ATOMIC_SEQ_CST)) {
+        // the receiver may be waiting for the senders that got in before close
+        Result_ringNotify(&shared->notEmpty);
+    }
+    return enqueued;
+}
+
+void Result_ringRelease(ResultRing self) {
+    assert(NULL != self);
+    if (0 != self->held) {
+        const uint64_t position = self->held - 1;
+        __atomic_store_n(&Result_ringSlot(self, position)->sequence, position + self->shared->mask + 1,
+                         __ATOMIC_RELEASE);
+        self->held = 0;
+        Result_ringNotify(&self->shared->notFull);
+    }
+}
+
+Result_RingPoll Result_ringPoll(ResultRing self, Result *const out) {
+    assert(NULL != self);
+    assert(NULL != out);
+    Result_RingShared *const shared = self->shared;
+    for (;;) {
+        const bool closed = __atomic_load_n(&shared->closed, __ATOMIC_SEQ_CST);
+        const bool drained = closed && 0 == __atomic_load_n(&shared->sending, __ATOMIC_SEQ_CST);
+        const uint64_t position = __atomic_load_n(&shared->dequeuePosition, __ATOMIC_RELAXED);
+        const Result_RingSlot *const slot = Result_ringSlot(self, position);
+        if (position + 1 == __atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE)) {
+            Panic_unless(slot->error < self->tableSize);
+            const Error error = self->table[slot->error];
+            *out = (Result) {
+                    .__error=error,
+                    .__value=(Ok == error) ? (const void *) (slot + 1) : (const void *) (uintptr_t) slot->value
+            };
+            // the slot is given back on the next receive
+            __atomic_store_n(&shared->dequeuePosition, position + 1, __ATOMIC_RELAXED);
+            self->held = position + 1;
+            return Result_RingReceived;
+        }
+        if (!drained) {
+            return Result_RingEmpty;
+        }
+        // nobody is sending anymore, check once more for results published before close
+        if (position + 1 != __atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE)) {
+            *out = Result_error(StopIteration);
+            return Result_RingDrained;
+        }
+    }
+}
+
+bool Result_ringIsFull(ResultRing self) {
+    assert(NULL != self);
+    const uint64_t position = __atomic_load_n(&self->shared->enqueuePosition, __ATOMIC_SEQ_CST);
+    return !__atomic_load_n(&self->shared->closed, __ATOMIC_SEQ_CST) &&
+           __atomic_load_n(&Result_ringSlot(self, position)->sequence, __ATOMIC_SEQ_CST) != position;
+}
+
+bool Result_ringIsEmpty(ResultRing self) {
+    assert(NULL != self);
+    const uint64_t position = __atomic_load_n(&self->shared->dequeuePosition, __ATOMIC_SEQ_CST);
+    const bool drained = __atomic_load_n(&self->shared->closed, __ATOMIC_SEQ_CST) &&
+                         0 == __atomic_load_n(&self->shared->sending, __ATOMIC_SEQ_CST);
+    return !drained && __atomic_load_n(&Result_ringSlot(self, position)->sequence, __ATOMIC_SEQ_CST) != position + 1;
+}
+
+void Result_ringWait(Result_RingSignal *const signal, ResultRing self, bool isBlocked(ResultRing),
+                     const ResultDeadline deadline) {
+    assert(NULL != signal);
+    assert(NULL != self);
+    for (size_t i = 0; i < RESULT_RING_SPINS; i++) {
+        if (!isBlocked(self)) {
+            return;
+        }
+        Result_ringRelax();
+    }
+
+    // announce the waiter before the last check: either the notifier sees it or the check sees the notifier's update
+    const uint32_t epoch = __atomic_load_n(&signal->epoch, __ATOMIC_SEQ_CST);
+    __atomic_add_fetch(&signal->waiters, 1, __ATOMIC_SEQ_CST);
+    if (isBlocked(self)) {
+        const size_t remaining = ResultDeadline_remaining(deadline);
+        const struct timespec timeout = {
+                .tv_sec=(time_t) (remaining / 1000), .tv_nsec=(long) (remaining % 1000) * 1000000
+        };
+        // shared across processes, hence not private; returns straight away if the epoch moved meanwhile
+        syscall(SYS_futex, &signal->epoch, FUTEX_WAIT, epoch, (SIZE_MAX == remaining) ? NULL : &timeout, NULL, 0);
+    }
+    __atomic_sub_fetch(&signal->waiters, 1, __ATOMIC_SEQ_CST);
+}
+
+void Result_ringNotify(Result_RingSignal *const signal) {
+    assert(NULL != signal);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (0 == __atomic_load_n(&signal->waiters, __ATOMIC_SEQ_CST)) {
+        return;
+    }
+    __atomic_add_fetch(&signal->epoch, 1, __ATOMIC_SEQ_CST);
+    syscall(SYS_futex, &signal->epoch, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+}
@@ -0,0 +1,184 @@
+/*
+Author: daddinuz
+email:  daddinuz@gmail.com
+
+Copyright (c) 2018 Davide Di Carlo
+
+Permission is hereby granted, free of charge, to any person
+obtaining a copy of this software and associated documentation
+files (the "Software"), to deal in the Software without
+restriction, including without limitation the rights to use,
+copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be
+included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdbool.h>
+#include "result.h"
+#include "result-deadline.h"
+
+#if !(defined(__GNUC__) || defined(__clang__))
+__attribute__(...)
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * A bounded queue of results living in shared memory, for pipelines split across processes (Linux only).
+ *
+ * The ring is backed by a `memfd`, inherited by forked processes or passed around as a file descriptor, or by a named
+ * POSIX shared memory object.
+ * Results cross the process boundary as an error id plus a payload: errors are identified as in `ResultArchive`,
+ * built-in ones by their `Error_index(...)` and any other one by its position in a registry that every process must
+ * pass in the same order; the value of an `Ok` result is copied into the ring, the raw value of an error is carried
+ * as is so that e.g. the `errno` of a `ResultIO` failure survives.
+ *
+ * Any number of processes may send if the ring has been created for multiple producers, a single process at a time
+ * must receive.
+ * Sleeping senders and receivers are woken up through shared futexes.
+ * Once closed and drained, receiving yields a `Result` wrapping `StopIteration`.
+ *
+ * @attention this struct must be treated as opaque therefore its members must not be accessed directly.
+ */
+typedef struct ResultRing *ResultRing;
+
+/**
+ * How many processes may send at the same time.
+ */
+typedef enum {
+    /**
+     * A single sender, publishing skips the atomic read-modify-write.
+     */
+    ResultRing_SingleProducer,
+    /**
+     * Any number of senders.
+     */
+    ResultRing_MultipleProducers,
+} ResultRing_Producers;
+
+/**
+ * Creates a ring holding at least `capacity` results (rounded up to a power of 2), each one carrying a payload of up to
+ * `payloadSize` bytes.
+ * If `name` is `NULL` the ring is backed by an anonymous `memfd`, otherwise by a new shared memory object with that
+ * name, removed when the creating process deletes its ring.
+ *
+ * Returns a `Result` wrapping the `ResultRing` or a `SystemError` carrying the `errno` (see `ResultIO_errno(...)`).
+ *
+ * @attention capacity must be greater than 0.
+ * @attention errors must not be `NULL` unless errorsSize is 0.
+ */
+extern Result ResultRing_create(const char *name, size_t capacity, size_t payloadSize, ResultRing_Producers producers,
+                                const Error *errors, size_t errorsSize)
+__attribute__((__warn_unused_result__));
+
+/**
+ * Attaches to the ring behind `fd`, which is duplicated.
+ *
+ * Returns a `Result` wrapping the `ResultRing` or:
+ *  - a `DomainError` if `fd` does not hold a ring;
+ *  - a `LookupError` if the registry is shorter than the one the ring has been created with;
+ *  - a `SystemError` carrying the `errno`.
+ *
+ * @attention errors must not be `NULL` unless errorsSize is 0.
+ */
+extern Result ResultRing_attach(int fd, const Error *errors, size_t errorsSize)
+__attribute__((__warn_unused_result__));
+
+/**
+ * Attaches to the ring created with `name`, see `ResultRing_attach(...)`.
+ *
+ * @attention name must not be `NULL`.
+ * @attention errors must not be `NULL` unless errorsSize is 0.
+ */
+extern Result ResultRing_open(const char *name, const Error *errors, size_t errorsSize)
+__attribute__((__warn_unused_result__));
+
+/**
+ * Returns the file descriptor backing the ring, it is closed when the ring is deleted.
+ *
+ * @attention self must not be `NULL`.
+ */
+extern int ResultRing_fd(ResultRing self)
+__attribute__((__warn_unused_result__, __nonnull__));
+
+/**
+ * Sends a result without waiting, returns `false` if the ring is full or closed.
+ * The first `size` bytes of the value of an `Ok` result are copied into the ring, `size` is ignored for errors.
+ *
+ * @attention self must not be `NULL`.
+ * @attention size must not exceed the payload size of the ring.
+ * @attention the error must be a built-in one or must be listed in the registry.
+ */
+extern bool ResultRing_trySend(ResultRing self, Result result, size_t size)
+__attribute__((__warn_unused_result__, __nonnull__));
+
+/**
+ * Sends a result waiting while the ring is full, returns `false` if the ring is closed or the deadline has passed.
+ * The first `size` bytes of the value of an `Ok` result are copied into the ring, `size` is ignored for errors.
+ *
+ * @attention self must not be `NULL`.
+ * @attention size must not exceed the payload size of the ring.
+ * @attention the error must be a built-in one or must be listed in the registry.
+ */
+extern bool ResultRing_send(ResultRing self, Result result, size_t size, ResultDeadline deadline)
+__attribute__((__nonnull__));
+
+/**
+ * Receives a result without waiting, returns `false` if the ring is empty.
+ * If the ring is closed and drained `out` is set to a `Result` wrapping `StopIteration`.
+ * The value of an `Ok` result points into the ring and stays valid until the next receive.
+ *
+ * @attention self must not be `NULL`.
+ * @attention out must not be `NULL`.
+ */
+extern bool ResultRing_tryReceive(ResultRing self, Result *out)
+__attribute__((__warn_unused_result__, __nonnull__(1)));
+
+/**
+ * Receives a result waiting while the ring is empty.
+ * Returns a `Result` wrapping `StopIteration` if the ring is closed and drained or `TimeoutError` if the deadline has
+ * passed: a sender dying halfway through a send stalls the ring, the deadline bounds the wait.
+ * The value of an `Ok` result points into the ring and stays valid until the next receive.
+ *
+ * @attention self must not be `NULL`.
+ */
+extern Result ResultRing_receive(ResultRing self, ResultDeadline deadline)
+__attribute__((__warn_unused_result__, __nonnull__));
+
+/**
+ * Closes the ring for every attached process: further sends fail, the receiver drains the remaining results then
+ * gets `StopIteration`.
+ *
+ * @attention self must not be `NULL`.
+ */
+extern void ResultRing_close(ResultRing self)
+__attribute__((__nonnull__));
+
+/**
+ * Detaches this process from the ring, releasing it once no process is attached anymore.
+ *
+ * @attention self must not be `NULL`.
+ */
+extern void ResultRing_delete(ResultRing self)
+__attribute__((__nonnull__));
+
+#ifdef __cplusplus
+}
+#endif
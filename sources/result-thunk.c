@@ -0,0 +1,74 @@
+/*
+ * Author: daddinuz
+ * email:  daddinuz@gmail.com
+ *
+ * Copyright (c) 2018 Davide Di Carlo
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <sched.h>
+#include <assert.h>
+#include <panic/panic.h>
+#include "result-thunk.h"
+
+enum {
+    ResultThunk_Pending,
+    ResultThunk_Forcing,
+    ResultThunk_Forced,
+};
+
+ResultThunk ResultThunk_new(Result (*const f)(void *), void *const context) {
+    Panic_when(NULL == f);
+    return (ResultThunk) {.__f=f, .__context=context, .__state=ResultThunk_Pending};
+}
+
+Result ResultThunk_force(ResultThunk *const self) {
+    assert(NULL != self);
+    int state = __atomic_load_n(&self->__state, __ATOMIC_ACQUIRE);
+    if (ResultThunk_Forced == state) {
+        return self->__result;
+    }
+    Panic_when(NULL == self->__f);
+    if (ResultThunk_Pending == state &&
+        __atomic_compare_exchange_n(&self->__state, &state, ResultThunk_Forcing, false, __ATOMIC_ACQUIRE,
+                                    __ATOMIC_ACQUIRE)) {
+        self->__result = self->__f(self->__context);
+        __atomic_store_n(&self->__state, ResultThunk_Forced, __ATOMIC_RELEASE);
+        return self->__result;
+    }
+    // someone else is computing it
+    while (ResultThunk_Forced != __atomic_load_n(&self->__state, __ATOMIC_ACQUIRE)) {
+        sched_yield();
+    }
+    return self->__result;
+}
+
+bool ResultThunk_isForced(const ResultThunk *const self) {
+    assert(NULL != self);
+    return ResultThunk_Forced == __atomic_load_n(&self->__state, __ATOMIC_ACQUIRE);
+}
+
+Result Result_altThunk(const Result self, ResultThunk *const other) {
+    Panic_when(NULL == other);
+    return Result_isOk(self) ? self : ResultThunk_force(other);
+}
@@ -0,0 +1,89 @@
+/*
+Author: daddinuz
+email:  daddinuz@gmail.com
+
+Copyright (c) 2018 Davide Di Carlo
+
+Permission is hereby granted, free of charge, to any person
+obtaining a copy of this software and associated documentation
+files (the "Software"), to deal in the Software without
+restriction, including without limitation the rights to use,
+copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be
+included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include "result.h"
+
+#if !(defined(__GNUC__) || defined(__clang__))
+__attribute__(...)
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * A `Result` computed on demand: `f` is called with `context` the first time the thunk is forced, then the outcome is
+ * memoized and returned by every later force, even from other threads.
+ *
+ * @attention this struct must be treated as opaque therefore its members must not be accessed directly.
+ */
+typedef struct {
+    Result (*__f)(void *);
+    void *__context;
+    int __state;
+    Result __result;
+} ResultThunk;
+
+/**
+ * Creates a thunk deferring `f(context)`.
+ *
+ * @attention f must not be `NULL`.
+ */
+extern ResultThunk ResultThunk_new(Result f(void *), void *context)
+__attribute__((__warn_unused_result__));
+
+/**
+ * Returns the outcome of the deferred computation, computing it if this is the first time.
+ *
+ * @attention self must not be `NULL`.
+ * @attention the deferred computation must not force its own thunk.
+ */
+extern Result ResultThunk_force(ResultThunk *self)
+__attribute__((__warn_unused_result__, __nonnull__));
+
+/**
+ * Returns `true` if the deferred computation has already been done, `false` otherwise.
+ *
+ * @attention self must not be `NULL`.
+ */
+extern bool ResultThunk_isForced(const ResultThunk *self)
+__attribute__((__warn_unused_result__, __nonnull__));
+
+/**
+ * Lazy version of `Result_alt(...)`: other is forced only if this `Result` is an `Error` variant.
+ *
+ * @attention other must not be `NULL`.
+ */
+extern Result Result_altThunk(Result self, ResultThunk *other)
+__attribute__((__warn_unused_result__));
+
+#ifdef __cplusplus
+}
+#endif
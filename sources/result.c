@@ -74,6 +74,63 @@ Result Result_orElse(const Result self, Result f(void)) {
     return Result_isOk(self) ? self : f();
 }
 
+Result Result_all(const Result *const results, const size_t size, const void **const values) {
+    Panic_when(NULL == values);
+    Panic_when(NULL == results && size > 0);
+    for (size_t i = 0; i < size; i++) {
+        if (Ok != results[i].__error) {
+            return results[i];
+        }
+        values[i] = results[i].__value;
+    }
+    return (Result) {.__error=Ok, .__value=values};
+}
+
+size_t Result_collectErrors(const Result *const results, const size_t size, Error *const errors) {
+    Panic_when(NULL == errors);
+    Panic_when(NULL == results && size > 0);
+    size_t count = 0;
+    for (size_t i = 0; i < size; i++) {
+        // branch-free: always store, advance only on errors
+        errors[count] = results[i].__error;
+        count += (Ok != results[i].__error);
+    }
+    return count;
+}
+
+Result Result_zip2(const Result first, const Result second, const void *(*const f)(const void *, const void *)) {
+    Panic_when(NULL == f);
+    if (Result_isError(first)) {
+        return first;
+    }
+    if (Result_isError(second)) {
+        return second;
+    }
+    return Result_fromNullable(f(first.__value, second.__value));
+}
+
+Result Result_zip3(const Result first, const Result second, const Result third,
+                   const void *(*const f)(const void *, const void *, const void *)) {
+    Panic_when(NULL == f);
+    if (Result_isError(first)) {
+        return first;
+    }
+    if (Result_isError(second)) {
+        return second;
+    }
+    if (Result_isError(third)) {
+        return third;
+    }
+    return Result_fromNullable(f(first.__value, second.__value, third.__value));
+}
+
+Result Result_zipN(const Result *const results, const size_t size, const void **const values,
+                   const void *(*const f)(const void **, size_t)) {
+    Panic_when(NULL == f);
+    const Result all = Result_all(results, size, values);
+    return Result_isError(all) ? all : Result_fromNullable(f(values, size));
+}
+
 Error Result_inspect(const Result self) {
     return self.__error;
 }
@@ -132,6 +132,53 @@ __attribute__((__warn_unused_result__));
 extern Result Result_orElse(Result self, Result f(void))
 __attribute__((__warn_unused_result__));
 
+/**
+ * If every `Result` in results is an `Ok` variant, stores their values in order into values and returns a `Result` wrapping
+ * values, else returns the first `Result` wrapping an `Error` leaving values partially written.
+ *
+ * @attention results must not be `NULL` unless size is 0.
+ * @attention values must not be `NULL`.
+ */
+extern Result Result_all(const Result *results, size_t size, const void **values)
+__attribute__((__warn_unused_result__));
+
+/**
+ * Stores the error of every `Result` in results wrapping an `Error`, in order, into errors and returns how many they are.
+ *
+ * @attention results must not be `NULL` unless size is 0.
+ * @attention errors must not be `NULL` and must have room for size elements.
+ */
+extern size_t Result_collectErrors(const Result *results, size_t size, Error *errors)
+__attribute__((__warn_unused_result__));
+
+/**
+ * If both `Result`s are `Ok` variants, apply `f` on their values and returns a `Result` wrapping the value else returns
+ * the first `Result` wrapping an `Error`.
+ * If f returns `NULL` this function will return a `Result` variant wrapping `NullReferenceError`.
+ *
+ * @attention f must not be `NULL`.
+ */
+extern Result Result_zip2(Result first, Result second, const void *f(const void *, const void *))
+__attribute__((__warn_unused_result__));
+
+/**
+ * Same as `Result_zip2(...)` for three `Result`s.
+ *
+ * @attention f must not be `NULL`.
+ */
+extern Result Result_zip3(Result first, Result second, Result third, const void *f(const void *, const void *, const void *))
+__attribute__((__warn_unused_result__));
+
+/**
+ * Same as `Result_zip2(...)` for size `Result`s, their values are passed to `f` through values.
+ *
+ * @attention results must not be `NULL` unless size is 0.
+ * @attention values must not be `NULL` and must have room for size elements.
+ * @attention f must not be `NULL`.
+ */
+extern Result Result_zipN(const Result *results, size_t size, const void **values, const void *f(const void **, size_t))
+__attribute__((__warn_unused_result__));
+
 /**
  * Returns the error associated to this `Result`.
  */
@@ -168,6 +215,28 @@ __attribute__((__warn_unused_result__));
 #define Result_expectAsMutable(self, ...) \
     __Result_expectAsMutable((__FILE__), (__LINE__), (self), __VA_ARGS__)
 
+/**
+ * Declares `var` bound to the value of the `Result` evaluated from `expr` if it's an `Ok` variant, else returns that
+ * `Result` from the enclosing function, which must return a `Result`.
+ * Unlike `Result_chain(...)` the rest of the computation stays in the enclosing function, where it can be inlined.
+ *
+ * @attention relies on statement expressions, a GNU extension.
+ */
+#define Result_try(var, expr) \
+    const void *const var = __RESULT_TRY(expr)
+
+/**
+ * Same as `Result_try(...)` but `var` is bound to a mutable value.
+ */
+#define Result_tryMut(var, expr) \
+    void *const var = (void *) __RESULT_TRY(expr)
+
+/**
+ * @attention this macro must be treated as opaque therefore must not be used directly.
+ */
+#define __RESULT_TRY(expr) \
+    ({ const Result __result = (expr); if (Ok != __result.__error) return __result; __result.__value; })
+
 /**
 * @attention this function must be treated as opaque therefore must not be called directly.
 */
@@ -0,0 +1,520 @@
+/*
+Author: daddinuz
+email:  daddinuz@gmail.com
+
+Copyright (c) 2018 Davide Di Carlo
+
+Permission is hereby granted, free of charge, to any person
+obtaining a copy of this software and associated documentation
+files (the "Software"), to deal in the Software without
+restriction, including without limitation the rights to use,
+copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be
+included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+OTHER DEALINGS IN THE SOFTWARE.
+ */
+#pragma once
+
+#if __cplusplus < 201703L
+#error "result.hpp requires C++17"
+#endif
+
+#include <new>
+#include <utility>
+#include <type_traits>
+#include <panic/panic.h>
+#include "result.h"
+
+/**
+ * A C++ `Result<T, E>` value type holding either a `T` or an `E`, for C++ code that wants the same error handling style
+ * as the C `Result` without erasing the value type.
+ *
+ * Unlike the C `Result` the value is stored inline, may be of any type including move-only ones, and the combinators
+ * take any callable, lambdas included, so that they can be inlined.
+ * `Result<T *, Error>` has the same layout as the C `Result` and converts to and from it with a plain copy.
+ *
+ * @code
+ * result::Result<double> squareRoot(double x) {
+ *     if (x < 0.0) {
+ *         return result::err(DomainError);
+ *     }
+ *     return result::ok(std::sqrt(x));
+ * }
+ *
+ * const double y = squareRoot(x).map([](double root) { return root * root; }).value_or(0.0);
+ * @endcode
+ *
+ * @attention value and error accessors panic, like `Result_unwrap(...)`, instead of throwing.
+ */
+namespace result {
+
+/**
+ * Wraps a value to be converted into an `Ok` variant, see `result::ok(...)`.
+ */
+template<class T>
+struct Success {
+    T value;
+};
+
+/**
+ * Wraps an error to be converted into an `Error` variant, see `result::err(...)`.
+ */
+template<class E>
+struct Failure {
+    E error;
+};
+
+/**
+ * Returns value wrapped in order to be converted into any `Result` whose value type can be constructed from it.
+ */
+template<class T>
+[[nodiscard]] constexpr Success<std::decay_t<T>> ok(T &&value) {
+    return Success<std::decay_t<T>>{std::forward<T>(value)};
+}
+
+/**
+ * Returns error wrapped in order to be converted into any `Result` whose error type can be constructed from it.
+ */
+template<class E>
+[[nodiscard]] constexpr Failure<std::decay_t<E>> err(E &&error) {
+    return Failure<std::decay_t<E>>{std::forward<E>(error)};
+}
+
+template<class T, class E = Error>
+class Result;
+
+/**
+ * @attention this namespace must be treated as opaque therefore its members must not be used directly.
+ */
+namespace detail {
+
+struct InPlaceValue {
+};
+
+struct InPlaceError {
+};
+
+template<class R>
+struct IsResult : std::false_type {
+};
+
+template<class T, class E>
+struct IsResult<Result<T, E>> : std::true_type {
+};
+
+/*
+ * Both alternatives are trivially copyable: the defaulted members suffice and the whole type stays a literal type.
+ */
+template<class T, class E>
+class TrivialStorage {
+public:
+    template<class U>
+    constexpr TrivialStorage(InPlaceValue, U &&value) : __value(std::forward<U>(value)), __isOk(true) {}
+
+    template<class G>
+    constexpr TrivialStorage(InPlaceError, G &&error) : __error(std::forward<G>(error)), __isOk(false) {}
+
+    constexpr bool isOk() const noexcept { return __isOk; }
+
+    constexpr const T &value() const &noexcept { return __value; }
+
+    constexpr T &&value() &&noexcept { return std::move(__value); }
+
+    constexpr const E &error() const &noexcept { return __error; }
+
+    constexpr E &&error() &&noexcept { return std::move(__error); }
+
+private:
+    union {
+        T __value;
+        E __error;
+    };
+    bool __isOk;
+};
+
+/*
+ * Any other alternative: members are constructed and destroyed by hand.
+ */
+template<class T, class E>
+class Storage {
+public:
+    template<class U>
+    Storage(InPlaceValue, U &&value) : __isOk(true) {
+        new(&__value) T(std::forward<U>(value));
+    }
+
+    template<class G>
+    Storage(InPlaceError, G &&error) : __isOk(false) {
+        new(&__error) E(std::forward<G>(error));
+    }
+
+    Storage(const Storage &other) : __isOk(other.__isOk) {
+        if (__isOk) {
+            new(&__value) T(other.__value);
+        } else {
+            new(&__error) E(other.__error);
+        }
+    }
+
+    Storage(Storage &&other) noexcept(std::is_nothrow_move_constructible_v<T> && std::is_nothrow_move_constructible_v<E>)
+            : __isOk(other.__isOk) {
+        if (__isOk) {
+            new(&__value) T(std::move(other.__value));
+        } else {
+            new(&__error) E(std::move(other.__error));
+        }
+    }
+
+    Storage &operator=(const Storage &other) {
+        if (this == &other) {
+            return *this;
+        }
+        if (__isOk && other.__isOk) {
+            __value = other.__value;
+        } else if (!__isOk && !other.__isOk) {
+            __error = other.__error;
+        } else {
+            Storage copy(other);
+            *this = std::move(copy);
+        }
+        return *this;
+    }
+
+    Storage &operator=(Storage &&other)
+    noexcept(std::is_nothrow_move_assignable_v<T> && std::is_nothrow_move_assignable_v<E>) {
+        // switching alternative destroys the current one before building the other, which therefore must not throw
+        static_assert(std::is_nothrow_move_constructible_v<T> && std::is_nothrow_move_constructible_v<E>,
+                      "assigning a Result requires T and E to be nothrow move constructible");
+        if (this == &other) {
+            return *this;
+        }
+        if (__isOk && other.__isOk) {
+            __value = std::move(other.__value);
+        } else if (!__isOk && !other.__isOk) {
+            __error = std::move(other.__error);
+        } else {
+            this->~Storage();
+            new(this) Storage(std::move(other));
+        }
+        return *this;
+    }
+
+    ~Storage() {
+        if (__isOk) {
+            __value.~T();
+        } else {
+            __error.~E();
+        }
+    }
+
+    bool isOk() const noexcept { return __isOk; }
+
+    const T &value() const &noexcept { return __value; }
+
+    T &&value() &&noexcept { return std::move(__value); }
+
+    const E &error() const &noexcept { return __error; }
+
+    E &&error() &&noexcept { return std::move(__error); }
+
+private:
+    union {
+        T __value;
+        E __error;
+    };
+    bool __isOk;
+};
+
+/*
+ * A pointer and an `Error`: stored as a C `Result`, `Ok` tells the variants apart.
+ */
+template<class T>
+class CStorage {
+public:
+    CStorage(InPlaceValue, T *value) : __result{Ok, value} {
+        if (nullptr == value) {
+            Panic_terminate("%s", "Unable to wrap a NULL value");
+        }
+    }
+
+    CStorage(InPlaceError, Error error) noexcept : __result{error, nullptr} {}
+
+    explicit CStorage(::Result result) noexcept : __result(result) {}
+
+    bool isOk() const noexcept { return Ok == __result.__error; }
+
+    T *value() const noexcept { return const_cast<T *>(static_cast<const T *>(__result.__value)); }
+
+    Error error() const noexcept { return __result.__error; }
+
+    ::Result toC() const noexcept { return __result; }
+
+private:
+    ::Result __result;
+};
+
+template<class T, class E>
+struct StorageOf {
+    using Type = std::conditional_t<
+            std::is_trivially_copyable_v<T> && std::is_trivially_copyable_v<E>, TrivialStorage<T, E>, Storage<T, E>
+    >;
+};
+
+template<class T>
+struct StorageOf<T *, Error> {
+    using Type = std::conditional_t<std::is_object_v<T> || std::is_void_v<T>, CStorage<T>, TrivialStorage<T *, Error>>;
+};
+
+/*
+ * Deletes the copy members of `Result` when the alternatives are move-only.
+ */
+template<bool isCopyable>
+struct CopyGuard {
+};
+
+template<>
+struct CopyGuard<false> {
+    CopyGuard() = default;
+
+    CopyGuard(const CopyGuard &) = delete;
+
+    CopyGuard(CopyGuard &&) = default;
+
+    CopyGuard &operator=(const CopyGuard &) = delete;
+
+    CopyGuard &operator=(CopyGuard &&) = default;
+};
+
+}
+
+/**
+ * Holds a value of type `T` or an error of type `E`.
+ *
+ * Results are built from `result::ok(...)` and `result::err(...)`, with constexpr constructors when both types are
+ * literal types; move-only types are supported and make the result itself move-only.
+ *
+ * @attention when `E` is `Error`, `Ok` must not be used as error.
+ * @attention when `T` is a pointer and `E` is `Error`, the value must not be `nullptr`, as in the C `Result`.
+ * @attention results can be assigned only when `T` and `E` are nothrow move constructible.
+ */
+template<class T, class E>
+class [[nodiscard]] Result : private detail::CopyGuard<std::is_copy_constructible_v<T> && std::is_copy_constructible_v<E>> {
+    static_assert(!std::is_reference_v<T> && !std::is_void_v<T>, "T must be an object type");
+    static_assert(!std::is_reference_v<E> && !std::is_void_v<E>, "E must be an object type");
+
+    using Storage = typename detail::StorageOf<T, E>::Type;
+    using ConstValue = decltype(std::declval<const Storage &>().value());
+    using MovedValue = decltype(std::declval<Storage &&>().value());
+    using ConstError = decltype(std::declval<const Storage &>().error());
+    using MovedError = decltype(std::declval<Storage &&>().error());
+
+public:
+    using value_type = T;
+    using error_type = E;
+
+    template<class U, class = std::enable_if_t<std::is_constructible_v<T, U &&>>>
+    constexpr Result(Success<U> &&success) : __storage(detail::InPlaceValue(), std::move(success.value)) {}
+
+    template<class U, class = std::enable_if_t<std::is_constructible_v<T, const U &>>>
+    constexpr Result(const Success<U> &success) : __storage(detail::InPlaceValue(), success.value) {}
+
+    template<class G, class = std::enable_if_t<std::is_constructible_v<E, G &&>>>
+    constexpr Result(Failure<G> &&failure) : __storage(detail::InPlaceError(), checkError(std::move(failure.error))) {}
+
+    template<class G, class = std::enable_if_t<std::is_constructible_v<E, const G &>>>
+    constexpr Result(const Failure<G> &failure) : __storage(detail::InPlaceError(), checkError(failure.error)) {}
+
+    /**
+     * Converts a C `Result` without copying its value.
+     *
+     * @attention only available when `T` is a pointer and `E` is `Error`.
+     */
+    [[nodiscard]] static Result from_c(::Result result) noexcept {
+        static_assert(std::is_same_v<Storage, detail::CStorage<std::remove_pointer_t<T>>>, "T must be a pointer and E must be Error");
+        return Result(result);
+    }
+
+    /**
+     * Converts to a C `Result` without copying the value, the inverse of `Result::from_c(...)`.
+     *
+     * @attention only available when `T` is a pointer and `E` is `Error`.
+     */
+    [[nodiscard]] ::Result to_c() const noexcept {
+        static_assert(std::is_same_v<Storage, detail::CStorage<std::remove_pointer_t<T>>>, "T must be a pointer and E must be Error");
+        return __storage.toC();
+    }
+
+    /**
+     * Returns `true` if this `Result` is wrapping a value, `false` otherwise.
+     */
+    [[nodiscard]] constexpr bool is_ok() const noexcept { return __storage.isOk(); }
+
+    /**
+     * Returns `true` if this `Result` is wrapping an error, `false` otherwise.
+     */
+    [[nodiscard]] constexpr bool is_error() const noexcept { return !__storage.isOk(); }
+
+    constexpr explicit operator bool() const noexcept { return __storage.isOk(); }
+
+    /**
+     * Returns the value of this `Result` if it's an `Ok` variant or panics if this is an `Error` variant.
+     */
+    [[nodiscard]] constexpr ConstValue value() const & {
+        if (!is_ok()) {
+            Panic_terminate("%s", "Unable to unwrap value");
+        }
+        return __storage.value();
+    }
+
+    [[nodiscard]] constexpr MovedValue value() && {
+        if (!is_ok()) {
+            Panic_terminate("%s", "Unable to unwrap value");
+        }
+        return std::move(__storage).value();
+    }
+
+    /**
+     * Returns the error of this `Result` if it's an `Error` variant or panics if this is an `Ok` variant.
+     */
+    [[nodiscard]] constexpr ConstError error() const & {
+        if (is_ok()) {
+            Panic_terminate("%s", "Unable to unwrap error");
+        }
+        return __storage.error();
+    }
+
+    [[nodiscard]] constexpr MovedError error() && {
+        if (is_ok()) {
+            Panic_terminate("%s", "Unable to unwrap error");
+        }
+        return std::move(__storage).error();
+    }
+
+    /**
+     * Returns the value of this `Result` if it's an `Ok` variant else returns other.
+     */
+    template<class U>
+    [[nodiscard]] constexpr T value_or(U &&other) const & {
+        return is_ok() ? T(__storage.value()) : T(std::forward<U>(other));
+    }
+
+    template<class U>
+    [[nodiscard]] constexpr T value_or(U &&other) && {
+        return is_ok() ? T(std::move(__storage).value()) : T(std::forward<U>(other));
+    }
+
+    /**
+     * If this `Result` is an `Ok` variant, apply `f` on its value and returns a `Result` wrapping the outcome else returns
+     * the error of this `Result`, the counterpart of `Result_map(...)`.
+     * When the outcome is a pointer and the error type is `Error`, a `nullptr` outcome gives `NullReferenceError`.
+     */
+    template<class F>
+    constexpr auto map(F &&f) const & {
+        return mapWith(*this, std::forward<F>(f));
+    }
+
+    template<class F>
+    constexpr auto map(F &&f) && {
+        return mapWith(std::move(*this), std::forward<F>(f));
+    }
+
+    /**
+     * If this `Result` is an `Ok` variant, returns the `Result` of `f` applied on its value else returns the error of this
+     * `Result`, the counterpart of `Result_chain(...)`.
+     *
+     * @attention f must return a `Result` with the same error type.
+     */
+    template<class F>
+    constexpr auto and_then(F &&f) const & {
+        return andThenWith(*this, std::forward<F>(f));
+    }
+
+    template<class F>
+    constexpr auto and_then(F &&f) && {
+        return andThenWith(std::move(*this), std::forward<F>(f));
+    }
+
+    /**
+     * If this `Result` is an `Error` variant, returns the `Result` of `f` applied on its error else returns the value of
+     * this `Result`, the counterpart of `Result_orElse(...)`.
+     *
+     * @attention f must return a `Result` with the same value type.
+     */
+    template<class F>
+    constexpr auto or_else(F &&f) const & {
+        return orElseWith(*this, std::forward<F>(f));
+    }
+
+    template<class F>
+    constexpr auto or_else(F &&f) && {
+        return orElseWith(std::move(*this), std::forward<F>(f));
+    }
+
+private:
+    Storage __storage;
+
+    explicit Result(::Result result) noexcept : __storage(result) {}
+
+    template<class G>
+    static constexpr G &&checkError(G &&error) {
+        if constexpr (std::is_same_v<E, Error>) {
+            if (Ok == error) {
+                Panic_terminate("%s", "Unable to wrap Ok as an error");
+            }
+        }
+        return std::forward<G>(error);
+    }
+
+    template<class Self, class F>
+    static constexpr auto mapWith(Self &&self, F &&f) {
+        using Value = decltype(std::forward<Self>(self).__storage.value());
+        using U = std::decay_t<std::invoke_result_t<F, Value>>;
+        using R = Result<U, E>;
+        if (!self.is_ok()) {
+            return R(Failure<E>{std::forward<Self>(self).__storage.error()});
+        }
+        if constexpr (std::is_pointer_v<U> && std::is_same_v<E, Error>) {
+            const U value = std::forward<F>(f)(std::forward<Self>(self).__storage.value());
+            return nullptr == value ? R(Failure<Error>{NullReferenceError}) : R(Success<U>{value});
+        } else {
+            return R(Success<U>{std::forward<F>(f)(std::forward<Self>(self).__storage.value())});
+        }
+    }
+
+    template<class Self, class F>
+    static constexpr auto andThenWith(Self &&self, F &&f) {
+        using Value = decltype(std::forward<Self>(self).__storage.value());
+        using R = std::decay_t<std::invoke_result_t<F, Value>>;
+        static_assert(detail::IsResult<R>::value, "f must return a result::Result");
+        static_assert(std::is_same_v<typename R::error_type, E>, "f must return a result::Result with the same error type");
+        if (!self.is_ok()) {
+            return R(Failure<E>{std::forward<Self>(self).__storage.error()});
+        }
+        return R(std::forward<F>(f)(std::forward<Self>(self).__storage.value()));
+    }
+
+    template<class Self, class F>
+    static constexpr auto orElseWith(Self &&self, F &&f) {
+        using Reason = decltype(std::forward<Self>(self).__storage.error());
+        using R = std::decay_t<std::invoke_result_t<F, Reason>>;
+        static_assert(detail::IsResult<R>::value, "f must return a result::Result");
+        static_assert(std::is_same_v<typename R::value_type, T>, "f must return a result::Result with the same value type");
+        if (self.is_ok()) {
+            return R(Success<T>{std::forward<Self>(self).__storage.value()});
+        }
+        return R(std::forward<F>(f)(std::forward<Self>(self).__storage.error()));
+    }
+};
+
+}
@@ -0,0 +1,4 @@
+add_executable(cpp ${CMAKE_CURRENT_LIST_DIR}/result.cpp)
+target_link_libraries(cpp PRIVATE result panic)
+
+add_test(cpp cpp)
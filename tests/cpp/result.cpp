@@ -0,0 +1,237 @@
+/*
+Author: daddinuz
+email:  daddinuz@gmail.com
+
+Copyright (c) 2018 Davide Di Carlo
+
+Permission is hereby granted, free of charge, to any person
+obtaining a copy of this software and associated documentation
+files (the "Software"), to deal in the Software without
+restriction, including without limitation the rights to use,
+copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be
+included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*
+ * Checks `result.hpp`: compile-time properties are asserted statically, the rest at runtime through panics.
+ */
+
+#include <memory>
+#include <string>
+#include <fcntl.h>
+#include <setjmp.h>
+#include <unistd.h>
+#include <result.hpp>
+
+/*
+ * Panic trap, expected panics unwind back here instead of aborting
+ */
+static sigjmp_buf trapJumpBuffer;
+
+static void trapCallback(void) {
+    siglongjmp(trapJumpBuffer, 1);
+}
+
+#define trapPanic(expression)                                       \
+    do {                                                            \
+        const int stderrFd = dup(STDERR_FILENO);                    \
+        const int nullFd = open("/dev/null", O_WRONLY);             \
+        dup2(nullFd, STDERR_FILENO);                                \
+        volatile bool panicked = true;                              \
+        Panic_registerCallback(trapCallback);                       \
+        if (0 == sigsetjmp(trapJumpBuffer, 1)) {                    \
+            expression;                                             \
+            panicked = false;                                       \
+        }                                                           \
+        Panic_registerCallback(NULL);                               \
+        dup2(stderrFd, STDERR_FILENO);                              \
+        close(nullFd);                                              \
+        close(stderrFd);                                            \
+        Panic_unless(panicked);                                     \
+    } while (false)
+
+/*
+ * Compile-time
+ */
+constexpr result::Result<int, int> half(const int x) {
+    if (0 != x % 2) {
+        return result::err(x);
+    }
+    return result::ok(x / 2);
+}
+
+static_assert(half(8).and_then(half).map([](int x) { return x + 1; }).value() == 3);
+static_assert(half(6).and_then(half).error() == 3);
+static_assert(half(3).or_else([](int x) { return half(x + 1); }).value() == 2);
+static_assert(half(3).value_or(-1) == -1);
+
+static_assert(sizeof(result::Result<const double *>) == sizeof(::Result));
+static_assert(sizeof(result::Result<void *>) == sizeof(::Result));
+static_assert(std::is_trivially_copyable_v<result::Result<const double *>>);
+static_assert(std::is_trivially_copyable_v<result::Result<double>>);
+static_assert(!std::is_copy_constructible_v<result::Result<std::unique_ptr<int>>>);
+static_assert(std::is_nothrow_move_constructible_v<result::Result<std::unique_ptr<int>>>);
+static_assert(std::is_copy_constructible_v<result::Result<std::string, std::string>>);
+
+/*
+ * Runtime
+ */
+static result::Result<const double *> squareRoot(const double *x) {
+    static double root;
+    if (*x < 0.0) {
+        return result::err(DomainError);
+    }
+    root = *x == 16.0 ? 4.0 : -1.0;
+    return result::ok(static_cast<const double *>(&root));
+}
+
+static Result squareRootC(const void *x) {
+    return squareRoot(static_cast<const double *>(x)).to_c();
+}
+
+static void interoperability(void) {
+    static const double sixteen = 16.0, negative = -1.0;
+
+    const result::Result<const double *> root = result::Result<const double *>::from_c(Result_chain(Result_ok(&sixteen), squareRootC));
+    Panic_unless(root.is_ok() && 4.0 == *root.value());
+
+    const ::Result back = root.to_c();
+    Panic_unless(Result_isOk(back) && root.value() == Result_unwrap(back));
+
+    const result::Result<const double *> failed = result::Result<const double *>::from_c(Result_chain(Result_ok(&negative), squareRootC));
+    Panic_unless(failed.is_error() && DomainError == failed.error());
+    Panic_unless(DomainError == Result_inspect(failed.to_c()));
+
+    double mutableSixteen = sixteen;
+    const result::Result<double *> mutableValue = result::Result<double *>::from_c(Result_ok(&mutableSixteen));
+    Panic_unless(mutableValue.is_ok() && &mutableSixteen == mutableValue.value());
+    *mutableValue.value() = 4.0;
+    Panic_unless(4.0 == mutableSixteen);
+
+    const auto nothing = root.map([](const double *) -> const char * { return nullptr; });
+    Panic_unless(NullReferenceError == nothing.error());
+}
+
+static void combinators(void) {
+    size_t calls = 0;
+    const auto parse = [&calls](const std::string &text) -> result::Result<int, std::string> {
+        calls++;
+        if (text.empty() || text.find_first_not_of("0123456789") != std::string::npos) {
+            return result::err("not a number: " + text);
+        }
+        return result::ok(std::stoi(text));
+    };
+
+    const result::Result<std::string, std::string> text = result::ok(std::string("42"));
+    const result::Result<int, std::string> number = text.and_then(parse).map([](int x) { return x * 2; });
+    Panic_unless(84 == number.value() && 1 == calls);
+
+    const result::Result<std::string, std::string> garbage = result::ok(std::string("4x2"));
+    const result::Result<int, std::string> failed = garbage.and_then(parse).map([&calls](int x) { calls++; return x; });
+    Panic_unless("not a number: 4x2" == failed.error() && 2 == calls);
+
+    const result::Result<int, std::string> recovered = failed.or_else([](const std::string &error) -> result::Result<int, std::string> {
+        return result::ok(static_cast<int>(error.size()));
+    });
+    Panic_unless(17 == recovered.value() && 17 == recovered.value_or(0) && 0 == failed.value_or(0));
+
+    const result::Result<int, std::string> kept = number.or_else([&calls](const std::string &) -> result::Result<int, std::string> {
+        calls++;
+        return result::ok(0);
+    });
+    Panic_unless(84 == kept.value() && 2 == calls);
+
+    /* Copies and assignments of non-trivial alternatives */
+    result::Result<std::string, std::string> copy = text;
+    Panic_unless("42" == copy.value() && "42" == text.value());
+    copy = garbage.and_then(parse).map([](int x) { return std::to_string(x); });
+    Panic_unless("not a number: 4x2" == copy.error());
+    copy = text;
+    Panic_unless("42" == copy.value());
+}
+
+static void moveOnly(void) {
+    result::Result<std::unique_ptr<int>> owner = result::ok(std::make_unique<int>(7));
+    result::Result<std::unique_ptr<int>> moved = std::move(owner);
+    Panic_unless(7 == *moved.value());
+
+    result::Result<std::unique_ptr<long>> widened = std::move(moved).map([](std::unique_ptr<int> x) {
+        return std::make_unique<long>(*x * 6L);
+    });
+    Panic_unless(42 == *widened.value());
+
+    const std::unique_ptr<long> taken = std::move(widened).value();
+    Panic_unless(42 == *taken);
+
+    result::Result<std::unique_ptr<int>> failed = result::err(LookupError);
+    const std::unique_ptr<int> fallback = std::move(failed).value_or(std::make_unique<int>(1));
+    Panic_unless(1 == *fallback);
+}
+
+static void lifetimes(void) {
+    static int alive = 0, assigned = 0;
+    struct Tracked {
+        Tracked() { alive++; }
+
+        Tracked(const Tracked &) { alive++; }
+
+        Tracked(Tracked &&) noexcept { alive++; }
+
+        Tracked &operator=(const Tracked &) {
+            assigned++;
+            return *this;
+        }
+
+        ~Tracked() { alive--; }
+    };
+
+    {
+        result::Result<Tracked> a = result::ok(Tracked());
+        result::Result<Tracked> b = result::err(MathError);
+        result::Result<Tracked> c = a;
+        b = a;
+        a = result::err(DomainError);
+        Panic_unless(0 == assigned);
+        c = std::move(b);
+        Panic_unless(1 == assigned);
+        Panic_unless(2 == alive && a.is_error() && b.is_ok() && c.is_ok());
+        const auto d = c.map([](const Tracked &) { return 0; }).and_then([](int) -> result::Result<Tracked> { return result::ok(Tracked()); });
+        Panic_unless(3 == alive && d.is_ok());
+    }
+    Panic_unless(0 == alive);
+}
+
+static void panics(void) {
+    static const double value = 1.0;
+    const result::Result<int> ok = result::ok(1);
+    const result::Result<int> error = result::err(DomainError);
+
+    trapPanic((void) error.value());
+    trapPanic((void) ok.error());
+    trapPanic((void) result::Result<int>(result::err(Ok)));
+    trapPanic((void) result::Result<const double *>(result::ok(static_cast<const double *>(nullptr))));
+    trapPanic((void) result::Result<const double *>::from_c(Result_error(SystemError)).value());
+
+    Panic_unless(&value == result::Result<const double *>(result::ok(&value)).value());
+}
+
+int main(void) {
+    interoperability();
+    combinators();
+    moveOnly();
+    lifetimes();
+    panics();
+    return 0;
+}
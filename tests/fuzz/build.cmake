@@ -0,0 +1,12 @@
+option(RESULT_FUZZER "Build the fuzz target against libFuzzer (requires clang)" OFF)
+
+add_executable(fuzz ${CMAKE_CURRENT_LIST_DIR}/fuzz.c)
+target_link_libraries(fuzz PRIVATE result panic)
+
+if (RESULT_FUZZER)
+    target_compile_definitions(fuzz PRIVATE RESULT_FUZZER=1)
+    target_compile_options(fuzz PRIVATE -fsanitize=fuzzer,address,undefined)
+    set_target_properties(fuzz PROPERTIES LINK_FLAGS "-fsanitize=fuzzer,address,undefined")
+else ()
+    add_test(fuzz fuzz)
+endif (RESULT_FUZZER)
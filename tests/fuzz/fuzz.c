@@ -0,0 +1,335 @@
+/*
+Author: daddinuz
+email:  daddinuz@gmail.com
+
+Copyright (c) 2018 Davide Di Carlo
+
+Permission is hereby granted, free of charge, to any person
+obtaining a copy of this software and associated documentation
+files (the "Software"), to deal in the Software without
+restriction, including without limitation the rights to use,
+copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be
+included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * Fuzz target for the Result API.
+ *
+ * Input bytes are interpreted as a program for a small stack machine whose values are results; every instruction
+ * builds, combines or checks results and the algebraic laws of the combinators are asserted along the way.
+ * Builds as a libFuzzer target when RESULT_FUZZER is defined, otherwise as a standalone driver suitable for AFL
+ * (`fuzz <file>...`) which, when invoked without arguments, runs a deterministic batch of pseudo-random programs.
+ */
+
+#include <stdio.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <setjmp.h>
+#include <unistd.h>
+#include <result.h>
+#include <panic/panic.h>
+
+#define CELLS_SIZE              16
+#define STACK_CAPACITY          32
+#define RANDOM_PROGRAMS         4096
+#define RANDOM_PROGRAM_SIZE     256
+
+/*
+ * Values and errors
+ */
+static int cells[CELLS_SIZE];
+
+static Error *errors[] = {
+        &DomainError, &IllegalState, &LookupError, &MathError, &MemoryError,
+        &NullReferenceError, &OutOfMemory, &SystemError, &StopIteration
+};
+
+#define ERRORS_SIZE             (sizeof(errors) / sizeof(errors[0]))
+
+static const int *nextCell(const void *value) {
+    return &cells[((const int *) value - cells + 1) % CELLS_SIZE];
+}
+
+/*
+ * Functions plugged into the combinators, calls are counted in order to check short-circuiting
+ */
+static size_t calls = 0;
+
+static const void *mapIdentity(const void *value) {
+    calls++;
+    return value;
+}
+
+static const void *mapNext(const void *value) {
+    calls++;
+    return nextCell(value);
+}
+
+static const void *mapNull(const void *value) {
+    calls++;
+    (void) value;
+    return NULL;
+}
+
+static Result chainOk(const void *value) {
+    calls++;
+    return Result_ok(value);
+}
+
+static Result chainNext(const void *value) {
+    calls++;
+    return Result_ok(nextCell(value));
+}
+
+static Result chainError(const void *value) {
+    calls++;
+    return Result_error(*errors[((const int *) value - cells) % ERRORS_SIZE]);
+}
+
+static Result orElseOk(void) {
+    calls++;
+    return Result_ok(&cells[0]);
+}
+
+static Result orElseError(void) {
+    calls++;
+    return Result_error(LookupError);
+}
+
+static const void *(*const maps[])(const void *) = {mapIdentity, mapNext, mapNull};
+static Result (*const chains[])(const void *) = {chainOk, chainNext, chainError};
+static Result (*const orElses[])(void) = {orElseOk, orElseError};
+
+#define MAPS_SIZE               (sizeof(maps) / sizeof(maps[0]))
+#define CHAINS_SIZE             (sizeof(chains) / sizeof(chains[0]))
+#define OR_ELSES_SIZE           (sizeof(orElses) / sizeof(orElses[0]))
+
+/*
+ * Compositions used by the associativity laws, operands are selected through globals
+ */
+static const void *(*composedMapF)(const void *) = NULL;
+static const void *(*composedMapG)(const void *) = NULL;
+static Result (*composedChainF)(const void *) = NULL;
+static Result (*composedChainG)(const void *) = NULL;
+
+static const void *composedMap(const void *value) {
+    const void *intermediate = composedMapF(value);
+    return (NULL == intermediate) ? NULL : composedMapG(intermediate);
+}
+
+static Result composedChain(const void *value) {
+    return Result_chain(composedChainF(value), composedChainG);
+}
+
+/*
+ * Panic trap, expected panics unwind back here instead of aborting
+ */
+static sigjmp_buf trapJumpBuffer;
+static Result resultSink;
+static const void *valueSink;
+
+static void trapCallback(void) {
+    siglongjmp(trapJumpBuffer, 1);
+}
+
+#define trapPanic(expression)                                       \
+    do {                                                            \
+        const int stderrFd = dup(STDERR_FILENO);                    \
+        const int nullFd = open("/dev/null", O_WRONLY);             \
+        dup2(nullFd, STDERR_FILENO);                                \
+        volatile bool panicked = true;                              \
+        Panic_registerCallback(trapCallback);                       \
+        if (0 == sigsetjmp(trapJumpBuffer, 1)) {                    \
+            expression;                                             \
+            panicked = false;                                       \
+        }                                                           \
+        Panic_registerCallback(NULL);                               \
+        dup2(stderrFd, STDERR_FILENO);                              \
+        close(nullFd);                                              \
+        close(stderrFd);                                            \
+        Panic_unless(panicked);                                     \
+    } while (false)
+
+/*
+ * Laws
+ */
+static bool equals(const Result a, const Result b) {
+    return Result_inspect(a) == Result_inspect(b) && (Result_isError(a) || Result_unwrap(a) == Result_unwrap(b));
+}
+
+static void checkFunctorLaws(const Result m, const size_t f, const size_t g) {
+    size_t before = calls;
+    if (Result_isError(m)) {
+        Panic_unless(equals(m, Result_map(m, maps[f])) && before == calls);
+        return;
+    }
+    Panic_unless(equals(m, Result_map(m, mapIdentity)));
+    composedMapF = maps[f];
+    composedMapG = maps[g];
+    Panic_unless(equals(Result_map(Result_map(m, maps[f]), maps[g]), Result_map(m, composedMap)));
+}
+
+static void checkMonadLaws(const Result m, const size_t f, const size_t g) {
+    size_t before = calls;
+    if (Result_isError(m)) {
+        Panic_unless(equals(m, Result_chain(m, chains[f])) && before == calls);
+    } else {
+        const void *value = Result_unwrap(m);
+        Panic_unless(equals(Result_chain(Result_ok(value), chains[f]), chains[f](value)));
+    }
+    Panic_unless(equals(m, Result_chain(m, chainOk)));
+    composedChainF = chains[f];
+    composedChainG = chains[g];
+    Panic_unless(equals(Result_chain(Result_chain(m, chains[f]), chains[g]), Result_chain(m, composedChain)));
+}
+
+static void checkAlternativeLaws(const Result a, const Result b, const Result c, const size_t h) {
+    Panic_unless(equals(Result_alt(Result_alt(a, b), c), Result_alt(a, Result_alt(b, c))));
+    Panic_unless(equals(Result_alt(Result_error(DomainError), a), a));
+    size_t before = calls;
+    if (Result_isOk(a)) {
+        Panic_unless(equals(Result_alt(a, b), a));
+        Panic_unless(equals(Result_orElse(a, orElses[h]), a) && before == calls);
+    } else {
+        Panic_unless(equals(Result_alt(a, b), b));
+        Panic_unless(equals(Result_orElse(a, orElses[h]), orElses[h]()));
+    }
+}
+
+static void checkPanics(const Result m, const size_t selector) {
+    switch (selector % 4) {
+        case 0:
+            trapPanic(resultSink = Result_ok(NULL));
+            break;
+        case 1:
+            trapPanic(resultSink = Result_error(Ok));
+            break;
+        case 2:
+            if (Result_isError(m)) {
+                trapPanic(valueSink = Result_unwrap(m));
+            }
+            break;
+        default:
+            if (Result_isError(m)) {
+                trapPanic(valueSink = Result_expect(m, "%s", "expected"));
+            }
+            break;
+    }
+}
+
+/*
+ * Interpreter
+ */
+static void run(const uint8_t *data, size_t size) {
+    Result stack[STACK_CAPACITY];
+    size_t top = 0;
+
+    for (size_t i = 0; i + 1 < size; i += 2) {
+        const uint8_t opcode = data[i], operand = data[i + 1];
+        const Result peek = (top > 0) ? stack[top - 1] : Result_ok(&cells[operand % CELLS_SIZE]);
+
+        switch (opcode % 9) {
+            case 0:
+                if (top < STACK_CAPACITY) {
+                    stack[top++] = Result_ok(&cells[operand % CELLS_SIZE]);
+                }
+                break;
+            case 1:
+                if (top < STACK_CAPACITY) {
+                    stack[top++] = Result_error(*errors[operand % ERRORS_SIZE]);
+                }
+                break;
+            case 2:
+                if (top > 0) {
+                    stack[top - 1] = Result_map(peek, maps[operand % MAPS_SIZE]);
+                }
+                break;
+            case 3:
+                if (top > 0) {
+                    stack[top - 1] = Result_chain(peek, chains[operand % CHAINS_SIZE]);
+                }
+                break;
+            case 4:
+                if (top > 1) {
+                    top--;
+                    stack[top - 1] = Result_alt(stack[top - 1], stack[top]);
+                }
+                break;
+            case 5:
+                if (top > 0) {
+                    stack[top - 1] = Result_orElse(peek, orElses[operand % OR_ELSES_SIZE]);
+                }
+                break;
+            case 6:
+                checkFunctorLaws(peek, operand % MAPS_SIZE, (operand / MAPS_SIZE) % MAPS_SIZE);
+                checkMonadLaws(peek, operand % CHAINS_SIZE, (operand / CHAINS_SIZE) % CHAINS_SIZE);
+                break;
+            case 7:
+                if (top > 2) {
+                    checkAlternativeLaws(stack[top - 1], stack[top - 2], stack[top - 3], operand % OR_ELSES_SIZE);
+                }
+                break;
+            default:
+                checkPanics(peek, operand);
+                break;
+        }
+    }
+}
+
+#if defined(RESULT_FUZZER)
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+    run(data, size);
+    return 0;
+}
+
+#else
+
+static uint32_t nextRandom(uint32_t *state) {
+    /* xorshift32, deterministic across platforms */
+    *state ^= *state << 13;
+    *state ^= *state >> 17;
+    *state ^= *state << 5;
+    return *state;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc > 1) {
+        /* Replay the given inputs, this is the entry point used by AFL */
+        for (int i = 1; i < argc; i++) {
+            FILE *stream = fopen(argv[i], "rb");
+            Panic_when(NULL == stream);
+            uint8_t data[1 << 16];
+            const size_t size = fread(data, 1, sizeof(data), stream);
+            fclose(stream);
+            run(data, size);
+        }
+    } else {
+        uint8_t data[RANDOM_PROGRAM_SIZE];
+        uint32_t state = 0x2545F491;
+        for (size_t i = 0; i < RANDOM_PROGRAMS; i++) {
+            for (size_t j = 0; j < sizeof(data); j++) {
+                data[j] = (uint8_t) nextRandom(&state);
+            }
+            run(data, sizeof(data));
+        }
+    }
+    return 0;
+}
+
+#endif
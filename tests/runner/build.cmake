@@ -0,0 +1,10 @@
+add_executable(runner-subject ${CMAKE_CURRENT_LIST_DIR}/subject.c)
+target_link_libraries(runner-subject PRIVATE traits-unit)
+
+add_executable(runner-sandbox ${CMAKE_CURRENT_LIST_DIR}/sandbox.c)
+target_link_libraries(runner-sandbox PRIVATE traits-unit)
+
+add_executable(runner ${CMAKE_CURRENT_LIST_DIR}/runner.c)
+target_link_libraries(runner PRIVATE panic)
+
+add_test(NAME runner COMMAND runner $<TARGET_FILE:runner-subject> $<TARGET_FILE:runner-sandbox>)
@@ -0,0 +1,382 @@
+/*
+Author: daddinuz
+email:  daddinuz@gmail.com
+
+Copyright (c) 2018 Davide Di Carlo
+
+Permission is hereby granted, free of charge, to any person
+obtaining a copy of this software and associated documentation
+files (the "Software"), to deal in the Software without
+restriction, including without limitation the rights to use,
+copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be
+included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * Tests for the traits-unit runner.
+ *
+ * The subjects built alongside are run with different command lines and their reports are checked, so that the options
+ * are exercised the way a user would pass them: `runner <path-to-subject> <path-to-sandbox>`.
+ */
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <panic/panic.h>
+
+#define COMMAND_CAPACITY        4096
+#define PATH_CAPACITY           256
+#define FLOOD_SIZE              (1024 * 1024)
+
+static const char *subject = NULL;
+static const char *sandbox = NULL;
+static char directory[] = "/tmp/traits-unit-runner-XXXXXX";
+
+/*
+ * Helpers
+ */
+static char *run(const char *program, int *status, const char *format, ...)
+__attribute__((__format__(__printf__, 3, 4)));
+
+static char *run(const char *program, int *status, const char *format, ...) {
+    char arguments[COMMAND_CAPACITY], command[2 * COMMAND_CAPACITY];
+    va_list args;
+    va_start(args, format);
+    vsnprintf(arguments, sizeof(arguments), format, args);
+    va_end(args);
+    snprintf(command, sizeof(command), "'%s' %s 2>&1", program, arguments);
+
+    FILE *stream = popen(command, "r");
+    Panic_when(NULL == stream);
+    char *output = NULL;
+    size_t size = 0;
+    FILE *sink = open_memstream(&output, &size);
+    Panic_when(NULL == sink);
+    for (int c; EOF != (c = fgetc(stream));) {
+        fputc(c, sink);
+    }
+    fclose(sink);
+
+    const int result = pclose(stream);
+    Panic_unless(WIFEXITED(result));
+    *status = WEXITSTATUS(result);
+    return output;
+}
+
+static size_t count(const char *haystack, const char *needle) {
+    size_t counter = 0;
+    for (const char *cursor = haystack; NULL != (cursor = strstr(cursor, needle)); cursor += strlen(needle)) {
+        counter++;
+    }
+    return counter;
+}
+
+static void path(char *buffer, const char *name) {
+    snprintf(buffer, PATH_CAPACITY, "%s/%s", directory, name);
+}
+
+static void writeFile(const char *name, const char *content) {
+    char buffer[PATH_CAPACITY];
+    path(buffer, name);
+    FILE *stream = fopen(buffer, "w");
+    Panic_when(NULL == stream);
+    fputs(content, stream);
+    fclose(stream);
+}
+
+static char *readFile(const char *name) {
+    char buffer[PATH_CAPACITY];
+    path(buffer, name);
+    FILE *stream = fopen(buffer, "r");
+    Panic_when(NULL == stream);
+    char *content = NULL;
+    size_t size = 0;
+    FILE *sink = open_memstream(&content, &size);
+    Panic_when(NULL == sink);
+    for (int c; EOF != (c = fgetc(stream));) {
+        fputc(c, sink);
+    }
+    fclose(sink);
+    fclose(stream);
+    return content;
+}
+
+static void removeFile(const char *name) {
+    char buffer[PATH_CAPACITY];
+    path(buffer, name);
+    Panic_unless(0 == unlink(buffer));
+}
+
+/*
+ * Checks
+ */
+static void checkDefault(void) {
+    int status = -1;
+    char *output = run(subject, &status, "%s", "");
+    Panic_unless(EXIT_SUCCESS == status);
+    Panic_unless(1 == count(output, "Trait: Alpha\n") && 1 == count(output, "Trait: Beta\n"));
+    Panic_unless(5 == count(output, "... succeed\n"));
+    Panic_unless(1 == count(output, "    All: 5\n"));
+    free(output);
+}
+
+static void checkTraits(void) {
+    int status = -1;
+    char *output = run(subject, &status, "%s", "Beta");
+    Panic_unless(EXIT_SUCCESS == status);
+    Panic_unless(0 == count(output, "Trait: Alpha\n") && 1 == count(output, "Trait: Beta\n"));
+    Panic_unless(1 == count(output, "    All: 2\n"));
+    free(output);
+
+    output = run(subject, &status, "%s", "Gamma");
+    Panic_unless(EXIT_FAILURE == status);
+    Panic_unless(1 == count(output, "Unknown trait: `Gamma`\n"));
+    free(output);
+}
+
+static void checkFilter(void) {
+    int status = -1;
+    char *output = run(subject, &status, "%s", "--filter 'T*'");
+    Panic_unless(EXIT_SUCCESS == status);
+    Panic_unless(1 == count(output, "Feature: Third... succeed\n"));
+    Panic_unless(1 == count(output, "Feature: ") && 0 == count(output, "Trait: Beta\n"));
+    Panic_unless(1 == count(output, "    All: 1\n"));
+    free(output);
+
+    /* A filter that matches nothing is not an error */
+    output = run(subject, &status, "%s", "--filter Nothing");
+    Panic_unless(EXIT_SUCCESS == status);
+    Panic_unless(0 == count(output, "Trait: ") && 1 == count(output, "    All: 0\n"));
+    free(output);
+
+    output = run(subject, &status, "%s", "--filter");
+    Panic_unless(EXIT_FAILURE == status);
+    Panic_unless(1 == count(output, "Missing argument for option: `--filter`\n"));
+    free(output);
+}
+
+static void checkShard(void) {
+    int status = -1;
+
+    /* Without timings every feature weighs the same and they are dealt in declaration order */
+    char *output = run(subject, &status, "%s", "--shard 1/2");
+    Panic_unless(EXIT_SUCCESS == status);
+    Panic_unless(1 == count(output, "Feature: First... ") && 1 == count(output, "Feature: Third... "));
+    Panic_unless(1 == count(output, "Feature: Light... ") && 3 == count(output, "Feature: "));
+    free(output);
+
+    output = run(subject, &status, "%s", "--shard 2/2");
+    Panic_unless(EXIT_SUCCESS == status);
+    Panic_unless(1 == count(output, "Feature: Second... ") && 1 == count(output, "Feature: Heavy... "));
+    Panic_unless(2 == count(output, "Feature: "));
+    free(output);
+
+    /* Shards may outnumber the features, the exceeding ones run nothing */
+    output = run(subject, &status, "%s", "--shard 6/6");
+    Panic_unless(EXIT_SUCCESS == status);
+    Panic_unless(0 == count(output, "Feature: ") && 1 == count(output, "    All: 0\n"));
+    free(output);
+
+    output = run(subject, &status, "%s", "--shard 4294967295/4294967295");
+    Panic_unless(EXIT_SUCCESS == status);
+    Panic_unless(0 == count(output, "Feature: "));
+    free(output);
+
+    /* Shards combine with the filter, the partition is computed over the selected features only */
+    output = run(subject, &status, "%s", "--filter '*i*' --shard 2/2");
+    Panic_unless(EXIT_SUCCESS == status);
+    Panic_unless(1 == count(output, "Feature: Third... ") && 1 == count(output, "Feature: "));
+    free(output);
+}
+
+static void checkMalformedShard(void) {
+    const char *shards[] = {
+            "0/2", "3/2", "1/0", "0/0", "-1/2", "1/-1", "-1/-1", "+1/2", "' 1/2'", "'1/ 2'", "1/2x", "1/2/3",
+            "1", "/2", "1/", "a/b", "''", "18446744073709551616/18446744073709551616"
+    };
+    for (size_t i = 0; i < sizeof(shards) / sizeof(shards[0]); i++) {
+        int status = -1;
+        char *output = run(subject, &status, "--shard %s", shards[i]);
+        Panic_unless(EXIT_FAILURE == status);
+        Panic_unless(1 == count(output, "Invalid shard: `") && 0 == count(output, "Feature: "));
+        free(output);
+    }
+}
+
+static void checkTimings(void) {
+    int status = -1;
+    char timings[PATH_CAPACITY];
+    path(timings, "timings");
+
+    /* Records of features that did not run are kept, the others are added or updated */
+    writeFile("timings", "5.000000000\tGamma\tGone\n7.000000000\tBeta\tHeavy\n");
+    char *output = run(subject, &status, "--filter 'H*' --record-timings '%s'", timings);
+    Panic_unless(EXIT_SUCCESS == status);
+    free(output);
+    char *content = readFile("timings");
+    Panic_unless(1 == count(content, "5.000000000\tGamma\tGone\n"));
+    Panic_unless(1 == count(content, "\tBeta\tHeavy\n") && 0 == count(content, "7.000000000\tBeta\tHeavy\n"));
+    Panic_unless(0 == count(content, "\tAlpha\t") && 2 == count(content, "\n"));
+    free(content);
+
+    output = run(subject, &status, "--record-timings '%s'", timings);
+    Panic_unless(EXIT_SUCCESS == status);
+    free(output);
+    content = readFile("timings");
+    Panic_unless(3 == count(content, "\tAlpha\t") && 2 == count(content, "\tBeta\t") && 6 == count(content, "\n"));
+    free(content);
+
+    /* Longest first: the heaviest feature gets a shard on its own, the others share the remaining one */
+    writeFile("timings", "10\tBeta\tHeavy\n1\tAlpha\tFirst\n1\tAlpha\tSecond\n1\tAlpha\tThird\n1\tBeta\tLight\n");
+    output = run(subject, &status, "--timings '%s' --shard 1/2", timings);
+    Panic_unless(EXIT_SUCCESS == status);
+    Panic_unless(1 == count(output, "Feature: Heavy... ") && 1 == count(output, "Feature: "));
+    Panic_unless(0 == count(output, "Trait: Alpha\n"));
+    free(output);
+
+    output = run(subject, &status, "--timings '%s' --shard 2/2", timings);
+    Panic_unless(EXIT_SUCCESS == status);
+    Panic_unless(0 == count(output, "Feature: Heavy... ") && 4 == count(output, "Feature: "));
+    free(output);
+
+    /* Features without a record weigh as much as the average recorded one */
+    writeFile("timings", "4\tBeta\tHeavy\n2\tAlpha\tFirst\n");
+    output = run(subject, &status, "--timings '%s' --shard 1/2", timings);
+    Panic_unless(EXIT_SUCCESS == status);
+    Panic_unless(1 == count(output, "Feature: Heavy... ") && 1 == count(output, "Feature: Light... "));
+    Panic_unless(2 == count(output, "Feature: "));
+    free(output);
+    removeFile("timings");
+
+    /* A missing timings file means no records */
+    output = run(subject, &status, "--timings '%s' --shard 1/2", timings);
+    Panic_unless(EXIT_SUCCESS == status);
+    Panic_unless(3 == count(output, "Feature: "));
+    free(output);
+}
+
+static void checkInProcess(void) {
+    int status = -1;
+
+    /* By default every feature runs in a forked process */
+    char *output = run(sandbox, &status, "%s", "Assertion");
+    Panic_unless(EXIT_FAILURE == status);
+    Panic_unless(4 == count(output, " ran forked>") && 0 == count(output, " ran in-process>"));
+    Panic_unless(1 == count(output, "<Fails ran forked>failed\n") && 1 == count(output, "Failed on purpose.\n"));
+    Panic_unless(3 == count(output, " ran forked>succeed\n"));
+    free(output);
+
+    /*
+     * The failed assertion unwinds back to the runner through the hook instead of exiting: the failing feature is run
+     * again forked in order to report its output, and so are the ones after it since the process can't be trusted.
+     */
+    output = run(sandbox, &status, "%s", "--in-process Assertion");
+    Panic_unless(EXIT_FAILURE == status);
+    Panic_unless(1 == count(output, "<Passes ran in-process>") && 1 == count(output, "<Isolates ran forked>"));
+    Panic_unless(1 == count(output, "<Fails ran in-process>") && 1 == count(output, "<Fails ran forked>"));
+    Panic_unless(1 == count(output, "<After ran forked>") && 0 == count(output, "<After ran in-process>"));
+    Panic_unless(1 == count(output, "<Fails ran forked>failed\n") && 1 == count(output, "Failed on purpose.\n"));
+    Panic_unless(1 == count(output, " Failed: 1\n") && 1 == count(output, "    All: 4\n"));
+    free(output);
+
+    /* Crashes are trapped the same way */
+    output = run(sandbox, &status, "%s", "--in-process Signal");
+    Panic_unless(EXIT_FAILURE == status);
+    Panic_unless(1 == count(output, "<Crashes ran in-process>") && 1 == count(output, "<Crashes ran forked>"));
+    Panic_unless(1 == count(output, "<Crashes ran forked>") && 1 == count(output, " Failed: 1\n"));
+    Panic_unless(1 == count(output, "<Survives ran forked>succeed\n"));
+    free(output);
+
+    /* Isolated features are always forked */
+    output = run(sandbox, &status, "%s", "--in-process --filter Isolates Assertion");
+    Panic_unless(EXIT_SUCCESS == status);
+    Panic_unless(1 == count(output, "<Isolates ran forked>") && 1 == count(output, "    All: 1\n"));
+    free(output);
+}
+
+static void checkWrappedSignals(void) {
+    int status = -1;
+
+    /* Wrapped signals are counted per feature, whether it runs in-process or in a worker forked afterwards */
+    char *output = run(sandbox, &status, "%s", "--in-process Counter");
+    Panic_unless(EXIT_SUCCESS == status);
+    Panic_unless(2 == count(output, "<Wraps ran in-process>succeed\n"));
+    Panic_unless(1 == count(output, "<Wraps ran forked>succeed\n"));
+    free(output);
+}
+
+static void checkPipe(void) {
+    int status = -1;
+
+    /* A feature writing more than a pipe can hold must not stall the runner */
+    char *output = run(sandbox, &status, "%s", "Pipe");
+    Panic_unless(EXIT_SUCCESS == status);
+    Panic_unless(1 == count(output, "Feature: Floods... succeed\n"));
+    free(output);
+}
+
+static void checkOutput(void) {
+    int status = -1;
+
+    /* The output of a failing feature is reported truncated in the middle */
+    char *output = run(sandbox, &status, "%s", "Output");
+    Panic_unless(EXIT_FAILURE == status);
+    Panic_unless(1 == count(output, "<head>\n") && 1 == count(output, "\n<tail>\n"));
+    Panic_unless(1 == count(output, "Failed noisily.\n") && 1 == count(output, " bytes omitted ...]\n"));
+    Panic_unless(strlen(output) < 3 * 4096 && 0 == count(output, "Full output: "));
+    free(output);
+
+    /* With a spill directory the whole output of each failing feature is kept, named after its trait and feature */
+    output = run(sandbox, &status, "--spill-output '%s' Output Output/Twin Pipe", directory);
+    Panic_unless(EXIT_FAILURE == status);
+    Panic_unless(2 == count(output, " bytes omitted ...]\n") && 2 == count(output, "Full output: "));
+    Panic_unless(1 == count(output, "/Output.Noisy.log\n") && 1 == count(output, "/Output_Twin.Noisy.log\n"));
+    free(output);
+
+    const char *logs[] = {"Output.Noisy.log", "Output_Twin.Noisy.log"};
+    for (size_t i = 0; i < sizeof(logs) / sizeof(logs[0]); i++) {
+        char *content = readFile(logs[i]);
+        Panic_unless(1 == count(content, "<head>\n") && 1 == count(content, "\n<tail>\n"));
+        Panic_unless(1 == count(content, "Failed noisily.\n") && 0 == count(content, " bytes omitted ...]\n"));
+        Panic_unless(strlen(content) > FLOOD_SIZE / 16);
+        free(content);
+        removeFile(logs[i]);
+    }
+}
+
+int main(int argc, char *argv[]) {
+    Panic_unless(3 == argc);
+    subject = argv[1];
+    sandbox = argv[2];
+    Panic_when(NULL == mkdtemp(directory));
+
+    checkDefault();
+    checkTraits();
+    checkFilter();
+    checkShard();
+    checkMalformedShard();
+    checkTimings();
+    checkInProcess();
+    checkWrappedSignals();
+    checkPipe();
+    checkOutput();
+
+    Panic_unless(0 == rmdir(directory));
+    return 0;
+}
@@ -0,0 +1,125 @@
+/*
+Author: daddinuz
+email:  daddinuz@gmail.com
+
+Copyright (c) 2018 Davide Di Carlo
+
+Permission is hereby granted, free of charge, to any person
+obtaining a copy of this software and associated documentation
+files (the "Software"), to deal in the Software without
+restriction, including without limitation the rights to use,
+copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be
+included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * Subject run by the runner tests, its features report how they have been run and some of them fail on purpose.
+ */
+
+#include <stdio.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <traits/traits.h>
+#include <traits-unit/traits-unit.h>
+
+#define FLOOD_SIZE      (1024 * 1024)
+
+static pid_t runner = 0;
+
+__attribute__((__constructor__)) static void recordRunner(void) {
+    runner = getpid();
+}
+
+static void report(const char *name) {
+    printf("<%s ran %s>", name, getpid() == runner ? "in-process" : "forked");
+    fflush(stdout);
+}
+
+Feature(Passes) {
+    report("Passes");
+}
+
+Feature(Isolates) {
+    report("Isolates");
+}
+
+Feature(Fails) {
+    report("Fails");
+    assert_true(false, "Failed on purpose.\n");
+}
+
+Feature(After) {
+    report("After");
+}
+
+Feature(Crashes) {
+    report("Crashes");
+    raise(SIGSEGV);
+}
+
+Feature(Survives) {
+    report("Survives");
+}
+
+Feature(Wraps) {
+    report("Wraps");
+    traits_unit_wraps(SIGABRT) {
+        abort();
+    }
+    assert_equal(1, traits_unit_get_wrapped_signals_counter(), "Counted wrapped signals of other features.\n");
+}
+
+Feature(Floods) {
+    /* Far more than a pipe can hold, the runner has to drain it while the feature is running */
+    static char line[128];
+    memset(line, '.', sizeof(line) - 1);
+    line[sizeof(line) - 2] = '\n';
+    for (size_t written = 0; written < FLOOD_SIZE; written += sizeof(line) - 1) {
+        fputs(line, stderr);
+    }
+}
+
+Feature(Noisy) {
+    /* Only the first and the last bytes of the output of a failing feature are reported */
+    fputs("<head>\n", stderr);
+    for (size_t written = 0; written < FLOOD_SIZE / 16; written++) {
+        fputc('.', stderr);
+    }
+    fputs("\n<tail>\n", stderr);
+    assert_true(false, "Failed noisily.\n");
+}
+
+Describe("Sandbox",
+         Trait("Assertion",
+               Run(Passes),
+               Isolated(Isolates),
+               Run(Fails),
+               Run(After)),
+         Trait("Signal",
+               Run(Crashes),
+               Run(Survives)),
+         Trait("Counter",
+               Run(Wraps),
+               Isolated(Wraps),
+               Run(Wraps)),
+         Trait("Pipe",
+               Run(Floods)),
+         Trait("Output",
+               Run(Noisy)),
+         Trait("Output/Twin",
+               Run(Noisy)))
@@ -0,0 +1,62 @@
+/*
+Author: daddinuz
+email:  daddinuz@gmail.com
+
+Copyright (c) 2018 Davide Di Carlo
+
+Permission is hereby granted, free of charge, to any person
+obtaining a copy of this software and associated documentation
+files (the "Software"), to deal in the Software without
+restriction, including without limitation the rights to use,
+copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be
+included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * Subject run by the runner tests, its features do nothing on their own: what matters is how they get selected.
+ */
+
+#include <traits/traits.h>
+#include <traits-unit/traits-unit.h>
+
+Feature(First) {
+    assert_true(true);
+}
+
+Feature(Second) {
+    assert_true(true);
+}
+
+Feature(Third) {
+    assert_true(true);
+}
+
+Feature(Heavy) {
+    assert_true(true);
+}
+
+Feature(Light) {
+    assert_true(true);
+}
+
+Describe("Runner",
+         Trait("Alpha",
+               Run(First),
+               Run(Second),
+               Run(Third)),
+         Trait("Beta",
+               Run(Heavy),
+               Run(Light)))
@@ -1,4 +1,23 @@
-add_library(features ${CMAKE_CURRENT_LIST_DIR}/features.h ${CMAKE_CURRENT_LIST_DIR}/features.c)
+add_library(features
+        ${CMAKE_CURRENT_LIST_DIR}/features.h
+        ${CMAKE_CURRENT_LIST_DIR}/features.c
+        ${CMAKE_CURRENT_LIST_DIR}/result-future.c
+        ${CMAKE_CURRENT_LIST_DIR}/result-parallel.c
+        ${CMAKE_CURRENT_LIST_DIR}/result-channel.c
+        ${CMAKE_CURRENT_LIST_DIR}/result-pipeline.c
+        ${CMAKE_CURRENT_LIST_DIR}/result-thunk.c
+        ${CMAKE_CURRENT_LIST_DIR}/result-match.c
+        ${CMAKE_CURRENT_LIST_DIR}/result-cache.c
+        ${CMAKE_CURRENT_LIST_DIR}/result-retry.c
+        ${CMAKE_CURRENT_LIST_DIR}/result-breaker.c
+        ${CMAKE_CURRENT_LIST_DIR}/result-deadline.c
+        ${CMAKE_CURRENT_LIST_DIR}/result-cancel.c
+        ${CMAKE_CURRENT_LIST_DIR}/result-io.c
+        ${CMAKE_CURRENT_LIST_DIR}/result-io-batch.c
+        ${CMAKE_CURRENT_LIST_DIR}/result-archive.c
+        ${CMAKE_CURRENT_LIST_DIR}/result-ring.c
+        ${CMAKE_CURRENT_LIST_DIR}/result-reactor.c
+        ${CMAKE_CURRENT_LIST_DIR}/result-async.c)
 target_link_libraries(features PRIVATE result traits-unit)
 
 add_executable(describe ${CMAKE_CURRENT_LIST_DIR}/describe.c)
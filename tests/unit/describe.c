@@ -37,7 +37,76 @@ Describe("Result",
                Run(Result_chain),
                Run(Result_alt),
                Run(Result_orElse),
+               Run(Result_all),
+               Run(Result_collectErrors),
+               Run(Result_zip2),
+               Run(Result_zip3),
+               Run(Result_zipN),
+               Run(Result_try),
+               Run(Result_tryMut),
                Run(Result_unwrap),
                Run(Result_unwrapAsMutable),
                Run(Result_expect),
-               Run(Result_expectAsMutable)))
+               Run(Result_expectAsMutable)),
+         Trait("ResultFuture",
+               Run(ResultFuture_spawn),
+               Run(ResultFuture_then),
+               Run(ResultFuture_map),
+               Run(ResultFuture_await),
+               Run(ResultFuture_awaitTimeout)),
+         Trait("ResultParallel",
+               Run(Result_parallelMap),
+               Run(Result_parallelChain),
+               Run(Result_parallelTryAll),
+               Run(Result_parallelCancellable)),
+         Trait("ResultChannel",
+               Run(ResultChannel_send),
+               Run(ResultChannel_sendBatch),
+               Run(ResultChannel_close),
+               Run(ResultChannel_concurrency)),
+         Trait("ResultPipeline",
+               Run(ResultPipeline_new),
+               Run(ResultPipeline_run),
+               Run(ResultPipeline_runBatch)),
+         Trait("ResultThunk",
+               Run(ResultThunk_force),
+               Run(Result_altThunk)),
+         Trait("ResultMatch",
+               Run(Error_index),
+               Run(Result_match)),
+         Trait("ResultCache",
+               Run(ResultCache_get),
+               Run(ResultCache_ttl),
+               Run(ResultCache_evictions)),
+         Trait("ResultRetry",
+               Run(Result_retry),
+               Run(Result_retryTimeout)),
+         Trait("ResultBreaker",
+               Run(ResultBreaker_call),
+               Run(ResultBreaker_concurrency)),
+         Trait("ResultDeadline",
+               Run(ResultDeadline_after),
+               Run(Result_chainWithin),
+               Run(ResultPipeline_runWithin)),
+         Trait("ResultCancel",
+               Run(ResultCancel_cancel),
+               Run(Result_chainCancellable),
+               Run(ResultPipeline_runCancellable)),
+         Trait("ResultIO",
+               Run(ResultIO_error),
+               Run(ResultIO_writev),
+               Run(ResultIO_mapFile)),
+         Trait("ResultIOBatch",
+               Run(ResultIOBatch_run)),
+         Trait("ResultArchive",
+               Run(ResultArchive_write),
+               Run(ResultArchive_load)),
+         Trait("ResultRing",
+               Run(ResultRing_send),
+               Run(ResultRing_receive)),
+         Trait("ResultReactor",
+               Run(ResultReactor_pipe),
+               Run(ResultReactor_loopback)),
+         Trait("ResultAsync",
+               Run(Result_yield),
+               Run(Result_await)))
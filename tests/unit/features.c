@@ -25,10 +25,18 @@ FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
 OTHER DEALINGS IN THE SOFTWARE.
  */
 
+#include <time.h>
+#include <stdio.h>
+#include <string.h>
 #include <result.h>
 #include <traits/traits.h>
 #include "features.h"
 
+void featuresSleep(const long milliseconds) {
+    struct timespec duration = {.tv_sec=milliseconds / 1000, .tv_nsec=(milliseconds % 1000) * 1000000};
+    while (0 != nanosleep(&duration, &duration));
+}
+
 Feature(Result_error) {
     const size_t counter = traits_unit_get_wrapped_signals_counter();
 
@@ -243,6 +251,136 @@ Feature(Result_orElse) {
     }
 }
 
+Feature(Result_all) {
+    const Result results[] = {Result_ok("A"), Result_ok("B"), Result_error(DomainError), Result_error(MathError)};
+    const void *values[4] = {0};
+
+    {
+        const Result sut = Result_all(results, 2, values);
+        assert_true(Result_isOk(sut));
+        assert_equal(values, Result_unwrap(sut));
+        assert_string_equal("A", values[0]);
+        assert_string_equal("B", values[1]);
+    }
+
+    {
+        const Result sut = Result_all(results, 4, values);
+        assert_true(Result_isError(sut));
+        assert_equal(DomainError, Result_inspect(sut));
+    }
+
+    {
+        const Result sut = Result_all(NULL, 0, values);
+        assert_true(Result_isOk(sut));
+    }
+}
+
+Feature(Result_collectErrors) {
+    const Result results[] = {Result_error(DomainError), Result_ok("A"), Result_error(MathError), Result_ok("B")};
+    Error errors[4] = {0};
+
+    assert_equal(0, Result_collectErrors(results + 1, 1, errors));
+    assert_equal(2, Result_collectErrors(results, 4, errors));
+    assert_equal(DomainError, errors[0]);
+    assert_equal(MathError, errors[1]);
+}
+
+const void *zip2Concat(const void *first, const void *second) {
+    static char buffer[8];
+    snprintf(buffer, sizeof(buffer), "%s%s", (const char *) first, (const char *) second);
+    return buffer;
+}
+
+const void *zip2ToNull(const void *first, const void *second) {
+    (void) first;
+    (void) second;
+    return NULL;
+}
+
+Feature(Result_zip2) {
+    assert_equal(DomainError, Result_inspect(Result_zip2(Result_error(DomainError), Result_error(MathError), zip2Concat)));
+    assert_equal(MathError, Result_inspect(Result_zip2(Result_ok("A"), Result_error(MathError), zip2Concat)));
+    assert_equal(NullReferenceError, Result_inspect(Result_zip2(Result_ok("A"), Result_ok("B"), zip2ToNull)));
+    assert_string_equal("AB", Result_unwrap(Result_zip2(Result_ok("A"), Result_ok("B"), zip2Concat)));
+}
+
+const void *zip3Concat(const void *first, const void *second, const void *third) {
+    static char buffer[8];
+    snprintf(buffer, sizeof(buffer), "%s%s%s", (const char *) first, (const char *) second, (const char *) third);
+    return buffer;
+}
+
+Feature(Result_zip3) {
+    assert_equal(MathError, Result_inspect(Result_zip3(Result_ok("A"), Result_ok("B"), Result_error(MathError), zip3Concat)));
+    assert_equal(DomainError,
+                 Result_inspect(Result_zip3(Result_ok("A"), Result_error(DomainError), Result_error(MathError), zip3Concat)));
+    assert_string_equal("ABC", Result_unwrap(Result_zip3(Result_ok("A"), Result_ok("B"), Result_ok("C"), zip3Concat)));
+}
+
+const void *zipNConcat(const void **values, size_t size) {
+    static char buffer[8];
+    buffer[0] = 0;
+    for (size_t i = 0; i < size; i++) {
+        strncat(buffer, values[i], sizeof(buffer) - strlen(buffer) - 1);
+    }
+    return buffer;
+}
+
+Feature(Result_zipN) {
+    const void *values[4];
+    {
+        const Result results[] = {Result_ok("A"), Result_ok("B"), Result_ok("C"), Result_ok("D")};
+        assert_string_equal("ABCD", Result_unwrap(Result_zipN(results, 4, values, zipNConcat)));
+    }
+
+    {
+        const Result results[] = {Result_ok("A"), Result_error(DomainError), Result_ok("C"), Result_error(MathError)};
+        assert_equal(DomainError, Result_inspect(Result_zipN(results, 4, values, zipNConcat)));
+    }
+
+    const size_t counter = traits_unit_get_wrapped_signals_counter();
+    traits_unit_wraps(SIGABRT) {
+        Result _ = Result_zipN(NULL, 0, values, NULL);
+        (void) _;
+    }
+    assert_equal(traits_unit_get_wrapped_signals_counter(), counter + 1);
+}
+
+static size_t tryReached = 0;
+
+Result tryConcat(Result first, Result second) {
+    static char buffer[8];
+    Result_try(a, first);
+    tryReached++;
+    Result_try(b, second);
+    tryReached++;
+    snprintf(buffer, sizeof(buffer), "%s%s", (const char *) a, (const char *) b);
+    return Result_ok(buffer);
+}
+
+Feature(Result_try) {
+    tryReached = 0;
+    assert_equal(DomainError, Result_inspect(tryConcat(Result_error(DomainError), Result_ok("B"))));
+    assert_equal(0, tryReached);
+    assert_equal(MathError, Result_inspect(tryConcat(Result_ok("A"), Result_error(MathError))));
+    assert_equal(1, tryReached);
+    assert_string_equal("AB", Result_unwrap(tryConcat(Result_ok("A"), Result_ok("B"))));
+    assert_equal(3, tryReached);
+}
+
+Result tryIncrement(Result self) {
+    Result_tryMut(value, self);
+    ++*(int *) value;
+    return Result_ok(value);
+}
+
+Feature(Result_tryMut) {
+    int value = 41;
+    assert_equal(DomainError, Result_inspect(tryIncrement(Result_error(DomainError))));
+    assert_equal(&value, Result_unwrap(tryIncrement(Result_ok(&value))));
+    assert_equal(42, value);
+}
+
 Feature(Result_unwrap) {
     Result sut = Result_ok("A");
 
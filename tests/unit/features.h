@@ -37,6 +37,11 @@ __attribute__(...)
 extern "C" {
 #endif
 
+/*
+ * Sleeps for at least `milliseconds`, resuming after signals.
+ */
+extern void featuresSleep(long milliseconds);
+
 Feature(Result_error);
 Feature(Result_ok);
 Feature(Result_fromNullable);
@@ -44,11 +49,80 @@ Feature(Result_map);
 Feature(Result_chain);
 Feature(Result_alt);
 Feature(Result_orElse);
+Feature(Result_all);
+Feature(Result_collectErrors);
+Feature(Result_zip2);
+Feature(Result_zip3);
+Feature(Result_zipN);
+Feature(Result_try);
+Feature(Result_tryMut);
 Feature(Result_unwrap);
 Feature(Result_unwrapAsMutable);
 Feature(Result_expect);
 Feature(Result_expectAsMutable);
 
+Feature(ResultFuture_spawn);
+Feature(ResultFuture_then);
+Feature(ResultFuture_map);
+Feature(ResultFuture_await);
+Feature(ResultFuture_awaitTimeout);
+
+Feature(Result_parallelMap);
+Feature(Result_parallelChain);
+Feature(Result_parallelTryAll);
+Feature(Result_parallelCancellable);
+
+Feature(ResultChannel_send);
+Feature(ResultChannel_sendBatch);
+Feature(ResultChannel_close);
+Feature(ResultChannel_concurrency);
+
+Feature(ResultPipeline_new);
+Feature(ResultPipeline_run);
+Feature(ResultPipeline_runBatch);
+
+Feature(ResultThunk_force);
+Feature(Result_altThunk);
+
+Feature(Error_index);
+Feature(Result_match);
+
+Feature(ResultCache_get);
+Feature(ResultCache_ttl);
+Feature(ResultCache_evictions);
+
+Feature(Result_retry);
+Feature(Result_retryTimeout);
+
+Feature(ResultBreaker_call);
+Feature(ResultBreaker_concurrency);
+
+Feature(ResultDeadline_after);
+Feature(Result_chainWithin);
+Feature(ResultPipeline_runWithin);
+
+Feature(ResultCancel_cancel);
+Feature(Result_chainCancellable);
+Feature(ResultPipeline_runCancellable);
+
+Feature(ResultIO_error);
+Feature(ResultIO_writev);
+Feature(ResultIO_mapFile);
+
+Feature(ResultIOBatch_run);
+
+Feature(ResultArchive_write);
+Feature(ResultArchive_load);
+
+Feature(ResultRing_send);
+Feature(ResultRing_receive);
+
+Feature(ResultReactor_pipe);
+Feature(ResultReactor_loopback);
+
+Feature(Result_yield);
+Feature(Result_await);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,168 @@
+/*
+Author: daddinuz
+email:  daddinuz@gmail.com
+
+Copyright (c) 2018 Davide Di Carlo
+
+Permission is hereby granted, free of charge, to any person
+obtaining a copy of this software and associated documentation
+files (the "Software"), to deal in the Software without
+restriction, including without limitation the rights to use,
+copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be
+included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <result-io.h>
+#include <result-archive.h>
+#include <traits/traits.h>
+#include "features.h"
+
+static Error ParseError = Error_new("Parse error");
+static Error RateLimited = Error_new("Rate limited");
+static Error Unregistered = Error_new("Unregistered");
+
+static char path[] = "/tmp/result-archive-XXXXXX";
+
+static int archiveTemporaryFile(void) {
+    strcpy(path, "/tmp/result-archive-XXXXXX");
+    const int fd = mkstemp(path);
+    assert_true(fd >= 0);
+    return fd;
+}
+
+static size_t archiveMeasure(const void *value) {
+    return strlen(value) + 1;
+}
+
+Feature(ResultArchive_write) {
+    const Error registry[] = {ParseError, RateLimited};
+    const Result results[] = {
+            Result_ok("first"), Result_error(ParseError), Result_ok("third"), ResultIO_error(ENOENT),
+            Result_ok("a longer second value"), Result_error(Cancelled), Result_error(RateLimited), Result_ok(""),
+    };
+    const size_t size = sizeof(results) / sizeof(results[0]);
+    ResultArchive sut;
+
+    int fd = archiveTemporaryFile();
+    assert_equal(results, Result_unwrap(ResultArchive_write(fd, results, size, archiveMeasure, registry, 2)));
+    close(fd);
+    assert_equal(&sut, Result_unwrap(ResultArchive_load(path, registry, 2, &sut)));
+    assert_equal(size, ResultArchive_size(&sut));
+    const Result *loaded = ResultArchive_results(&sut);
+    for (size_t i = 0; i < size; i++) {
+        assert_equal(Result_inspect(results[i]), Result_inspect(loaded[i]));
+    }
+    assert_string_equal("first", Result_unwrap(loaded[0]));
+    assert_string_equal("third", Result_unwrap(loaded[2]));
+    assert_equal(ENOENT, ResultIO_errno(loaded[3]));
+    assert_string_equal("a longer second value", Result_unwrap(loaded[4]));
+    assert_string_equal("", Result_unwrap(loaded[7]));
+    // values are aligned and point into the mapping
+    assert_equal(0, (uintptr_t) Result_unwrap(loaded[4]) % RESULT_ARCHIVE_ALIGNMENT);
+    assert_true((const char *) Result_unwrap(loaded[4]) > (const char *) Result_unwrap(loaded[0]));
+    ResultArchive_unload(&sut);
+    assert_equal(0, ResultArchive_size(&sut));
+
+    // the registry must match, it may grow at the end
+    const Error grown[] = {ParseError, RateLimited, Unregistered};
+    const Error swapped[] = {RateLimited, ParseError};
+    assert_true(Result_isOk(ResultArchive_load(path, grown, 3, &sut)));
+    ResultArchive_unload(&sut);
+    assert_equal(LookupError, Result_inspect(ResultArchive_load(path, swapped, 2, &sut)));
+    assert_equal(LookupError, Result_inspect(ResultArchive_load(path, registry, 1, &sut)));
+    unlink(path);
+
+    // unknown errors are refused before writing anything
+    fd = archiveTemporaryFile();
+    const Result unknown[] = {Result_ok("first"), Result_error(Unregistered)};
+    assert_equal(LookupError, Result_inspect(ResultArchive_write(fd, unknown, 2, archiveMeasure, registry, 2)));
+    assert_equal(0, lseek(fd, 0, SEEK_END));
+    close(fd);
+    assert_equal(EBADF, ResultIO_errno(ResultArchive_write(fd, results, size, archiveMeasure, registry, 2)));
+
+    // archives replace the content of the file wherever fd is positioned
+    fd = archiveTemporaryFile();
+    static char junk[4096];
+    memset(junk, 'j', sizeof(junk));
+    assert_equal(sizeof(junk), write(fd, junk, sizeof(junk)));
+    assert_true(Result_isOk(ResultArchive_write(fd, results, 2, archiveMeasure, registry, 2)));
+    close(fd);
+    assert_true(Result_isOk(ResultArchive_load(path, registry, 2, &sut)));
+    assert_string_equal("first", Result_unwrap(ResultArchive_results(&sut)[0]));
+    ResultArchive_unload(&sut);
+    unlink(path);
+
+    // more buffers than a single gathered write takes
+    static char many[3 * 1024][16];
+    static Result manyResults[sizeof(many) / sizeof(many[0])];
+    const size_t manySize = sizeof(many) / sizeof(many[0]);
+    for (size_t i = 0; i < manySize; i++) {
+        snprintf(many[i], sizeof(many[i]), "%zu", i);
+        manyResults[i] = Result_ok(many[i]);
+    }
+    fd = archiveTemporaryFile();
+    assert_true(Result_isOk(ResultArchive_write(fd, manyResults, manySize, archiveMeasure, NULL, 0)));
+    close(fd);
+    assert_true(Result_isOk(ResultArchive_load(path, NULL, 0, &sut)));
+    assert_equal(manySize, ResultArchive_size(&sut));
+    for (size_t i = 0; i < manySize; i++) {
+        assert_string_equal(many[i], Result_unwrap(ResultArchive_results(&sut)[i]));
+    }
+    ResultArchive_unload(&sut);
+    unlink(path);
+
+    // empty archives only need the built-ins
+    fd = archiveTemporaryFile();
+    assert_true(Result_isOk(ResultArchive_write(fd, results, 0, archiveMeasure, NULL, 0)));
+    close(fd);
+    assert_true(Result_isOk(ResultArchive_load(path, NULL, 0, &sut)));
+    assert_equal(0, ResultArchive_size(&sut));
+    ResultArchive_unload(&sut);
+    unlink(path);
+}
+
+Feature(ResultArchive_load) {
+    const Result results[] = {Result_ok("value"), Result_error(TimeoutError)};
+    ResultArchive sut;
+
+    int fd = archiveTemporaryFile();
+    assert_true(Result_isOk(ResultArchive_write(fd, results, 2, archiveMeasure, NULL, 0)));
+    // truncated
+    assert_equal(0, ftruncate(fd, lseek(fd, 0, SEEK_END) - 1));
+    assert_equal(DomainError, Result_inspect(ResultArchive_load(path, NULL, 0, &sut)));
+    // not an archive at all
+    assert_equal(0, ftruncate(fd, 0));
+    assert_equal(DomainError, Result_inspect(ResultArchive_load(path, NULL, 0, &sut)));
+    assert_equal(4, pwrite(fd, "junk", 4, 0));
+    assert_equal(DomainError, Result_inspect(ResultArchive_load(path, NULL, 0, &sut)));
+    close(fd);
+    unlink(path);
+
+    const Result missing = ResultArchive_load(path, NULL, 0, &sut);
+    assert_equal(SystemError, Result_inspect(missing));
+    assert_equal(ENOENT, ResultIO_errno(missing));
+
+    traits_unit_wraps(SIGABRT) {
+        Result _ = ResultArchive_load(path, NULL, 1, &sut);
+        (void) _;
+    }
+    assert_equal(1, traits_unit_get_wrapped_signals_counter());
+}
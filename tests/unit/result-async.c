@@ -0,0 +1,144 @@
+/*
+Author: daddinuz
+email:  daddinuz@gmail.com
+
+Copyright (c) 2018 Davide Di Carlo
+
+Permission is hereby granted, free of charge, to any person
+obtaining a copy of this software and associated documentation
+files (the "Software"), to deal in the Software without
+restriction, including without limitation the rights to use,
+copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be
+included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <stdlib.h>
+#include <result-async.h>
+#include <traits/traits.h>
+#include "features.h"
+
+#define MACHINES    200000
+
+typedef struct {
+    ResultAsync async;
+    size_t counter;
+    size_t values[3];
+} Generator;
+
+typedef struct {
+    ResultAsync async;
+    unsigned polls;
+    unsigned ready;
+    unsigned failAt;
+    size_t sum;
+} Machine;
+
+static size_t numbers[] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+
+static Result generate(Generator *self) {
+    Result_async(&self->async);
+    for (self->counter = 0; self->counter < 3; self->counter++) {
+        Result_yield(Result_ok(&self->values[self->counter]));
+    }
+    Result_return(Result_ok(self));
+}
+
+static Result poll(Machine *self, const unsigned step) {
+    // ready every `ready` polls, fails on the `failAt`-th step
+    self->polls += 1;
+    if (0 != self->polls % self->ready) {
+        return ResultAsync_pending();
+    }
+    return (step == self->failAt) ? Result_error(LookupError) : Result_ok(&numbers[step]);
+}
+
+static Result serve(Machine *self) {
+    Result_async(&self->async);
+    Result_await(first, poll(self, 1));
+    self->sum += *(const size_t *) first;
+    Result_yield(ResultAsync_pending());
+    Result_await(second, poll(self, 2));
+    self->sum += *(const size_t *) second;
+    Result_await(third, poll(self, 3));
+    self->sum += *(const size_t *) third;
+    Result_return(Result_ok(&self->sum));
+}
+
+Feature(Result_yield) {
+    Generator sut = {.async=ResultAsync_new(), .values={10, 20, 30}};
+    assert_false(ResultAsync_isFinished(&sut.async));
+    assert_equal(&sut.values[0], Result_unwrap(generate(&sut)));
+    assert_equal(&sut.values[1], Result_unwrap(generate(&sut)));
+    assert_equal(&sut.values[2], Result_unwrap(generate(&sut)));
+    assert_false(ResultAsync_isFinished(&sut.async));
+    assert_equal(&sut, Result_unwrap(generate(&sut)));
+    assert_true(ResultAsync_isFinished(&sut.async));
+    assert_equal(StopIteration, Result_inspect(generate(&sut)));
+    assert_equal(StopIteration, Result_inspect(generate(&sut)));
+
+    // restarting is just a matter of resetting the state
+    sut.async = ResultAsync_new();
+    assert_equal(&sut.values[0], Result_unwrap(generate(&sut)));
+    assert_equal(sizeof(void *), sizeof(ResultAsync));
+}
+
+Feature(Result_await) {
+    {
+        Machine sut = {.async=ResultAsync_new(), .ready=3};
+        size_t calls = 1;
+        Result result;
+        while (Pending == Result_inspect(result = serve(&sut))) {
+            calls++;
+        }
+        assert_equal(&sut.sum, Result_unwrap(result));
+        assert_equal(6, sut.sum);
+        // every third poll is ready, the yield suspends once and an await ready straight away does not suspend
+        assert_equal(9, sut.polls);
+        assert_equal(3 * 3 - 1, calls);
+        assert_true(ResultAsync_isFinished(&sut.async));
+    }
+    {
+        // errors are propagated and finish the coroutine
+        Machine sut = {.async=ResultAsync_new(), .ready=1, .failAt=2};
+        assert_equal(Pending, Result_inspect(serve(&sut)));
+        assert_equal(LookupError, Result_inspect(serve(&sut)));
+        assert_true(ResultAsync_isFinished(&sut.async));
+        assert_equal(1, sut.sum);
+        assert_equal(StopIteration, Result_inspect(serve(&sut)));
+    }
+    {
+        // lots of them, interleaved
+        Machine *machines = calloc(MACHINES, sizeof(machines[0]));
+        assert_not_null(machines);
+        for (size_t i = 0; i < MACHINES; i++) {
+            machines[i] = (Machine) {.async=ResultAsync_new(), .ready=1 + (unsigned) (i % 7)};
+        }
+        size_t running = MACHINES, rounds = 0;
+        while (running > 0) {
+            rounds++;
+            for (size_t i = 0; i < MACHINES; i++) {
+                if (!ResultAsync_isFinished(&machines[i].async) && Ok == Result_inspect(serve(&machines[i]))) {
+                    running--;
+                }
+            }
+        }
+        assert_equal(3 * 7 - 1, rounds);
+        for (size_t i = 0; i < MACHINES; i++) {
+            assert_equal(6, machines[i].sum);
+        }
+        free(machines);
+    }
+}
@@ -0,0 +1,154 @@
+/*
+Author: daddinuz
+email:  daddinuz@gmail.com
+
+Copyright (c) 2018 Davide Di Carlo
+
+Permission is hereby granted, free of charge, to any person
+obtaining a copy of this software and associated documentation
+files (the "Software"), to deal in the Software without
+restriction, including without limitation the rights to use,
+copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be
+included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <pthread.h>
+#include <result-breaker.h>
+#include <traits/traits.h>
+#include "features.h"
+
+#define THREADS 4
+
+static Error BreakerOpen = Error_new("Breaker open");
+static Error EarlyError = Error_new("Early error");
+static Error FirstLateError = Error_new("First late error");
+static Error SecondLateError = Error_new("Second late error");
+static bool healthy = false;
+static size_t calls = 0;
+
+static Result breakerDependency(const void *value) {
+    __atomic_add_fetch(&calls, 1, __ATOMIC_RELAXED);
+    if (value == &healthy) {
+        return Result_error(LookupError);
+    }
+    return __atomic_load_n(&healthy, __ATOMIC_RELAXED) ? Result_ok(value) : Result_error(SystemError);
+}
+
+static Result breakerFailWith(const void *error) {
+    return Result_error(error);
+}
+
+static bool breakerSystemError(Error error) {
+    return SystemError == error;
+}
+
+static void *breakerHammer(void *breaker) {
+    for (size_t i = 0; i < 10000; i++) {
+        const Result result = ResultBreaker_call(breaker, "A");
+        assert_true(Result_inspect(result) == SystemError || Result_inspect(result) == BreakerOpen);
+    }
+    return NULL;
+}
+
+Feature(ResultBreaker_call) {
+    healthy = true;
+    calls = 0;
+    ResultBreaker sut = ResultBreaker_new(breakerDependency, BreakerOpen, breakerSystemError, 50, 10, 10000, 50);
+
+    for (size_t i = 0; i < 20; i++) {
+        assert_string_equal("A", Result_unwrap(ResultBreaker_call(sut, "A")));
+    }
+    // lookup errors are counted on their own and don't trip the breaker
+    for (size_t i = 0; i < 30; i++) {
+        assert_equal(LookupError, Result_inspect(ResultBreaker_call(sut, &healthy)));
+    }
+    assert_false(ResultBreaker_isOpen(sut));
+    assert_equal(50, ResultBreaker_calls(sut));
+    assert_equal(30, ResultBreaker_failures(sut, LookupError));
+
+    healthy = false;
+    // 20 ok and 30 lookup errors: the 50th system error crosses 50%
+    for (size_t i = 0; i < 50; i++) {
+        assert_false(ResultBreaker_isOpen(sut));
+        assert_equal(SystemError, Result_inspect(ResultBreaker_call(sut, "A")));
+    }
+    assert_true(ResultBreaker_isOpen(sut));
+    assert_equal(50, ResultBreaker_failures(sut, SystemError));
+
+    // short-circuited, the dependency is left alone
+    calls = 0;
+    for (size_t i = 0; i < 100; i++) {
+        assert_equal(BreakerOpen, Result_inspect(ResultBreaker_call(sut, "A")));
+    }
+    assert_equal(0, calls);
+    assert_equal(100, ResultBreaker_shortCircuits(sut));
+
+    // a failing probe opens it again
+    featuresSleep(60);
+    assert_equal(SystemError, Result_inspect(ResultBreaker_call(sut, "A")));
+    assert_equal(BreakerOpen, Result_inspect(ResultBreaker_call(sut, "A")));
+    assert_equal(1, calls);
+
+    // a succeeding probe closes it with a fresh window
+    healthy = true;
+    featuresSleep(60);
+    assert_string_equal("A", Result_unwrap(ResultBreaker_call(sut, "A")));
+    assert_false(ResultBreaker_isOpen(sut));
+    assert_equal(0, ResultBreaker_failures(sut, SystemError));
+    assert_string_equal("A", Result_unwrap(ResultBreaker_call(sut, "A")));
+    ResultBreaker_delete(sut);
+
+    // errors indexed after the breaker has been created share a counter
+    const size_t earlyIndex = Error_index(EarlyError);
+    sut = ResultBreaker_new(breakerFailWith, BreakerOpen, NULL, 100, 1000, 10000, 50);
+    assert_equal(EarlyError, Result_inspect(ResultBreaker_call(sut, EarlyError)));
+    assert_equal(FirstLateError, Result_inspect(ResultBreaker_call(sut, FirstLateError)));
+    assert_equal(SecondLateError, Result_inspect(ResultBreaker_call(sut, SecondLateError)));
+    assert_true(Error_index(FirstLateError) > earlyIndex);
+    assert_equal(1, ResultBreaker_failures(sut, EarlyError));
+    assert_equal(2, ResultBreaker_failures(sut, FirstLateError));
+    assert_equal(2, ResultBreaker_failures(sut, SecondLateError));
+    ResultBreaker_delete(sut);
+
+    const size_t counter = traits_unit_get_wrapped_signals_counter();
+    traits_unit_wraps(SIGABRT) {
+        ResultBreaker _ = ResultBreaker_new(breakerDependency, Ok, NULL, 50, 10, 1000, 1000);
+        (void) _;
+    }
+    assert_equal(traits_unit_get_wrapped_signals_counter(), counter + 1);
+    traits_unit_wraps(SIGABRT) {
+        ResultBreaker _ = ResultBreaker_new(breakerDependency, BreakerOpen, NULL, 0, 10, 1000, 1000);
+        (void) _;
+    }
+    assert_equal(traits_unit_get_wrapped_signals_counter(), counter + 2);
+}
+
+Feature(ResultBreaker_concurrency) {
+    healthy = false;
+    calls = 0;
+    ResultBreaker sut = ResultBreaker_new(breakerDependency, BreakerOpen, NULL, 90, 100, 10000, 10000);
+    pthread_t threads[THREADS];
+    for (size_t i = 0; i < THREADS; i++) {
+        assert_equal(0, pthread_create(&threads[i], NULL, breakerHammer, sut));
+    }
+    for (size_t i = 0; i < THREADS; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    assert_true(ResultBreaker_isOpen(sut));
+    assert_true(calls >= 100 && calls < 1000);
+    assert_equal(THREADS * 10000, calls + ResultBreaker_shortCircuits(sut));
+    ResultBreaker_delete(sut);
+}
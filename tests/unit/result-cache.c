@@ -0,0 +1,161 @@
+/*
+Author: daddinuz
+email:  daddinuz@gmail.com
+
+Copyright (c) 2018 Davide Di Carlo
+
+Permission is hereby granted, free of charge, to any person
+obtaining a copy of this software and associated documentation
+files (the "Software"), to deal in the Software without
+restriction, including without limitation the rights to use,
+copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be
+included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <pthread.h>
+#include <result-cache.h>
+#include <traits/traits.h>
+#include "features.h"
+
+#define KEYS    1024
+#define THREADS 4
+
+static size_t keys[KEYS];
+static size_t calls = 0;
+
+static size_t cacheHash(const void *key) {
+    return *(const size_t *) key;
+}
+
+static bool cacheEquals(const void *a, const void *b) {
+    return *(const size_t *) a == *(const size_t *) b;
+}
+
+static Result cacheLookup(const void *key) {
+    __atomic_add_fetch(&calls, 1, __ATOMIC_RELAXED);
+    return (*(const size_t *) key % 2) ? Result_error(LookupError) : Result_ok(key);
+}
+
+static void fillKeys(void) {
+    for (size_t i = 0; i < KEYS; i++) {
+        keys[i] = i;
+    }
+}
+
+static void *cacheGetAll(void *cache) {
+    for (size_t round = 0; round < 4; round++) {
+        for (size_t i = 0; i < KEYS; i++) {
+            const Result result = ResultCache_get(cache, &keys[i]);
+            assert_equal((i % 2) ? LookupError : Ok, Result_inspect(result));
+        }
+    }
+    return NULL;
+}
+
+Feature(ResultCache_get) {
+    fillKeys();
+    calls = 0;
+    // shards fill up unevenly, leave some room
+    ResultCache sut = ResultCache_new(cacheLookup, cacheHash, cacheEquals, 4 * KEYS, RESULT_CACHE_FOREVER,
+                                      RESULT_CACHE_FOREVER);
+    for (size_t round = 0; round < 3; round++) {
+        for (size_t i = 0; i < KEYS; i++) {
+            const Result result = ResultCache_get(sut, &keys[i]);
+            if (i % 2) {
+                assert_equal(LookupError, Result_inspect(result));
+            } else {
+                assert_equal(&keys[i], Result_unwrap(result));
+            }
+        }
+    }
+    assert_equal(KEYS, calls);
+    assert_equal(KEYS, ResultCache_misses(sut));
+    assert_equal(2 * KEYS, ResultCache_hits(sut));
+    assert_equal(0, ResultCache_evictions(sut));
+
+    // keys are compared by equals, not by address
+    const size_t key = 42;
+    assert_equal(&keys[42], Result_unwrap(ResultCache_get(sut, &key)));
+    assert_equal(KEYS, calls);
+
+    ResultCache_invalidate(sut, &keys[42]);
+    assert_equal(&keys[42], Result_unwrap(ResultCache_get(sut, &keys[42])));
+    assert_equal(KEYS + 1, calls);
+    ResultCache_delete(sut);
+
+    calls = 0;
+    sut = ResultCache_new(cacheLookup, cacheHash, cacheEquals, 4 * KEYS, RESULT_CACHE_FOREVER, RESULT_CACHE_FOREVER);
+    pthread_t threads[THREADS];
+    for (size_t i = 0; i < THREADS; i++) {
+        assert_equal(0, pthread_create(&threads[i], NULL, cacheGetAll, sut));
+    }
+    for (size_t i = 0; i < THREADS; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    assert_equal(THREADS * 4 * KEYS, ResultCache_hits(sut) + ResultCache_misses(sut));
+    assert_equal(calls, ResultCache_misses(sut));
+    assert_true(calls >= KEYS && calls <= THREADS * KEYS);
+    ResultCache_delete(sut);
+}
+
+Feature(ResultCache_ttl) {
+    fillKeys();
+    calls = 0;
+    // values are never cached, errors expire quickly
+    ResultCache sut = ResultCache_new(cacheLookup, cacheHash, cacheEquals, 16, 0, 50);
+    for (size_t round = 0; round < 3; round++) {
+        assert_true(Result_isOk(ResultCache_get(sut, &keys[0])));
+        assert_true(Result_isError(ResultCache_get(sut, &keys[1])));
+    }
+    assert_equal(4, calls);
+
+    featuresSleep(100);
+    assert_true(Result_isError(ResultCache_get(sut, &keys[1])));
+    assert_equal(5, calls);
+    ResultCache_delete(sut);
+
+    const size_t counter = traits_unit_get_wrapped_signals_counter();
+    traits_unit_wraps(SIGABRT) {
+        ResultCache _ = ResultCache_new(cacheLookup, cacheHash, cacheEquals, 0, 0, 0);
+        (void) _;
+    }
+    assert_equal(traits_unit_get_wrapped_signals_counter(), counter + 1);
+}
+
+Feature(ResultCache_evictions) {
+    fillKeys();
+    calls = 0;
+    ResultCache sut = ResultCache_new(cacheLookup, cacheHash, cacheEquals, 4, RESULT_CACHE_FOREVER,
+                                      RESULT_CACHE_FOREVER);
+    for (size_t i = 0; i < 4; i++) {
+        assert_true(Result_inspect(ResultCache_get(sut, &keys[i])) == ((i % 2) ? LookupError : Ok));
+    }
+    assert_equal(0, ResultCache_evictions(sut));
+
+    // give key 0 a second chance, key 1 goes first
+    assert_true(Result_isOk(ResultCache_get(sut, &keys[0])));
+    assert_true(Result_isOk(ResultCache_get(sut, &keys[4])));
+    assert_equal(1, ResultCache_evictions(sut));
+    assert_equal(5, calls);
+    assert_true(Result_isOk(ResultCache_get(sut, &keys[0])));
+    assert_equal(5, calls);
+
+    for (size_t i = 5; i < KEYS; i++) {
+        assert_true(Result_inspect(ResultCache_get(sut, &keys[i])) == ((i % 2) ? LookupError : Ok));
+    }
+    assert_equal(KEYS - 4, ResultCache_evictions(sut));
+    ResultCache_delete(sut);
+}
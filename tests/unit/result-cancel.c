@@ -0,0 +1,112 @@
+/*
+Author: daddinuz
+email:  daddinuz@gmail.com
+
+Copyright (c) 2018 Davide Di Carlo
+
+Permission is hereby granted, free of charge, to any person
+obtaining a copy of this software and associated documentation
+files (the "Software"), to deal in the Software without
+restriction, including without limitation the rights to use,
+copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be
+included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <pthread.h>
+#include <result-cancel.h>
+#include <result-pipeline.h>
+#include <traits/traits.h>
+#include "features.h"
+
+static ResultCancel token;
+static size_t calls = 0;
+
+static Result cancelCounting(const void *value) {
+    calls++;
+    return Result_ok(value);
+}
+
+static Result cancelAfterSecondCall(const void *value) {
+    if (2 == ++calls) {
+        ResultCancel_cancel(&token);
+    }
+    return Result_ok(value);
+}
+
+static void *cancelFromThread(void *cancel) {
+    ResultCancel_cancel(cancel);
+    return NULL;
+}
+
+Feature(ResultCancel_cancel) {
+    ResultCancel sut = ResultCancel_new();
+    assert_false(ResultCancel_isCancelled(&sut));
+    ResultCancel_cancel(&sut);
+    assert_true(ResultCancel_isCancelled(&sut));
+    ResultCancel_cancel(&sut);
+    assert_true(ResultCancel_isCancelled(&sut));
+
+    sut = ResultCancel_new();
+    pthread_t thread;
+    assert_equal(0, pthread_create(&thread, NULL, cancelFromThread, &sut));
+    pthread_join(thread, NULL);
+    assert_true(ResultCancel_isCancelled(&sut));
+    assert_string_equal(Error_explain(Cancelled), "Cancelled");
+}
+
+Feature(Result_chainCancellable) {
+    calls = 0;
+    ResultCancel sut = ResultCancel_new();
+    assert_string_equal("A", Result_unwrap(Result_chainCancellable(Result_ok("A"), cancelCounting, &sut)));
+    ResultCancel_cancel(&sut);
+    assert_equal(Cancelled, Result_inspect(Result_chainCancellable(Result_ok("A"), cancelCounting, &sut)));
+    assert_equal(DomainError, Result_inspect(Result_chainCancellable(Result_error(DomainError), cancelCounting, &sut)));
+    assert_equal(1, calls);
+}
+
+Feature(ResultPipeline_runCancellable) {
+    ResultPipeline sut = ResultPipeline_of(
+            ResultPipeline_chain(cancelAfterSecondCall),
+            ResultPipeline_chain(cancelAfterSecondCall),
+            ResultPipeline_chain(cancelAfterSecondCall)
+    );
+
+    calls = 0;
+    token = ResultCancel_new();
+    Result result = ResultPipeline_runCancellable(sut, Result_ok("A"), ResultDeadline_never(), &token);
+    assert_equal(Cancelled, Result_inspect(result));
+    assert_equal(2, calls);
+
+    // cancellation wins over an expired deadline, no token means no cancellation
+    result = ResultPipeline_runCancellable(sut, Result_ok("A"), ResultDeadline_after(0), &token);
+    assert_equal(Cancelled, Result_inspect(result));
+    result = ResultPipeline_runCancellable(sut, Result_ok("A"), ResultDeadline_after(0), NULL);
+    assert_equal(TimeoutError, Result_inspect(result));
+    // errors are kept
+    result = ResultPipeline_runCancellable(sut, Result_error(DomainError), ResultDeadline_after(0), &token);
+    assert_equal(DomainError, Result_inspect(result));
+
+    calls = 0;
+    token = ResultCancel_new();
+    Result batch[] = {Result_ok("A"), Result_error(DomainError), Result_ok("C")};
+    ResultPipeline_runBatchCancellable(sut, batch, batch, 3, ResultDeadline_never(), &token);
+    assert_equal(Cancelled, Result_inspect(batch[0]));
+    assert_equal(DomainError, Result_inspect(batch[1]));
+    assert_equal(Cancelled, Result_inspect(batch[2]));
+    // the stage that cancelled completes over the whole batch
+    assert_equal(2, calls);
+    ResultPipeline_delete(sut);
+}
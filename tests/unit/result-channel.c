@@ -0,0 +1,228 @@
+/*
+Author: daddinuz
+email:  daddinuz@gmail.com
+
+Copyright (c) 2018 Davide Di Carlo
+
+Permission is hereby granted, free of charge, to any person
+obtaining a copy of this software and associated documentation
+files (the "Software"), to deal in the Software without
+restriction, including without limitation the rights to use,
+copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be
+included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <errno.h>
+#include <pthread.h>
+#include <result-io.h>
+#include <result-channel.h>
+#include <traits/traits.h>
+#include "features.h"
+
+#define PRODUCERS   4
+#define CONSUMERS   4
+#define MESSAGES    20000
+
+static const ResultChannel_Layout layouts[] = {ResultChannel_Wide, ResultChannel_Compact};
+static const ResultChannel_WaitPolicy policies[] = {ResultChannel_Spinning, ResultChannel_Blocking, ResultChannel_Futex};
+
+static int values[PRODUCERS * MESSAGES];
+static char bytes[2] __attribute__((__aligned__(2)));
+
+typedef struct {
+    ResultChannel channel;
+    size_t index;
+    size_t received;
+    size_t errors;
+    size_t checksum;
+} Peer;
+
+static void *produce(void *argument) {
+    Peer *peer = argument;
+    Result batch[7];
+    size_t size = 0;
+    for (size_t i = peer->index * MESSAGES; i < (peer->index + 1) * MESSAGES; i++) {
+        const Result result = (i % 5 == 0) ? Result_error(MathError) : Result_ok(&values[i]);
+        if (peer->index % 2) {
+            assert_true(ResultChannel_send(peer->channel, result));
+        } else {
+            batch[size++] = result;
+            if (sizeof(batch) / sizeof(batch[0]) == size) {
+                assert_equal(size, ResultChannel_sendBatch(peer->channel, batch, size));
+                size = 0;
+            }
+        }
+    }
+    assert_equal(size, ResultChannel_sendBatch(peer->channel, batch, size));
+    return NULL;
+}
+
+static void *consume(void *argument) {
+    Peer *peer = argument;
+    Result batch[5];
+    for (;;) {
+        const size_t size = (peer->index % 2)
+                            ? (batch[0] = ResultChannel_receive(peer->channel), 1)
+                            : ResultChannel_receiveBatch(peer->channel, batch, sizeof(batch) / sizeof(batch[0]));
+        for (size_t i = 0; i < size; i++) {
+            if (StopIteration == Result_inspect(batch[i])) {
+                return NULL;
+            } else if (Result_isError(batch[i])) {
+                peer->errors++;
+            } else {
+                peer->checksum += (size_t) ((const int *) Result_unwrap(batch[i]) - values);
+            }
+            peer->received++;
+        }
+    }
+}
+
+Feature(ResultChannel_send) {
+    for (size_t l = 0; l < sizeof(layouts) / sizeof(layouts[0]); l++) {
+        ResultChannel sut = ResultChannel_new(3, layouts[l], ResultChannel_Blocking);
+        Result result;
+
+        assert_false(ResultChannel_tryReceive(sut, &result));
+        assert_true(ResultChannel_trySend(sut, Result_ok(&values[0])));
+        assert_true(ResultChannel_send(sut, Result_error(LookupError)));
+        assert_true(ResultChannel_trySend(sut, Result_ok(&values[1])));
+        assert_true(ResultChannel_trySend(sut, Result_ok(&values[2])));
+        // capacity is rounded up to 4
+        assert_false(ResultChannel_trySend(sut, Result_ok(&values[3])));
+
+        assert_equal(&values[0], Result_unwrap(ResultChannel_receive(sut)));
+        assert_equal(LookupError, Result_inspect(ResultChannel_receive(sut)));
+        assert_true(ResultChannel_trySend(sut, Result_ok(&values[3])));
+        for (size_t i = 1; i <= 3; i++) {
+            assert_true(ResultChannel_tryReceive(sut, &result));
+            assert_equal(&values[i], Result_unwrap(result));
+        }
+        assert_false(ResultChannel_tryReceive(sut, &result));
+        ResultChannel_delete(sut);
+    }
+
+    size_t counter = traits_unit_get_wrapped_signals_counter();
+    traits_unit_wraps(SIGABRT) {
+        ResultChannel _ = ResultChannel_new(0, ResultChannel_Wide, ResultChannel_Spinning);
+        (void) _;
+    }
+    assert_equal(traits_unit_get_wrapped_signals_counter(), counter + 1);
+
+    ResultChannel sut = ResultChannel_new(4, ResultChannel_Compact, ResultChannel_Spinning);
+    traits_unit_wraps(SIGABRT) {
+        // odd addresses can't be tagged
+        bool _ = ResultChannel_trySend(sut, Result_ok(&bytes[1]));
+        (void) _;
+    }
+    assert_equal(traits_unit_get_wrapped_signals_counter(), counter + 2);
+    ResultChannel_delete(sut);
+
+    // errors carrying a payload are refused rather than losing it
+    sut = ResultChannel_new(4, ResultChannel_Compact, ResultChannel_Spinning);
+    traits_unit_wraps(SIGABRT) {
+        bool _ = ResultChannel_trySend(sut, ResultIO_error(EAGAIN));
+        (void) _;
+    }
+    assert_equal(traits_unit_get_wrapped_signals_counter(), counter + 3);
+    ResultChannel_delete(sut);
+
+    sut = ResultChannel_new(4, ResultChannel_Wide, ResultChannel_Spinning);
+    assert_true(ResultChannel_trySend(sut, ResultIO_error(EAGAIN)));
+    assert_equal(EAGAIN, ResultIO_errno(ResultChannel_receive(sut)));
+    ResultChannel_delete(sut);
+}
+
+Feature(ResultChannel_sendBatch) {
+    Result inputs[6], outputs[6];
+    for (size_t i = 0; i < 6; i++) {
+        inputs[i] = (i % 3) ? Result_ok(&values[i]) : Result_error(MathError);
+    }
+    for (size_t l = 0; l < sizeof(layouts) / sizeof(layouts[0]); l++) {
+        ResultChannel sut = ResultChannel_new(8, layouts[l], ResultChannel_Futex);
+        assert_equal(6, ResultChannel_sendBatch(sut, inputs, 6));
+        assert_equal(4, ResultChannel_receiveBatch(sut, outputs, 4));
+        assert_equal(2, ResultChannel_receiveBatch(sut, outputs + 4, 4));
+        for (size_t i = 0; i < 6; i++) {
+            assert_equal(Result_inspect(inputs[i]), Result_inspect(outputs[i]));
+            if (Result_isOk(inputs[i])) {
+                assert_equal(Result_unwrap(inputs[i]), Result_unwrap(outputs[i]));
+            }
+        }
+        ResultChannel_delete(sut);
+    }
+}
+
+Feature(ResultChannel_close) {
+    Result result;
+    ResultChannel sut = ResultChannel_new(4, ResultChannel_Wide, ResultChannel_Blocking);
+    assert_true(ResultChannel_send(sut, Result_ok(&values[0])));
+    assert_true(ResultChannel_send(sut, Result_error(StopIteration)));
+    ResultChannel_close(sut);
+
+    assert_false(ResultChannel_trySend(sut, Result_ok(&values[1])));
+    assert_false(ResultChannel_send(sut, Result_ok(&values[1])));
+    assert_equal(0, ResultChannel_sendBatch(sut, (Result[]) {Result_ok(&values[1])}, 1));
+
+    // pending results are still delivered, a StopIteration sent as a value doesn't end the batch
+    Result batch[4];
+    assert_equal(2, ResultChannel_receiveBatch(sut, batch, 4));
+    assert_equal(&values[0], Result_unwrap(batch[0]));
+    assert_equal(StopIteration, Result_inspect(batch[1]));
+    assert_equal(1, ResultChannel_receiveBatch(sut, batch, 4));
+    assert_equal(StopIteration, Result_inspect(batch[0]));
+    assert_true(ResultChannel_tryReceive(sut, &result));
+    assert_equal(StopIteration, Result_inspect(result));
+    assert_equal(StopIteration, Result_inspect(ResultChannel_receive(sut)));
+    ResultChannel_delete(sut);
+}
+
+Feature(ResultChannel_concurrency) {
+    for (size_t l = 0; l < sizeof(layouts) / sizeof(layouts[0]); l++) {
+        for (size_t p = 0; p < sizeof(policies) / sizeof(policies[0]); p++) {
+            ResultChannel channel = ResultChannel_new(64, layouts[l], policies[p]);
+            pthread_t producers[PRODUCERS], consumers[CONSUMERS];
+            Peer producerPeers[PRODUCERS], consumerPeers[CONSUMERS];
+
+            for (size_t i = 0; i < CONSUMERS; i++) {
+                consumerPeers[i] = (Peer) {.channel=channel, .index=i};
+                assert_equal(0, pthread_create(&consumers[i], NULL, consume, &consumerPeers[i]));
+            }
+            for (size_t i = 0; i < PRODUCERS; i++) {
+                producerPeers[i] = (Peer) {.channel=channel, .index=i};
+                assert_equal(0, pthread_create(&producers[i], NULL, produce, &producerPeers[i]));
+            }
+            for (size_t i = 0; i < PRODUCERS; i++) {
+                pthread_join(producers[i], NULL);
+            }
+            ResultChannel_close(channel);
+
+            size_t received = 0, errors = 0, checksum = 0, expected = 0;
+            for (size_t i = 0; i < CONSUMERS; i++) {
+                pthread_join(consumers[i], NULL);
+                received += consumerPeers[i].received;
+                errors += consumerPeers[i].errors;
+                checksum += consumerPeers[i].checksum;
+            }
+            for (size_t i = 0; i < PRODUCERS * MESSAGES; i++) {
+                expected += (i % 5 == 0) ? 0 : i;
+            }
+            assert_equal(PRODUCERS * MESSAGES, received);
+            assert_equal(PRODUCERS * MESSAGES / 5, errors);
+            assert_equal(expected, checksum);
+            ResultChannel_delete(channel);
+        }
+    }
+}
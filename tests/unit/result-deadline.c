@@ -0,0 +1,107 @@
+/*
+Author: daddinuz
+email:  daddinuz@gmail.com
+
+Copyright (c) 2018 Davide Di Carlo
+
+Permission is hereby granted, free of charge, to any person
+obtaining a copy of this software and associated documentation
+files (the "Software"), to deal in the Software without
+restriction, including without limitation the rights to use,
+copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be
+included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <stdint.h>
+#include <result-deadline.h>
+#include <result-pipeline.h>
+#include <traits/traits.h>
+#include "features.h"
+
+static size_t calls = 0;
+
+static Result deadlineSlow(const void *value) {
+    calls++;
+    featuresSleep(30);
+    return Result_ok(value);
+}
+
+static Result deadlineFallback(void) {
+    calls++;
+    return Result_ok("fallback");
+}
+
+Feature(ResultDeadline_after) {
+    const ResultDeadline sut = ResultDeadline_after(50);
+    assert_false(ResultDeadline_isExpired(sut));
+    assert_true(ResultDeadline_remaining(sut) > 0 && ResultDeadline_remaining(sut) <= 50);
+    featuresSleep(60);
+    assert_true(ResultDeadline_isExpired(sut));
+    assert_equal(0, ResultDeadline_remaining(sut));
+
+    assert_false(ResultDeadline_isExpired(ResultDeadline_never()));
+    assert_equal(SIZE_MAX, ResultDeadline_remaining(ResultDeadline_never()));
+    assert_false(ResultDeadline_isExpired(ResultDeadline_after(SIZE_MAX)));
+    assert_true(ResultDeadline_isExpired(ResultDeadline_after(0)));
+}
+
+Feature(Result_chainWithin) {
+    calls = 0;
+    const ResultDeadline deadline = ResultDeadline_after(50);
+    assert_string_equal("A", Result_unwrap(Result_chainWithin(Result_ok("A"), deadlineSlow, deadline)));
+    assert_equal(DomainError, Result_inspect(Result_chainWithin(Result_error(DomainError), deadlineSlow, deadline)));
+    assert_string_equal("A", Result_unwrap(Result_chainWithin(Result_ok("A"), deadlineSlow, deadline)));
+    // the budget is gone, no more calls
+    assert_equal(TimeoutError, Result_inspect(Result_chainWithin(Result_ok("A"), deadlineSlow, deadline)));
+    assert_equal(DomainError, Result_inspect(Result_chainWithin(Result_error(DomainError), deadlineSlow, deadline)));
+    assert_equal(2, calls);
+    assert_string_equal(Error_explain(TimeoutError), "Timeout error");
+}
+
+Feature(ResultPipeline_runWithin) {
+    ResultPipeline sut = ResultPipeline_of(
+            ResultPipeline_chain(deadlineSlow),
+            ResultPipeline_chain(deadlineSlow),
+            ResultPipeline_chain(deadlineSlow),
+            ResultPipeline_orElse(deadlineFallback)
+    );
+
+    calls = 0;
+    assert_string_equal("A", Result_unwrap(ResultPipeline_runWithin(sut, Result_ok("A"), ResultDeadline_never())));
+    assert_equal(3, calls);
+
+    calls = 0;
+    const Result result = ResultPipeline_runWithin(sut, Result_ok("A"), ResultDeadline_after(45));
+    assert_equal(TimeoutError, Result_inspect(result));
+    assert_equal(2, calls);
+
+    // errors are kept, only values are interrupted
+    calls = 0;
+    const ResultPipeline chains = ResultPipeline_of(ResultPipeline_chain(deadlineSlow), ResultPipeline_chain(deadlineSlow));
+    assert_equal(DomainError, Result_inspect(ResultPipeline_runWithin(chains, Result_error(DomainError), ResultDeadline_after(0))));
+    assert_equal(0, calls);
+    ResultPipeline_delete(chains);
+
+    calls = 0;
+    Result batch[] = {Result_ok("A"), Result_error(DomainError), Result_ok("B")};
+    ResultPipeline_runBatchWithin(sut, batch, batch, 3, ResultDeadline_after(75));
+    assert_equal(TimeoutError, Result_inspect(batch[0]));
+    assert_equal(DomainError, Result_inspect(batch[1]));
+    assert_equal(TimeoutError, Result_inspect(batch[2]));
+    // each stage takes 60ms over the two values: only the first two stages start in time
+    assert_equal(4, calls);
+    ResultPipeline_delete(sut);
+}
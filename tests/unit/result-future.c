@@ -0,0 +1,189 @@
+/*
+Author: daddinuz
+email:  daddinuz@gmail.com
+
+Copyright (c) 2018 Davide Di Carlo
+
+Permission is hereby granted, free of charge, to any person
+obtaining a copy of this software and associated documentation
+files (the "Software"), to deal in the Software without
+restriction, including without limitation the rights to use,
+copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be
+included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <unistd.h>
+#include <pthread.h>
+#include <result-future.h>
+#include <traits/traits.h>
+#include "features.h"
+
+static Result spawnOk(void *context) {
+    return Result_ok(context);
+}
+
+static Result spawnError(void *context) {
+    (void) context;
+    return Result_error(DomainError);
+}
+
+static Result thenFromError(const void *_) {
+    (void) _;
+    assert_true(false);
+    return Result_error(IllegalState);
+}
+
+static Result thenToError(const void *_) {
+    (void) _;
+    return Result_error(MathError);
+}
+
+static Result thenOk(const void *_) {
+    (void) _;
+    return Result_ok("B");
+}
+
+static const void *mapFromError(const void *_) {
+    (void) _;
+    assert_true(false);
+    return NULL;
+}
+
+static const void *mapToNull(const void *_) {
+    (void) _;
+    return NULL;
+}
+
+static const void *mapOk(const void *_) {
+    (void) _;
+    return "C";
+}
+
+Feature(ResultFuture_spawn) {
+    ResultPool pool = ResultPool_new(2);
+
+    {
+        const Result sut = ResultFuture_await(ResultFuture_spawn(pool, spawnOk, "A"));
+        assert_true(Result_isOk(sut));
+        assert_string_equal(Result_unwrap(sut), "A");
+    }
+
+    {
+        const Result sut = ResultFuture_await(ResultFuture_spawn(pool, spawnError, NULL));
+        assert_true(Result_isError(sut));
+        assert_equal(DomainError, Result_inspect(sut));
+    }
+
+    ResultPool_delete(pool);
+}
+
+Feature(ResultFuture_then) {
+    ResultPool pool = ResultPool_new(2);
+
+    {
+        const Result sut = ResultFuture_await(ResultFuture_then(ResultFuture_spawn(pool, spawnError, NULL), thenFromError));
+        assert_true(Result_isError(sut));
+        assert_equal(DomainError, Result_inspect(sut));
+    }
+
+    {
+        const Result sut = ResultFuture_await(ResultFuture_then(ResultFuture_spawn(pool, spawnOk, "A"), thenToError));
+        assert_true(Result_isError(sut));
+        assert_equal(MathError, Result_inspect(sut));
+    }
+
+    {
+        const Result sut = ResultFuture_await(ResultFuture_then(ResultFuture_spawn(pool, spawnOk, "A"), thenOk));
+        assert_true(Result_isOk(sut));
+        assert_string_equal(Result_unwrap(sut), "B");
+    }
+
+    ResultPool_delete(pool);
+}
+
+Feature(ResultFuture_map) {
+    ResultPool pool = ResultPool_new(2);
+
+    {
+        const Result sut = ResultFuture_await(ResultFuture_map(ResultFuture_spawn(pool, spawnError, NULL), mapFromError));
+        assert_true(Result_isError(sut));
+        assert_equal(DomainError, Result_inspect(sut));
+    }
+
+    {
+        const Result sut = ResultFuture_await(ResultFuture_map(ResultFuture_spawn(pool, spawnOk, "A"), mapToNull));
+        assert_true(Result_isError(sut));
+        assert_equal(NullReferenceError, Result_inspect(sut));
+    }
+
+    {
+        ResultFuture future = ResultFuture_then(ResultFuture_spawn(pool, spawnOk, "A"), thenOk);
+        const Result sut = ResultFuture_await(ResultFuture_map(future, mapOk));
+        assert_true(Result_isOk(sut));
+        assert_string_equal(Result_unwrap(sut), "C");
+    }
+
+    ResultPool_delete(pool);
+}
+
+static const int values[64];
+
+Feature(ResultFuture_await) {
+    ResultPool pool = ResultPool_new(0);
+    ResultFuture futures[sizeof(values) / sizeof(values[0])];
+
+    for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); i++) {
+        futures[i] = ResultFuture_map(ResultFuture_spawn(pool, spawnOk, (void *) &values[i]), mapOk);
+    }
+    for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); i++) {
+        const Result sut = ResultFuture_await(futures[i]);
+        assert_true(Result_isOk(sut));
+        assert_string_equal(Result_unwrap(sut), "C");
+    }
+
+    ResultPool_delete(pool);
+}
+
+static pthread_mutex_t gateMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t gateCondition = PTHREAD_COND_INITIALIZER;
+static bool gateOpen = false;
+
+static Result spawnGated(void *context) {
+    pthread_mutex_lock(&gateMutex);
+    while (!gateOpen) {
+        pthread_cond_wait(&gateCondition, &gateMutex);
+    }
+    pthread_mutex_unlock(&gateMutex);
+    return Result_ok(context);
+}
+
+Feature(ResultFuture_awaitTimeout) {
+    ResultPool pool = ResultPool_new(1);
+    ResultFuture sut = ResultFuture_spawn(pool, spawnGated, "A");
+
+    assert_false(ResultFuture_awaitTimeout(sut, 10));
+
+    pthread_mutex_lock(&gateMutex);
+    gateOpen = true;
+    pthread_cond_broadcast(&gateCondition);
+    pthread_mutex_unlock(&gateMutex);
+
+    assert_true(ResultFuture_awaitTimeout(sut, 10000));
+    const Result result = ResultFuture_await(sut);
+    assert_string_equal(Result_unwrap(result), "A");
+
+    ResultPool_delete(pool);
+}
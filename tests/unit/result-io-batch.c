@@ -0,0 +1,126 @@
+/*
+Author: daddinuz
+email:  daddinuz@gmail.com
+
+Copyright (c) 2018 Davide Di Carlo
+
+Permission is hereby granted, free of charge, to any person
+obtaining a copy of this software and associated documentation
+files (the "Software"), to deal in the Software without
+restriction, including without limitation the rights to use,
+copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be
+included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <result-io.h>
+#include <result-io-batch.h>
+#include <traits/traits.h>
+#include "features.h"
+
+#define RECORDS         100
+#define RECORD_SIZE     8
+
+static size_t completions = 0;
+
+static Result ioBatchCount(const void *value) {
+    completions += 1;
+    return Result_ok(value);
+}
+
+static Result ioBatchReject(const void *value) {
+    (void) value;
+    return Result_error(IllegalState);
+}
+
+static void ioBatchRoundTrip(const ResultIOBatch_Backend backend) {
+    char path[] = "/tmp/result-io-batch-XXXXXX";
+    const int fd = mkstemp(path);
+    assert_true(fd >= 0);
+    unlink(path);
+
+    ResultIOBatch sut = ResultIOBatch_new(16, backend);
+    char records[RECORDS][RECORD_SIZE + 1];
+    ResultIOBatch_Request requests[RECORDS + 2];
+    Result results[RECORDS + 2];
+
+    // more requests than the engine keeps in flight, issued in reverse order
+    for (size_t i = 0; i < RECORDS; i++) {
+        snprintf(records[i], sizeof(records[i]), "rec-%04zu", i);
+        requests[RECORDS - 1 - i] = ResultIOBatch_write(fd, records[i], RECORD_SIZE, (off_t) (i * RECORD_SIZE), NULL);
+    }
+    ResultIOBatch_run(sut, RECORDS, requests, results);
+    for (size_t i = 0; i < RECORDS; i++) {
+        assert_equal(records[i] + RECORD_SIZE, Result_unwrap(results[RECORDS - 1 - i]));
+    }
+
+    char buffer[RECORDS][RECORD_SIZE];
+    char tail[2 * RECORD_SIZE];
+    completions = 0;
+    for (size_t i = 0; i < RECORDS; i++) {
+        requests[i] = ResultIOBatch_read(fd, buffer[i], RECORD_SIZE, (off_t) (i * RECORD_SIZE), ioBatchCount);
+    }
+    // a read across the end of file stops early, an empty one completes at once
+    requests[RECORDS] = ResultIOBatch_read(fd, tail, sizeof(tail), (RECORDS - 1) * RECORD_SIZE, NULL);
+    requests[RECORDS + 1] = ResultIOBatch_read(fd, tail, 0, 0, ioBatchReject);
+    ResultIOBatch_run(sut, RECORDS + 2, requests, results);
+    assert_equal(RECORDS, completions);
+    for (size_t i = 0; i < RECORDS; i++) {
+        assert_equal(buffer[i] + RECORD_SIZE, Result_unwrap(results[i]));
+        assert_true(0 == memcmp(records[i], buffer[i], RECORD_SIZE));
+    }
+    assert_equal(tail + RECORD_SIZE, Result_unwrap(results[RECORDS]));
+    assert_true(0 == memcmp("rec-0099", tail, RECORD_SIZE));
+    assert_equal(IllegalState, Result_inspect(results[RECORDS + 1]));
+
+    // failures are reported per request, continuations are not run on them
+    completions = 0;
+    requests[0] = ResultIOBatch_read(fd, buffer[0], RECORD_SIZE, 0, ioBatchCount);
+    requests[1] = ResultIOBatch_read(-1, buffer[1], RECORD_SIZE, 0, ioBatchCount);
+    requests[2] = ResultIOBatch_read(fd, buffer[2], RECORD_SIZE, RECORD_SIZE, ioBatchReject);
+    ResultIOBatch_run(sut, 3, requests, results);
+    assert_equal(1, completions);
+    assert_true(Result_isOk(results[0]));
+    assert_equal(EBADF, ResultIO_errno(results[1]));
+    assert_equal(IllegalState, Result_inspect(results[2]));
+
+    ResultIOBatch_run(sut, 0, requests, results);
+    ResultIOBatch_delete(sut);
+    close(fd);
+}
+
+Feature(ResultIOBatch_run) {
+    ResultIOBatch sut = ResultIOBatch_new(1, ResultIOBatch_Fallback);
+    assert_false(ResultIOBatch_isUring(sut));
+    ResultIOBatch_delete(sut);
+
+    ioBatchRoundTrip(ResultIOBatch_Fallback);
+    // whichever backend the kernel allows
+    ioBatchRoundTrip(ResultIOBatch_Auto);
+
+    traits_unit_wraps(SIGABRT) {
+        ResultIOBatch _ = ResultIOBatch_new(0, ResultIOBatch_Auto);
+        (void) _;
+    }
+    traits_unit_wraps(SIGABRT) {
+        ResultIOBatch_Request _ = ResultIOBatch_read(0, NULL, 1, 0, NULL);
+        (void) _;
+    }
+    assert_equal(2, traits_unit_get_wrapped_signals_counter());
+}
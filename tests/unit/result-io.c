@@ -0,0 +1,128 @@
+/*
+Author: daddinuz
+email:  daddinuz@gmail.com
+
+Copyright (c) 2018 Davide Di Carlo
+
+Permission is hereby granted, free of charge, to any person
+obtaining a copy of this software and associated documentation
+files (the "Software"), to deal in the Software without
+restriction, including without limitation the rights to use,
+copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be
+included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <result-io.h>
+#include <traits/traits.h>
+#include "features.h"
+
+#define CHUNKS  1500
+
+static char path[] = "/tmp/result-io-XXXXXX";
+
+static int ioTemporaryFile(void) {
+    strcpy(path, "/tmp/result-io-XXXXXX");
+    const int fd = mkstemp(path);
+    assert_true(fd >= 0);
+    return fd;
+}
+
+static Result ioFail(const void *value) {
+    (void) value;
+    return ResultIO_error(EAGAIN);
+}
+
+Feature(ResultIO_error) {
+    const Result sut = ResultIO_error(ENOENT);
+    assert_equal(SystemError, Result_inspect(sut));
+    assert_equal(ENOENT, ResultIO_errno(sut));
+    // the errno survives the combinators
+    assert_equal(EAGAIN, ResultIO_errno(Result_chain(Result_ok("A"), ioFail)));
+    assert_equal(ENOENT, ResultIO_errno(Result_chain(sut, ioFail)));
+    assert_equal(0, ResultIO_errno(Result_ok("A")));
+    assert_equal(0, ResultIO_errno(Result_error(SystemError)));
+    assert_equal(0, ResultIO_errno(Result_error(LookupError)));
+}
+
+Feature(ResultIO_writev) {
+    const int fd = ioTemporaryFile();
+    char chunks[CHUNKS][16];
+    struct iovec iov[CHUNKS + 1];
+    size_t total = 0;
+    for (size_t i = 0; i < CHUNKS; i++) {
+        const int size = snprintf(chunks[i], sizeof(chunks[i]), "chunk-%zu;", i);
+        iov[i] = (struct iovec) {.iov_base=chunks[i], .iov_len=(size_t) size};
+        total += (size_t) size;
+    }
+    iov[CHUNKS] = (struct iovec) {.iov_base=NULL, .iov_len=0};
+
+    // more buffers than a single writev window
+    assert_equal(iov, Result_unwrap(ResultIO_writev(fd, iov, CHUNKS + 1)));
+    assert_equal(chunks[0], iov[0].iov_base);
+    assert_true(Result_isOk(ResultIO_writev(fd, iov, 0)));
+
+    char buffer[CHUNKS * 16];
+    assert_equal(0, lseek(fd, 0, SEEK_SET));
+    const Result read = ResultIO_readInto(fd, buffer, sizeof(buffer));
+    assert_equal(buffer + total, Result_unwrap(read));
+    assert_true(0 == strncmp(buffer, "chunk-0;chunk-1;chunk-2;", 24));
+    assert_true(0 == strncmp(buffer + total - 11, "chunk-1499;", 11));
+
+    // reads stop at the requested size
+    assert_equal(0, lseek(fd, 0, SEEK_SET));
+    assert_equal(buffer + 5, Result_unwrap(ResultIO_readInto(fd, buffer, 5)));
+
+    close(fd);
+    unlink(path);
+    assert_equal(EBADF, ResultIO_errno(ResultIO_writev(fd, iov, 1)));
+    assert_equal(EBADF, ResultIO_errno(ResultIO_readInto(fd, buffer, sizeof(buffer))));
+}
+
+Feature(ResultIO_mapFile) {
+    ResultIO_Mapping mapping;
+    const int fd = ioTemporaryFile();
+    const char content[] = "mapped content";
+
+    {
+        const Result sut = ResultIO_mapFile(path, ResultIO_Sequential, &mapping);
+        assert_equal(&mapping, Result_unwrap(sut));
+        assert_equal(0, ResultIO_mappingSize(&mapping));
+        assert_equal(NULL, ResultIO_mappingData(&mapping));
+        ResultIO_unmap(&mapping);
+    }
+
+    assert_true(Result_isOk(ResultIO_writev(fd, &(struct iovec) {.iov_base=(void *) content, .iov_len=sizeof(content)}, 1)));
+    {
+        const Result sut = ResultIO_mapFile(path, ResultIO_Random, &mapping);
+        assert_true(Result_isOk(sut));
+        assert_equal(sizeof(content), ResultIO_mappingSize(&mapping));
+        assert_string_equal(content, ResultIO_mappingData(&mapping));
+        ResultIO_unmap(&mapping);
+        assert_equal(NULL, ResultIO_mappingData(&mapping));
+    }
+    close(fd);
+    unlink(path);
+
+    const Result sut = ResultIO_mapFile(path, ResultIO_Normal, &mapping);
+    assert_equal(SystemError, Result_inspect(sut));
+    assert_equal(ENOENT, ResultIO_errno(sut));
+    // directories can be opened but not mapped
+    assert_not_equal(0, ResultIO_errno(ResultIO_mapFile("/", ResultIO_Normal, &mapping)));
+}
@@ -0,0 +1,109 @@
+/*
+Author: daddinuz
+email:  daddinuz@gmail.com
+
+Copyright (c) 2018 Davide Di Carlo
+
+Permission is hereby granted, free of charge, to any person
+obtaining a copy of this software and associated documentation
+files (the "Software"), to deal in the Software without
+restriction, including without limitation the rights to use,
+copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be
+included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <result-match.h>
+#include <traits/traits.h>
+#include "features.h"
+
+static Result matchOk(Result self, void *context) {
+    ++*(int *) context;
+    return self;
+}
+
+static Result matchLookupError(Result self, void *context) {
+    (void) self;
+    (void) context;
+    return Result_ok("found");
+}
+
+static Error FirstError = Error_new("First custom error");
+static Error SecondError = Error_new("Second custom error");
+static Error CustomError = Error_new("Custom error");
+static Error LateError = Error_new("Late error");
+
+static Result matchCustomError(Result self, void *context) {
+    (void) self;
+    (void) context;
+    return Result_error(IllegalState);
+}
+
+static Result matchOtherwise(Result self, void *context) {
+    (void) self;
+    (void) context;
+    return Result_error(SystemError);
+}
+
+Feature(Error_index) {
+    assert_equal(0, Error_index(Ok));
+    assert_equal(1, Error_index(DomainError));
+    assert_equal(9, Error_index(StopIteration));
+
+    const size_t indices = Error_indices();
+    const size_t firstIndex = Error_index(FirstError), secondIndex = Error_index(SecondError);
+    assert_equal(10, Error_index(TimeoutError));
+    assert_equal(11, Error_index(Cancelled));
+    for (size_t i = 0; i < ERROR_BUILTINS; i++) {
+        assert_equal(i, Error_index(Error_builtinAt(i)));
+    }
+    assert_equal(Cancelled, Error_builtinAt(ERROR_BUILTINS - 1));
+    assert_true(firstIndex >= 12);
+    assert_equal(firstIndex + 1, secondIndex);
+    assert_equal(firstIndex, Error_index(FirstError));
+    assert_equal(indices + 2, Error_indices());
+}
+
+Feature(Result_match) {
+    ResultMatch sut = ResultMatch_of(
+            matchOtherwise,
+            ResultMatch_on(Ok, matchOk),
+            ResultMatch_on(LookupError, matchLookupError),
+            ResultMatch_on(CustomError, matchCustomError)
+    );
+    int calls = 0;
+
+    assert_string_equal("A", Result_unwrap(Result_match(Result_ok("A"), sut, &calls)));
+    assert_equal(1, calls);
+    assert_string_equal("found", Result_unwrap(Result_match(Result_error(LookupError), sut, &calls)));
+    assert_equal(IllegalState, Result_inspect(Result_match(Result_error(CustomError), sut, &calls)));
+    // holes in the table and errors created after the table
+    assert_equal(SystemError, Result_inspect(Result_match(Result_error(DomainError), sut, &calls)));
+    assert_equal(SystemError, Result_inspect(Result_match(Result_error(LateError), sut, &calls)));
+    ResultMatch_delete(sut);
+
+    const size_t counter = traits_unit_get_wrapped_signals_counter();
+    traits_unit_wraps(SIGABRT) {
+        ResultMatch _ = ResultMatch_of(matchOtherwise, ResultMatch_on(Ok, matchOk), ResultMatch_on(Ok, matchOk));
+        (void) _;
+    }
+    assert_equal(traits_unit_get_wrapped_signals_counter(), counter + 1);
+
+    traits_unit_wraps(SIGABRT) {
+        ResultMatch _ = ResultMatch_new(NULL, 0, NULL);
+        (void) _;
+    }
+    assert_equal(traits_unit_get_wrapped_signals_counter(), counter + 2);
+}
@@ -0,0 +1,179 @@
+/*
+Author: daddinuz
+email:  daddinuz@gmail.com
+
+Copyright (c) 2018 Davide Di Carlo
+
+Permission is hereby granted, free of charge, to any person
+obtaining a copy of this software and associated documentation
+files (the "Software"), to deal in the Software without
+restriction, including without limitation the rights to use,
+copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be
+included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <result-parallel.h>
+#include <traits/traits.h>
+#include "features.h"
+
+#define SIZE    100000
+
+static int values[SIZE];
+static Result inputs[SIZE];
+static Result outputs[SIZE];
+static size_t calls = 0;
+
+static void fillInputs(void) {
+    for (size_t i = 0; i < SIZE; i++) {
+        inputs[i] = (i % 10 == 3) ? Result_error(LookupError) : Result_ok(&values[i]);
+    }
+}
+
+static const void *mapNext(const void *value) {
+    return (const int *) value + 1;
+}
+
+static Result chainOddIsError(const void *value) {
+    return ((const int *) value - values) % 2 ? Result_error(MathError) : Result_ok((const int *) value + 1);
+}
+
+static Result chainCounting(const void *value) {
+    __atomic_add_fetch(&calls, 1, __ATOMIC_RELAXED);
+    return (value == &values[SIZE / 2]) ? Result_error(MathError) : Result_ok(value);
+}
+
+static ResultCancel token;
+
+static Result chainCancelling(const void *value) {
+    __atomic_add_fetch(&calls, 1, __ATOMIC_RELAXED);
+    if (value == &values[SIZE / 2]) {
+        ResultCancel_cancel(&token);
+    }
+    return Result_ok(value);
+}
+
+Feature(Result_parallelMap) {
+    fillInputs();
+    Result_parallelMap(inputs, outputs, SIZE, mapNext, 4);
+    for (size_t i = 0; i < SIZE; i++) {
+        if (i % 10 == 3) {
+            assert_equal(LookupError, Result_inspect(outputs[i]));
+        } else {
+            assert_equal(&values[i] + 1, Result_unwrap(outputs[i]));
+        }
+    }
+
+    // in place
+    Result_parallelMap(outputs, outputs, SIZE, mapNext, 0);
+    for (size_t i = 0; i < SIZE; i++) {
+        if (i % 10 != 3) {
+            assert_equal(&values[i] + 2, Result_unwrap(outputs[i]));
+        }
+    }
+}
+
+Feature(Result_parallelChain) {
+    fillInputs();
+    Result_parallelChain(inputs, outputs, SIZE, chainOddIsError, 4);
+    for (size_t i = 0; i < SIZE; i++) {
+        if (i % 10 == 3) {
+            assert_equal(LookupError, Result_inspect(outputs[i]));
+        } else if (i % 2) {
+            assert_equal(MathError, Result_inspect(outputs[i]));
+        } else {
+            assert_equal(&values[i] + 1, Result_unwrap(outputs[i]));
+        }
+    }
+}
+
+Feature(Result_parallelTryAll) {
+    for (size_t i = 0; i < SIZE; i++) {
+        inputs[i] = Result_ok(&values[i]);
+    }
+
+    {
+        calls = 0;
+        const Result sut = Result_parallelTryAll(inputs, outputs, SIZE / 4, chainCounting, 4);
+        assert_true(Result_isOk(sut));
+        assert_equal(outputs, Result_unwrap(sut));
+        assert_equal(SIZE / 4, calls);
+    }
+
+    {
+        calls = 0;
+        const Result sut = Result_parallelTryAll(inputs, outputs, SIZE, chainCounting, 1);
+        assert_true(Result_isError(sut));
+        assert_equal(MathError, Result_inspect(sut));
+        assert_equal(SIZE / 2 + 1, calls);
+    }
+
+    {
+        inputs[SIZE - 1] = Result_error(LookupError);
+        const Result sut = Result_parallelTryAll(inputs, outputs, SIZE, chainCounting, 4);
+        assert_true(Result_isError(sut));
+    }
+}
+
+Feature(Result_parallelCancellable) {
+    fillInputs();
+
+    {
+        token = ResultCancel_new();
+        Result_parallelMapCancellable(inputs, outputs, SIZE, mapNext, 4, &token);
+        assert_equal(&values[0] + 1, Result_unwrap(outputs[0]));
+        ResultCancel_cancel(&token);
+        Result_parallelMapCancellable(inputs, outputs, SIZE, mapNext, 4, &token);
+        for (size_t i = 0; i < SIZE; i++) {
+            assert_equal((i % 10 == 3) ? LookupError : Cancelled, Result_inspect(outputs[i]));
+        }
+    }
+
+    {
+        calls = 0;
+        Result_parallelChainCancellable(inputs, outputs, SIZE, chainCancelling, 4, &token);
+        assert_equal(0, calls);
+        assert_equal(Cancelled, Result_inspect(outputs[0]));
+        assert_equal(LookupError, Result_inspect(outputs[3]));
+    }
+
+    for (size_t i = 0; i < SIZE; i++) {
+        inputs[i] = Result_ok(&values[i]);
+    }
+
+    {
+        calls = 0;
+        token = ResultCancel_new();
+        Result_parallelChainCancellable(inputs, outputs, SIZE, chainCancelling, 1, &token);
+        assert_equal(SIZE / 2 + 1, calls);
+        assert_equal(&values[SIZE / 2], Result_unwrap(outputs[SIZE / 2]));
+        assert_equal(Cancelled, Result_inspect(outputs[SIZE / 2 + 1]));
+    }
+
+    {
+        calls = 0;
+        token = ResultCancel_new();
+        const Result sut = Result_parallelTryAllCancellable(inputs, outputs, SIZE, chainCancelling, 4, &token);
+        assert_true(Result_isError(sut));
+        assert_equal(Cancelled, Result_inspect(sut));
+        assert_true(calls <= SIZE);
+    }
+
+    {
+        token = ResultCancel_new();
+        const Result sut = Result_parallelTryAllCancellable(inputs, outputs, SIZE / 4, chainCounting, 4, &token);
+        assert_true(Result_isOk(sut));
+    }
+}
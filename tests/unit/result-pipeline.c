@@ -0,0 +1,134 @@
+/*
+Author: daddinuz
+email:  daddinuz@gmail.com
+
+Copyright (c) 2018 Davide Di Carlo
+
+Permission is hereby granted, free of charge, to any person
+obtaining a copy of this software and associated documentation
+files (the "Software"), to deal in the Software without
+restriction, including without limitation the rights to use,
+copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be
+included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <result-pipeline.h>
+#include <traits/traits.h>
+#include "features.h"
+
+#define SIZE    1000
+
+static int values[SIZE + 2];
+
+static const void *pipelineNext(const void *value) {
+    return (const int *) value + 1;
+}
+
+static const void *pipelineNull(const void *value) {
+    (void) value;
+    return NULL;
+}
+
+static Result pipelineOddIsError(const void *value) {
+    return ((const int *) value - values) % 2 ? Result_error(MathError) : Result_ok(value);
+}
+
+static Result pipelineRecover(void) {
+    return Result_ok(&values[0]);
+}
+
+static Result reference(const Result input) {
+    return Result_orElse(
+            Result_chain(Result_alt(Result_chain(Result_map(input, pipelineNext), pipelineOddIsError),
+                                    Result_error(LookupError)), pipelineOddIsError),
+            pipelineRecover
+    );
+}
+
+static ResultPipeline newPipeline(void) {
+    return ResultPipeline_of(
+            ResultPipeline_map(pipelineNext),
+            ResultPipeline_chain(pipelineOddIsError),
+            ResultPipeline_alt(Result_error(LookupError)),
+            ResultPipeline_chain(pipelineOddIsError),
+            ResultPipeline_orElse(pipelineRecover)
+    );
+}
+
+static Result input(size_t i) {
+    return (i % 7 == 0) ? Result_error(DomainError) : Result_ok(&values[i]);
+}
+
+Feature(ResultPipeline_new) {
+    {
+        ResultPipeline sut = ResultPipeline_new(0, NULL);
+        assert_equal(&values[3], Result_unwrap(ResultPipeline_run(sut, Result_ok(&values[3]))));
+        ResultPipeline_delete(sut);
+    }
+
+    const size_t counter = traits_unit_get_wrapped_signals_counter();
+    traits_unit_wraps(SIGABRT) {
+        ResultPipeline _ = ResultPipeline_of(ResultPipeline_map(pipelineNext), ResultPipeline_chain(NULL));
+        (void) _;
+    }
+    assert_equal(traits_unit_get_wrapped_signals_counter(), counter + 1);
+
+    traits_unit_wraps(SIGABRT) {
+        ResultPipeline _ = ResultPipeline_of(ResultPipeline_alt((Result) {0}));
+        (void) _;
+    }
+    assert_equal(traits_unit_get_wrapped_signals_counter(), counter + 2);
+}
+
+Feature(ResultPipeline_run) {
+    ResultPipeline sut = newPipeline();
+    for (size_t i = 0; i < SIZE; i++) {
+        const Result expected = reference(input(i)), actual = ResultPipeline_run(sut, input(i));
+        assert_equal(Result_inspect(expected), Result_inspect(actual));
+        if (Result_isOk(expected)) {
+            assert_equal(Result_unwrap(expected), Result_unwrap(actual));
+        }
+    }
+    ResultPipeline_delete(sut);
+
+    sut = ResultPipeline_of(ResultPipeline_map(pipelineNull), ResultPipeline_map(pipelineNext));
+    assert_equal(NullReferenceError, Result_inspect(ResultPipeline_run(sut, Result_ok(&values[0]))));
+    ResultPipeline_delete(sut);
+}
+
+Feature(ResultPipeline_runBatch) {
+    static Result inputs[SIZE], outputs[SIZE];
+    ResultPipeline sut = newPipeline();
+    for (size_t i = 0; i < SIZE; i++) {
+        inputs[i] = input(i);
+    }
+
+    ResultPipeline_runBatch(sut, inputs, outputs, SIZE);
+    // in place
+    ResultPipeline_runBatch(sut, inputs, inputs, SIZE);
+    for (size_t i = 0; i < SIZE; i++) {
+        const Result expected = reference(input(i));
+        assert_equal(Result_inspect(expected), Result_inspect(outputs[i]));
+        assert_equal(Result_inspect(expected), Result_inspect(inputs[i]));
+        if (Result_isOk(expected)) {
+            assert_equal(Result_unwrap(expected), Result_unwrap(outputs[i]));
+            assert_equal(Result_unwrap(expected), Result_unwrap(inputs[i]));
+        }
+    }
+
+    ResultPipeline_runBatch(sut, NULL, NULL, 0);
+    ResultPipeline_delete(sut);
+}
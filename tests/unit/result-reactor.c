@@ -0,0 +1,252 @@
+/*
+Author: daddinuz
+email:  daddinuz@gmail.com
+
+Copyright (c) 2018 Davide Di Carlo
+
+Permission is hereby granted, free of charge, to any person
+obtaining a copy of this software and associated documentation
+files (the "Software"), to deal in the Software without
+restriction, including without limitation the rights to use,
+copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be
+included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <time.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <limits.h>
+#include <pthread.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <result-io.h>
+#include <result-reactor.h>
+#include <traits/traits.h>
+#include "features.h"
+
+typedef struct {
+    ResultReactor reactor;
+    int listener;
+    char buffer[64];
+    size_t size;
+    size_t calls;
+    size_t timeouts;
+    bool ended;
+} ReactorState;
+
+static uint64_t reactorMilliseconds(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t) now.tv_sec * 1000 + (uint64_t) now.tv_nsec / 1000000;
+}
+
+static void reactorPipe(int fds[2]) {
+    assert_equal(0, pipe(fds));
+    assert_equal(0, fcntl(fds[0], F_SETFL, O_NONBLOCK));
+    assert_equal(0, fcntl(fds[1], F_SETFL, O_NONBLOCK));
+}
+
+static Result reactorRead(Result event, void *context) {
+    ReactorState *state = context;
+    state->calls += 1;
+    Result_try(ready, event);
+    const int fd = ResultReactor_eventFd(ready);
+    const ssize_t size = read(fd, state->buffer + state->size, sizeof(state->buffer) - 1 - state->size);
+    if (size < 0) {
+        return ResultIO_error(errno);
+    }
+    if (0 == size) {
+        state->ended = true;
+        return Result_error(StopIteration);
+    }
+    state->size += (size_t) size;
+    return Result_ok(state);
+}
+
+static Result reactorWriteOnce(Result event, void *context) {
+    (void) context;
+    Result_try(ready, event);
+    assert_true(ResultReactor_isWritable(ready));
+    const int fd = ResultReactor_eventFd(ready);
+    assert_equal(5, write(fd, "hello", 5));
+    close(fd);
+    return Result_error(StopIteration);
+}
+
+static Result reactorKeepOnce(Result event, void *context) {
+    ReactorState *state = context;
+    assert_equal(TimeoutError, Result_inspect(event));
+    state->timeouts += 1;
+    return (1 == state->timeouts) ? Result_ok(state) : event;
+}
+
+static void *reactorStopLater(void *reactor) {
+    struct timespec delay = {.tv_sec=0, .tv_nsec=20000000};
+    nanosleep(&delay, NULL);
+    ResultReactor_stop(reactor);
+    return NULL;
+}
+
+static Result reactorEcho(Result event, void *context) {
+    (void) context;
+    Result_try(ready, event);
+    const int fd = ResultReactor_eventFd(ready);
+    char buffer[64];
+    const ssize_t size = read(fd, buffer, sizeof(buffer));
+    if (size <= 0) {
+        close(fd);
+        return Result_error(StopIteration);
+    }
+    assert_equal(size, write(fd, buffer, (size_t) size));
+    return event;
+}
+
+static Result reactorAccept(Result event, void *context) {
+    ReactorState *state = context;
+    Result_try(ready, event);
+    const int fd = accept(ResultReactor_eventFd(ready), NULL, NULL);
+    assert_true(fd >= 0);
+    assert_equal(0, fcntl(fd, F_SETFL, O_NONBLOCK));
+    return ResultReactor_watch(state->reactor, fd, ResultReactor_Readable, 1000, reactorEcho, NULL);
+}
+
+static Result reactorReply(Result event, void *context) {
+    ReactorState *state = context;
+    Result_try(ready, event);
+    const int fd = ResultReactor_eventFd(ready);
+    const ssize_t size = read(fd, state->buffer, sizeof(state->buffer) - 1);
+    assert_true(size > 0);
+    state->size = (size_t) size;
+    // closing the connection ends the echo, removing the listener ends the loop
+    close(fd);
+    ResultReactor_unwatch(state->reactor, state->listener);
+    close(state->listener);
+    return Result_error(StopIteration);
+}
+
+static Result reactorConnected(Result event, void *context) {
+    ReactorState *state = context;
+    Result_try(ready, event);
+    const int fd = ResultReactor_eventFd(ready);
+    assert_equal(4, write(fd, "ping", 4));
+    // replacing its own watch
+    return ResultReactor_watch(state->reactor, fd, ResultReactor_Readable, 1000, reactorReply, state);
+}
+
+Feature(ResultReactor_pipe) {
+    ResultReactor sut = ResultReactor_new();
+    ReactorState state = {.reactor=sut};
+    int fds[2];
+
+    // data then end of file
+    reactorPipe(fds);
+    assert_true(Result_isOk(ResultReactor_watch(sut, fds[0], ResultReactor_Readable, RESULT_REACTOR_FOREVER,
+                                                reactorRead, &state)));
+    assert_true(Result_isOk(ResultReactor_watch(sut, fds[1], ResultReactor_Writable, 1000, reactorWriteOnce, NULL)));
+    assert_equal(2, ResultReactor_watching(sut));
+    ResultReactor_run(sut);
+    assert_equal(0, ResultReactor_watching(sut));
+    assert_string_equal("hello", state.buffer);
+    assert_true(state.ended);
+    close(fds[0]);
+
+    // idle descriptors time out, the continuation may keep watching
+    reactorPipe(fds);
+    const uint64_t start = reactorMilliseconds();
+    assert_true(Result_isOk(ResultReactor_watch(sut, fds[0], ResultReactor_Readable, 20, reactorKeepOnce, &state)));
+    ResultReactor_run(sut);
+    assert_equal(2, state.timeouts);
+    assert_true(reactorMilliseconds() - start >= 40);
+
+    // stopped from another thread
+    pthread_t thread;
+    state.calls = 0;
+    assert_true(Result_isOk(ResultReactor_watch(sut, fds[0], ResultReactor_Readable, RESULT_REACTOR_FOREVER,
+                                                reactorRead, &state)));
+    assert_equal(0, pthread_create(&thread, NULL, reactorStopLater, sut));
+    ResultReactor_run(sut);
+    assert_equal(0, pthread_join(thread, NULL));
+    assert_equal(0, state.calls);
+    assert_equal(1, ResultReactor_watching(sut));
+    ResultReactor_unwatch(sut, fds[0]);
+    ResultReactor_unwatch(sut, fds[0]);
+    assert_equal(0, ResultReactor_watching(sut));
+
+    // the reader is gone
+    close(fds[0]);
+    state.calls = 0;
+    assert_true(Result_isOk(ResultReactor_watch(sut, fds[1], ResultReactor_Readable, 1000, reactorRead, &state)));
+    ResultReactor_run(sut);
+    assert_equal(1, state.calls);
+    close(fds[1]);
+
+    assert_equal(EBADF, ResultIO_errno(ResultReactor_watch(sut, -1, ResultReactor_Readable, 1, reactorRead, NULL)));
+    assert_equal(EBADF, ResultIO_errno(ResultReactor_watch(sut, fds[1], ResultReactor_Readable, 1, reactorRead, NULL)));
+    traits_unit_wraps(SIGABRT) {
+        Result _ = ResultReactor_watch(sut, 0, 0, 1, reactorRead, NULL);
+        (void) _;
+    }
+    traits_unit_wraps(SIGABRT) {
+        Result _ = ResultReactor_watch(sut, 0, ResultReactor_Readable, 0, reactorRead, NULL);
+        (void) _;
+    }
+    assert_equal(2, traits_unit_get_wrapped_signals_counter());
+    ResultReactor_delete(sut);
+}
+
+Feature(ResultReactor_loopback) {
+    ResultReactor sut = ResultReactor_new();
+    ReactorState state = {.reactor=sut};
+    struct sockaddr_in address = {.sin_family=AF_INET, .sin_port=0, .sin_addr.s_addr=htonl(INADDR_LOOPBACK)};
+    socklen_t size = sizeof(address);
+
+    state.listener = socket(AF_INET, SOCK_STREAM, 0);
+    assert_true(state.listener >= 0);
+    assert_equal(0, bind(state.listener, (struct sockaddr *) &address, sizeof(address)));
+    assert_equal(0, listen(state.listener, 8));
+    assert_equal(0, getsockname(state.listener, (struct sockaddr *) &address, &size));
+    assert_equal(0, fcntl(state.listener, F_SETFL, O_NONBLOCK));
+
+    const int client = socket(AF_INET, SOCK_STREAM, 0);
+    assert_true(client >= 0);
+    assert_equal(0, fcntl(client, F_SETFL, O_NONBLOCK));
+    const int connected = connect(client, (struct sockaddr *) &address, sizeof(address));
+    assert_true(0 == connected || EINPROGRESS == errno);
+
+    assert_true(Result_isOk(ResultReactor_watch(sut, state.listener, ResultReactor_Readable, RESULT_REACTOR_FOREVER,
+                                                reactorAccept, &state)));
+    assert_true(Result_isOk(ResultReactor_watch(sut, client, ResultReactor_Writable, 1000, reactorConnected, &state)));
+    ResultReactor_run(sut);
+    assert_string_equal("ping", state.buffer);
+    assert_equal(0, ResultReactor_watching(sut));
+    ResultReactor_delete(sut);
+
+    // the process may be confined to a cpuset that excludes core 0, pin to the first core it is allowed to run on
+    unsigned long mask[16] = {0};
+    const long bytes = syscall(SYS_sched_getaffinity, 0, sizeof(mask), mask);
+    assert_true(bytes > 0);
+    size_t core = 0;
+    while (!(mask[core / (sizeof(mask[0]) * CHAR_BIT)] & (1UL << core % (sizeof(mask[0]) * CHAR_BIT)))) {
+        core++;
+    }
+    assert_true(ResultReactor_pin(core));
+    assert_false(ResultReactor_pin(100000));
+    assert_equal(0, syscall(SYS_sched_setaffinity, 0, sizeof(mask), mask));
+}
@@ -0,0 +1,117 @@
+/*
+Author: daddinuz
+email:  daddinuz@gmail.com
+
+Copyright (c) 2018 Davide Di Carlo
+
+Permission is hereby granted, free of charge, to any person
+obtaining a copy of this software and associated documentation
+files (the "Software"), to deal in the Software without
+restriction, including without limitation the rights to use,
+copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be
+included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <time.h>
+#include <result-retry.h>
+#include <traits/traits.h>
+#include "features.h"
+
+typedef struct {
+    size_t calls;
+    size_t failures;
+    Error error;
+} Flaky;
+
+static Result retryFlaky(void *context) {
+    Flaky *flaky = context;
+    return (flaky->calls++ < flaky->failures) ? Result_error(flaky->error) : Result_ok(flaky);
+}
+
+static bool retryLookupError(Error error) {
+    return LookupError == error;
+}
+
+static double retryNow(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double) now.tv_sec * 1000.0 + (double) now.tv_nsec / 1e6;
+}
+
+Feature(Result_retry) {
+    ResultRetryPolicy policy = ResultRetryPolicy_new(5, 1, 4, 0, NULL);
+
+    {
+        Flaky flaky = {.failures=3, .error=SystemError};
+        const double start = retryNow();
+        const Result sut = Result_retry(retryFlaky, &flaky, policy);
+        const double elapsed = retryNow() - start;
+        assert_equal(&flaky, Result_unwrap(sut));
+        assert_equal(4, flaky.calls);
+        // at least half of 1 + 2 + 4 ms
+        assert_true(elapsed >= 3.5);
+        assert_equal(4, ResultRetryPolicy_attempts(policy));
+        assert_equal(3, ResultRetryPolicy_retries(policy));
+        assert_equal(0, ResultRetryPolicy_exhausted(policy));
+    }
+
+    {
+        Flaky flaky = {.failures=10, .error=SystemError};
+        const Result sut = Result_retry(retryFlaky, &flaky, policy);
+        assert_equal(SystemError, Result_inspect(sut));
+        assert_equal(5, flaky.calls);
+        assert_equal(9, ResultRetryPolicy_attempts(policy));
+        assert_equal(1, ResultRetryPolicy_exhausted(policy));
+    }
+
+    {
+        // not retryable
+        Flaky flaky = {.failures=10, .error=LookupError};
+        assert_equal(LookupError, Result_inspect(Result_retry(retryFlaky, &flaky, policy)));
+        assert_equal(1, flaky.calls);
+        assert_equal(1, ResultRetryPolicy_exhausted(policy));
+    }
+    ResultRetryPolicy_delete(policy);
+
+    {
+        policy = ResultRetryPolicy_new(3, 0, 0, 0, retryLookupError);
+        Flaky flaky = {.failures=2, .error=LookupError};
+        assert_true(Result_isOk(Result_retry(retryFlaky, &flaky, policy)));
+        assert_equal(3, flaky.calls);
+        ResultRetryPolicy_delete(policy);
+    }
+
+    const size_t counter = traits_unit_get_wrapped_signals_counter();
+    traits_unit_wraps(SIGABRT) {
+        ResultRetryPolicy _ = ResultRetryPolicy_new(0, 0, 0, 0, NULL);
+        (void) _;
+    }
+    assert_equal(traits_unit_get_wrapped_signals_counter(), counter + 1);
+}
+
+Feature(Result_retryTimeout) {
+    // the backoff would go well past the timeout: give up instead of sleeping through it
+    ResultRetryPolicy policy = ResultRetryPolicy_new(100, 20, 1000, 50, NULL);
+    Flaky flaky = {.failures=100, .error=SystemError};
+    const double start = retryNow();
+    const Result sut = Result_retry(retryFlaky, &flaky, policy);
+    const double elapsed = retryNow() - start;
+    assert_equal(SystemError, Result_inspect(sut));
+    assert_true(elapsed < 50.0);
+    assert_true(flaky.calls >= 2 && flaky.calls <= 4);
+    assert_equal(1, ResultRetryPolicy_exhausted(policy));
+    ResultRetryPolicy_delete(policy);
+}
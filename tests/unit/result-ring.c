@@ -0,0 +1,203 @@
+/*
+Author: daddinuz
+email:  daddinuz@gmail.com
+
+Copyright (c) 2018 Davide Di Carlo
+
+Permission is hereby granted, free of charge, to any person
+obtaining a copy of this software and associated documentation
+files (the "Software"), to deal in the Software without
+restriction, including without limitation the rights to use,
+copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be
+included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <result-io.h>
+#include <result-ring.h>
+#include <traits/traits.h>
+#include "features.h"
+
+#define PRODUCERS   3
+#define MESSAGES    2000
+
+typedef struct {
+    size_t producer;
+    size_t sequence;
+} RingMessage;
+
+static Error Throttled = Error_new("Throttled");
+static Error Unregistered = Error_new("Unregistered");
+
+static Result ringMessage(const size_t producer, const size_t sequence, RingMessage *message) {
+    *message = (RingMessage) {.producer=producer, .sequence=sequence};
+    // a few of them are errors, custom or carrying an errno
+    switch (sequence % 10) {
+        case 3:
+            return Result_error(Throttled);
+        case 7:
+            return ResultIO_error(EPIPE);
+        default:
+            return Result_ok(message);
+    }
+}
+
+static void ringProduce(ResultRing ring, const size_t producer) {
+    RingMessage message;
+    for (size_t i = 0; i < MESSAGES; i++) {
+        if (!ResultRing_send(ring, ringMessage(producer, i, &message), sizeof(message), ResultDeadline_after(10000))) {
+            _exit(EXIT_FAILURE);
+        }
+    }
+}
+
+static pid_t ringFork(ResultRing ring, const size_t producer, const char *name) {
+    const pid_t pid = fork();
+    assert_true(pid >= 0);
+    if (0 == pid) {
+        // named rings are opened again as another program would do, anonymous ones are inherited
+        if (NULL != name) {
+            const Error registry[] = {Throttled};
+            const Result opened = ResultRing_open(name, registry, 1);
+            if (!Result_isOk(opened)) {
+                _exit(EXIT_FAILURE);
+            }
+            ring = (ResultRing) Result_unwrap(opened);
+        }
+        ringProduce(ring, producer);
+        ResultRing_delete(ring);
+        _exit(EXIT_SUCCESS);
+    }
+    return pid;
+}
+
+static void ringConsume(ResultRing ring, const size_t producers, const pid_t *pids) {
+    size_t next[PRODUCERS] = {0}, oks[PRODUCERS] = {0}, throttled = 0, broken = 0;
+    for (size_t received = 0; received < producers * MESSAGES; received++) {
+        const Result result = ResultRing_receive(ring, ResultDeadline_after(10000));
+        if (Result_isOk(result)) {
+            const RingMessage *message = Result_unwrap(result);
+            assert_true(message->producer < producers);
+            // each producer's results come in the order they were sent
+            assert_true(message->sequence >= next[message->producer]);
+            next[message->producer] = message->sequence + 1;
+            oks[message->producer] += 1;
+        } else if (Throttled == Result_inspect(result)) {
+            throttled += 1;
+        } else {
+            assert_equal(EPIPE, ResultIO_errno(result));
+            broken += 1;
+        }
+    }
+    for (size_t i = 0; i < producers; i++) {
+        int status;
+        assert_equal(pids[i], waitpid(pids[i], &status, 0));
+        assert_true(WIFEXITED(status) && EXIT_SUCCESS == WEXITSTATUS(status));
+        assert_equal(MESSAGES * 8 / 10, oks[i]);
+    }
+    assert_equal(producers * MESSAGES / 10, throttled);
+    assert_equal(producers * MESSAGES / 10, broken);
+    ResultRing_close(ring);
+    assert_equal(StopIteration, Result_inspect(ResultRing_receive(ring, ResultDeadline_never())));
+}
+
+Feature(ResultRing_send) {
+    const Error registry[] = {Throttled};
+    pid_t pids[PRODUCERS];
+
+    {
+        // multiple producers on an anonymous ring
+        ResultRing sut = (ResultRing) Result_unwrap(
+                ResultRing_create(NULL, 16, sizeof(RingMessage), ResultRing_MultipleProducers, registry, 1));
+        for (size_t i = 0; i < PRODUCERS; i++) {
+            pids[i] = ringFork(sut, i, NULL);
+        }
+        ringConsume(sut, PRODUCERS, pids);
+        ResultRing_delete(sut);
+    }
+
+    {
+        // a single producer on a named ring
+        char name[64];
+        snprintf(name, sizeof(name), "/result-ring-%ld", (long) getpid());
+        ResultRing sut = (ResultRing) Result_unwrap(
+                ResultRing_create(name, 4, sizeof(RingMessage), ResultRing_SingleProducer, registry, 1));
+        assert_equal(EEXIST, ResultIO_errno(ResultRing_create(name, 4, 0, ResultRing_SingleProducer, NULL, 0)));
+        pids[0] = ringFork(sut, 0, name);
+        ringConsume(sut, 1, pids);
+        ResultRing_delete(sut);
+        assert_equal(ENOENT, ResultIO_errno(ResultRing_open(name, registry, 1)));
+    }
+}
+
+Feature(ResultRing_receive) {
+    const Error registry[] = {Throttled};
+    const char payload[] = "payload";
+    Result out;
+
+    ResultRing sut = (ResultRing) Result_unwrap(
+            ResultRing_create(NULL, 2, sizeof(payload), ResultRing_SingleProducer, registry, 1));
+    assert_false(ResultRing_tryReceive(sut, &out));
+    assert_equal(TimeoutError, Result_inspect(ResultRing_receive(sut, ResultDeadline_after(10))));
+
+    // another handle on the same ring
+    ResultRing other = (ResultRing) Result_unwrap(ResultRing_attach(ResultRing_fd(sut), registry, 1));
+    assert_true(ResultRing_trySend(other, Result_ok(payload), sizeof(payload)));
+    assert_true(ResultRing_trySend(other, Result_error(Throttled), 0));
+    assert_false(ResultRing_trySend(other, Result_ok(payload), sizeof(payload)));
+    assert_false(ResultRing_send(other, Result_ok(payload), sizeof(payload), ResultDeadline_after(10)));
+
+    assert_true(ResultRing_tryReceive(sut, &out));
+    assert_string_equal(payload, Result_unwrap(out));
+    assert_true(Result_unwrap(out) != (const void *) payload);
+    // the slot is given back on the next receive only
+    assert_false(ResultRing_trySend(other, Result_ok(payload), sizeof(payload)));
+    assert_equal(Throttled, Result_inspect(ResultRing_receive(sut, ResultDeadline_never())));
+    assert_true(ResultRing_trySend(other, Result_ok(payload), 0));
+
+    ResultRing_close(other);
+    assert_false(ResultRing_trySend(sut, Result_ok(payload), sizeof(payload)));
+    assert_true(Result_isOk(ResultRing_receive(sut, ResultDeadline_never())));
+    assert_true(ResultRing_tryReceive(sut, &out));
+    assert_equal(StopIteration, Result_inspect(out));
+    assert_equal(StopIteration, Result_inspect(ResultRing_receive(sut, ResultDeadline_never())));
+
+    // registries must be at least as long as the creator's, files must hold a ring
+    assert_equal(LookupError, Result_inspect(ResultRing_attach(ResultRing_fd(sut), NULL, 0)));
+    FILE *file = tmpfile();
+    assert_equal(DomainError, Result_inspect(ResultRing_attach(fileno(file), NULL, 0)));
+    fclose(file);
+    assert_equal(EBADF, ResultIO_errno(ResultRing_attach(-1, NULL, 0)));
+
+    traits_unit_wraps(SIGABRT) {
+        bool _ = ResultRing_trySend(other, Result_error(Unregistered), 0);
+        (void) _;
+    }
+    traits_unit_wraps(SIGABRT) {
+        bool _ = ResultRing_trySend(other, Result_ok(payload), sizeof(payload) + 1);
+        (void) _;
+    }
+    traits_unit_wraps(SIGABRT) {
+        Result _ = ResultRing_create(NULL, 0, 0, ResultRing_SingleProducer, NULL, 0);
+        (void) _;
+    }
+    assert_equal(3, traits_unit_get_wrapped_signals_counter());
+    ResultRing_delete(other);
+    ResultRing_delete(sut);
+}
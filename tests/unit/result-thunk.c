@@ -0,0 +1,119 @@
+/*
+Author: daddinuz
+email:  daddinuz@gmail.com
+
+Copyright (c) 2018 Davide Di Carlo
+
+Permission is hereby granted, free of charge, to any person
+obtaining a copy of this software and associated documentation
+files (the "Software"), to deal in the Software without
+restriction, including without limitation the rights to use,
+copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be
+included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <pthread.h>
+#include <result-thunk.h>
+#include <result-pipeline.h>
+#include <traits/traits.h>
+#include "features.h"
+
+#define THREADS 4
+
+static size_t calls = 0;
+
+static Result thunkCounting(void *context) {
+    __atomic_add_fetch(&calls, 1, __ATOMIC_RELAXED);
+    return Result_ok(context);
+}
+
+static Result thunkError(void *context) {
+    (void) context;
+    __atomic_add_fetch(&calls, 1, __ATOMIC_RELAXED);
+    return Result_error(LookupError);
+}
+
+static void *thunkForce(void *thunk) {
+    return (void *) Result_unwrap(ResultThunk_force(thunk));
+}
+
+Feature(ResultThunk_force) {
+    {
+        calls = 0;
+        ResultThunk sut = ResultThunk_new(thunkCounting, "A");
+        assert_false(ResultThunk_isForced(&sut));
+        assert_equal(0, calls);
+        assert_string_equal("A", Result_unwrap(ResultThunk_force(&sut)));
+        assert_true(ResultThunk_isForced(&sut));
+        assert_string_equal("A", Result_unwrap(ResultThunk_force(&sut)));
+        assert_equal(1, calls);
+    }
+
+    {
+        calls = 0;
+        ResultThunk sut = ResultThunk_new(thunkError, NULL);
+        assert_equal(LookupError, Result_inspect(ResultThunk_force(&sut)));
+        assert_equal(LookupError, Result_inspect(ResultThunk_force(&sut)));
+        assert_equal(1, calls);
+    }
+
+    {
+        calls = 0;
+        ResultThunk sut = ResultThunk_new(thunkCounting, "B");
+        pthread_t threads[THREADS];
+        void *values[THREADS];
+        for (size_t i = 0; i < THREADS; i++) {
+            assert_equal(0, pthread_create(&threads[i], NULL, thunkForce, &sut));
+        }
+        for (size_t i = 0; i < THREADS; i++) {
+            pthread_join(threads[i], &values[i]);
+            assert_string_equal("B", values[i]);
+        }
+        assert_equal(1, calls);
+    }
+
+    const size_t counter = traits_unit_get_wrapped_signals_counter();
+    traits_unit_wraps(SIGABRT) {
+        ResultThunk _ = ResultThunk_new(NULL, NULL);
+        (void) _;
+    }
+    assert_equal(traits_unit_get_wrapped_signals_counter(), counter + 1);
+}
+
+Feature(Result_altThunk) {
+    calls = 0;
+    ResultThunk sut = ResultThunk_new(thunkCounting, "B");
+
+    assert_string_equal("A", Result_unwrap(Result_altThunk(Result_ok("A"), &sut)));
+    assert_false(ResultThunk_isForced(&sut));
+    assert_string_equal("B", Result_unwrap(Result_altThunk(Result_error(DomainError), &sut)));
+    assert_string_equal("B", Result_unwrap(Result_altThunk(Result_error(MathError), &sut)));
+    assert_equal(1, calls);
+
+    // as a pipeline stage
+    calls = 0;
+    ResultThunk fallback = ResultThunk_new(thunkCounting, "C");
+    ResultPipeline pipeline = ResultPipeline_of(ResultPipeline_altThunk(&fallback));
+    assert_string_equal("A", Result_unwrap(ResultPipeline_run(pipeline, Result_ok("A"))));
+    assert_false(ResultThunk_isForced(&fallback));
+    Result batch[] = {Result_error(DomainError), Result_ok("A"), Result_error(MathError)};
+    ResultPipeline_runBatch(pipeline, batch, batch, 3);
+    assert_string_equal("C", Result_unwrap(batch[0]));
+    assert_string_equal("A", Result_unwrap(batch[1]));
+    assert_string_equal("C", Result_unwrap(batch[2]));
+    assert_equal(1, calls);
+    ResultPipeline_delete(pipeline);
+}